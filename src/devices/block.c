@@ -0,0 +1,341 @@
+#include "devices/block.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/partition.h"
+#include "threads/malloc.h"
+
+/* The block device layer sits between its users--the buffer
+   cache, swap, and the scratch disk utilities--and the drivers
+   that do the work.  Each device has a name, e.g. "hd0:1",
+   "hd0:1p1", "ram0", or "md0", by which kernel options refer to
+   it, and is located by its users through the role it has been
+   given, not by its position on an ATA channel.
+
+   A device that has been given a role, or that is a member of a
+   stripe, is "claimed" and cannot be used a second time.  A
+   disk is not claimed by its partitions, so take care not to
+   use both at once. */
+
+/* A block device. */
+struct block
+  {
+    struct list_elem elem;              /* Element in all_blocks. */
+    char name[16];                      /* Name, e.g. "hd0:1". */
+    enum block_type type;               /* Kind of device. */
+    disk_sector_t size;                 /* Size in sectors. */
+    const struct block_operations *ops; /* Driver. */
+    void *aux;                          /* Driver's data. */
+    bool claimed;                       /* In use by a role or device? */
+
+    long long read_cnt;                 /* Sectors read. */
+    long long write_cnt;                /* Sectors written. */
+  };
+
+/* All block devices, in order of registration. */
+static struct list all_blocks;
+
+/* The device given each role, or a null pointer. */
+static struct block *block_by_role[BLOCK_ROLE_CNT];
+
+static void ata_read (void *, disk_sector_t, void *);
+static void ata_write (void *, disk_sector_t, const void *);
+
+static const struct block_operations ata_operations =
+  {
+    ata_read,
+    ata_write,
+    NULL,
+    NULL,
+  };
+
+/* Initializes the block device layer.  Registers each ATA disk
+   found by disk_init() as a block device with the disk's name,
+   then the partitions on each of them. */
+void
+block_init (void)
+{
+  int chan_no, dev_no;
+
+  list_init (&all_blocks);
+
+  /* disk_get() returns null past the last channel. */
+  for (chan_no = 0; chan_no < 4; chan_no++)
+    for (dev_no = 0; dev_no < 2; dev_no++)
+      {
+        struct disk *d = disk_get (chan_no, dev_no);
+        if (d != NULL)
+          {
+            struct block *b = block_register (disk_name (d), BLOCK_DISK,
+                                              disk_size (d),
+                                              &ata_operations, d);
+
+            /* hd0:0 holds the loader, whose last bytes look like
+               a partition table but are the command line. */
+            if (chan_no != 0 || dev_no != 0)
+              partition_scan (b);
+          }
+      }
+}
+
+/* Prints statistics for the block devices that are not ATA
+   disks.  disk_print_stats() covers those. */
+void
+block_print_stats (void)
+{
+  struct list_elem *e;
+
+  for (e = list_begin (&all_blocks); e != list_end (&all_blocks);
+       e = list_next (e))
+    {
+      struct block *b = list_entry (e, struct block, elem);
+      if (b->type != BLOCK_DISK)
+        printf ("%s: %lld reads, %lld writes\n",
+                b->name, b->read_cnt, b->write_cnt);
+    }
+}
+
+/* Registers a block device named NAME, of the given TYPE, with
+   SIZE sectors, whose driver is OPS, which is passed AUX.
+   Returns the new device.  Panics if NAME is taken or memory is
+   exhausted, since this is only done during boot. */
+struct block *
+block_register (const char *name, enum block_type type, disk_sector_t size,
+                const struct block_operations *ops, void *aux)
+{
+  struct block *b;
+
+  ASSERT (ops->read != NULL && ops->write != NULL);
+
+  if (block_get_by_name (name) != NULL)
+    PANIC ("%s: block device registered twice", name);
+  b = malloc (sizeof *b);
+  if (b == NULL)
+    PANIC ("%s: out of memory registering block device", name);
+
+  strlcpy (b->name, name, sizeof b->name);
+  b->type = type;
+  b->size = size;
+  b->ops = ops;
+  b->aux = aux;
+  b->claimed = false;
+  b->read_cnt = b->write_cnt = 0;
+  list_push_back (&all_blocks, &b->elem);
+
+  if (type != BLOCK_DISK)
+    printf ("%s: %"PRDSNu" sectors (%s)\n",
+            b->name, b->size, block_type_name (type));
+  return b;
+}
+
+/* Returns the block device named NAME, or a null pointer if
+   there is none. */
+struct block *
+block_get_by_name (const char *name)
+{
+  struct block *b;
+
+  for (b = block_first (); b != NULL; b = block_next (b))
+    if (!strcmp (b->name, name))
+      return b;
+  return NULL;
+}
+
+/* Returns the first block device registered, or a null pointer
+   if there are none. */
+struct block *
+block_first (void)
+{
+  if (list_empty (&all_blocks))
+    return NULL;
+  return list_entry (list_front (&all_blocks), struct block, elem);
+}
+
+/* Returns the block device registered after B, or a null pointer
+   if B was the last. */
+struct block *
+block_next (struct block *b)
+{
+  struct list_elem *e = list_next (&b->elem);
+  return e != list_end (&all_blocks) ? list_entry (e, struct block, elem)
+                                     : NULL;
+}
+
+/* Returns the block device that has ROLE, or a null pointer if
+   none does. */
+struct block *
+block_get_role (enum block_role role)
+{
+  ASSERT (role < BLOCK_ROLE_CNT);
+
+  return block_by_role[role];
+}
+
+/* Gives ROLE to B, which must not have been claimed, and claims
+   it. */
+void
+block_set_role (enum block_role role, struct block *b)
+{
+  ASSERT (role < BLOCK_ROLE_CNT);
+
+  if (!block_claim (b))
+    PANIC ("%s: block device is already in use", b->name);
+  block_by_role[role] = b;
+}
+
+/* Claims B for a role or for use by another block device.
+   Returns false if B was already claimed. */
+bool
+block_claim (struct block *b)
+{
+  if (b->claimed)
+    return false;
+  b->claimed = true;
+  return true;
+}
+
+/* Returns true if B has been claimed. */
+bool
+block_is_claimed (struct block *b)
+{
+  return b->claimed;
+}
+
+/* Returns B's name, e.g. "hd0:1". */
+const char *
+block_name (struct block *b)
+{
+  return b->name;
+}
+
+/* Returns B's type. */
+enum block_type
+block_type (struct block *b)
+{
+  return b->type;
+}
+
+/* Returns a human-readable name for TYPE. */
+const char *
+block_type_name (enum block_type type)
+{
+  static const char *names[BLOCK_TYPE_CNT] =
+    {
+      "disk",
+      "partition",
+      "ramdisk",
+      "stripe",
+    };
+
+  ASSERT (type < BLOCK_TYPE_CNT);
+  return names[type];
+}
+
+/* Returns B's size, in DISK_SECTOR_SIZE-byte sectors. */
+disk_sector_t
+block_size (struct block *b)
+{
+  return b->size;
+}
+
+/* Returns true if B's driver transfers a run of sectors at once,
+   so that block_read_range() and block_write_range() on B cost
+   less than a sector at a time. */
+bool
+block_has_range (struct block *b)
+{
+  return b->ops->read_range != NULL;
+}
+
+/* Panics if the run of CNT sectors starting at SECTOR is not
+   within B. */
+static void
+check_sector (struct block *b, disk_sector_t sector, size_t cnt)
+{
+  if (sector >= b->size || cnt > b->size - sector)
+    PANIC ("%s: access past end of device, sector=%"PRDSNu,
+           b->name, sector);
+}
+
+/* Reads SECTOR from B into BUFFER, which must have room for
+   DISK_SECTOR_SIZE bytes.  Drivers synchronize internally, so
+   external per-device locking is unneeded. */
+void
+block_read (struct block *b, disk_sector_t sector, void *buffer)
+{
+  check_sector (b, sector, 1);
+  b->ops->read (b->aux, sector, buffer);
+  b->read_cnt++;
+}
+
+/* Writes SECTOR to B from BUFFER, which must contain
+   DISK_SECTOR_SIZE bytes.  Returns after the device has
+   acknowledged receiving the data. */
+void
+block_write (struct block *b, disk_sector_t sector, const void *buffer)
+{
+  check_sector (b, sector, 1);
+  b->ops->write (b->aux, sector, buffer);
+  b->write_cnt++;
+}
+
+/* Reads CNT consecutive sectors starting at SECTOR from B into
+   BUFFER, which must have room for CNT * DISK_SECTOR_SIZE bytes.
+   A stripe reads from all of its members at once. */
+void
+block_read_range (struct block *b, disk_sector_t sector, size_t cnt,
+                  void *buffer_)
+{
+  uint8_t *buffer = buffer_;
+  size_t i;
+
+  check_sector (b, sector, cnt);
+  if (b->ops->read_range != NULL)
+    b->ops->read_range (b->aux, sector, cnt, buffer);
+  else
+    for (i = 0; i < cnt; i++)
+      b->ops->read (b->aux, sector + i, buffer + i * DISK_SECTOR_SIZE);
+  b->read_cnt += cnt;
+}
+
+/* Writes CNT consecutive sectors starting at SECTOR to B from
+   BUFFER, which must contain CNT * DISK_SECTOR_SIZE bytes.
+   A stripe writes to all of its members at once. */
+void
+block_write_range (struct block *b, disk_sector_t sector, size_t cnt,
+                   const void *buffer_)
+{
+  const uint8_t *buffer = buffer_;
+  size_t i;
+
+  check_sector (b, sector, cnt);
+  if (b->ops->write_range != NULL)
+    b->ops->write_range (b->aux, sector, cnt, buffer);
+  else
+    for (i = 0; i < cnt; i++)
+      b->ops->write (b->aux, sector + i, buffer + i * DISK_SECTOR_SIZE);
+  b->write_cnt += cnt;
+}
+
+/* Stores the number of sectors read from and written to B in
+   *READ_CNT and *WRITE_CNT. */
+void
+block_get_stats (struct block *b, long long *read_cnt, long long *write_cnt)
+{
+  *read_cnt = b->read_cnt;
+  *write_cnt = b->write_cnt;
+}
+
+/* ATA disk driver: forwards to devices/disk.c. */
+static void
+ata_read (void *d, disk_sector_t sector, void *buffer)
+{
+  disk_read (d, sector, buffer);
+}
+
+static void
+ata_write (void *d, disk_sector_t sector, const void *buffer)
+{
+  disk_write (d, sector, buffer);
+}
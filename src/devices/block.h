@@ -0,0 +1,75 @@
+#ifndef DEVICES_BLOCK_H
+#define DEVICES_BLOCK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices/disk.h"
+
+/* A block device: a fixed number of DISK_SECTOR_SIZE-byte
+   sectors that can be read and written one at a time, or a run
+   at a time.  ATA disks, their partitions, RAM disks, and
+   stripes over other block devices are all block devices. */
+struct block;
+
+/* Kinds of block devices. */
+enum block_type
+  {
+    BLOCK_DISK,                 /* ATA disk. */
+    BLOCK_PARTITION,            /* Partition of another device. */
+    BLOCK_RAMDISK,              /* RAM disk. */
+    BLOCK_STRIPE,               /* RAID-0 stripe over other devices. */
+    BLOCK_TYPE_CNT
+  };
+
+/* Uses that Pintos makes of block devices. */
+enum block_role
+  {
+    BLOCK_FILESYS,              /* File system. */
+    BLOCK_SCRATCH,              /* Scratch disk for "put" and "get". */
+    BLOCK_SWAP,                 /* Swap space. */
+    BLOCK_ROLE_CNT
+  };
+
+/* Operations that a block device driver provides.  READ_RANGE
+   and WRITE_RANGE, which transfer CNT consecutive sectors, may
+   be null, in which case runs are transferred a sector at a
+   time. */
+struct block_operations
+  {
+    void (*read) (void *aux, disk_sector_t, void *buffer);
+    void (*write) (void *aux, disk_sector_t, const void *buffer);
+    void (*read_range) (void *aux, disk_sector_t, size_t cnt,
+                        void *buffer);
+    void (*write_range) (void *aux, disk_sector_t, size_t cnt,
+                         const void *buffer);
+  };
+
+void block_init (void);
+void block_print_stats (void);
+
+struct block *block_register (const char *name, enum block_type,
+                              disk_sector_t size,
+                              const struct block_operations *, void *aux);
+struct block *block_get_by_name (const char *name);
+struct block *block_first (void);
+struct block *block_next (struct block *);
+
+struct block *block_get_role (enum block_role);
+void block_set_role (enum block_role, struct block *);
+bool block_claim (struct block *);
+bool block_is_claimed (struct block *);
+
+const char *block_name (struct block *);
+enum block_type block_type (struct block *);
+const char *block_type_name (enum block_type);
+disk_sector_t block_size (struct block *);
+bool block_has_range (struct block *);
+void block_read (struct block *, disk_sector_t, void *);
+void block_write (struct block *, disk_sector_t, const void *);
+void block_read_range (struct block *, disk_sector_t, size_t cnt, void *);
+void block_write_range (struct block *, disk_sector_t, size_t cnt,
+                        const void *);
+void block_get_stats (struct block *, long long *read_cnt,
+                      long long *write_cnt);
+
+#endif /* devices/block.h */
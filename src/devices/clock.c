@@ -0,0 +1,161 @@
+#include "devices/clock.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+
+/* High-resolution clock.
+
+   Every clock source is a free-running counter with a known
+   frequency.  Until clock_init() runs we use the 8254 PIT,
+   which timer.c can read with sub-tick resolution.  If the CPU
+   has a Time Stamp Counter, clock_init() calibrates it against
+   the PIT and switches to it, since reading it is much cheaper
+   than port I/O and its resolution is much finer.
+
+   Time is reported relative to timer_init(), so that switching
+   sources does not make the clock jump. */
+
+/* Number of timer ticks to calibrate the TSC over. */
+#define CALIBRATE_TICKS 2
+
+static uint64_t pit_read (void);
+static uint64_t tsc_read (void);
+
+static struct clock_source pit_source = {"pit", pit_read, TIMER_PIT_FREQ};
+static struct clock_source tsc_source = {"tsc", tsc_read, 0};
+
+/* The clock source in use. */
+static struct clock_source *clock = &pit_source;
+
+/* Nanoseconds since timer_init() at which the current source's
+   count was CLOCK_BASE. */
+static int64_t clock_base_ns;
+static uint64_t clock_base;
+
+static int64_t cycles_to_ns (uint64_t cycles, uint64_t freq);
+
+/* Calibrates the TSC against the PIT, if the CPU has one, and
+   makes it the clock source.  Interrupts must be on, because
+   calibration waits for timer ticks. */
+void
+clock_init (void) 
+{
+  enum intr_level old_level;
+  uint64_t tsc0, tsc1, pit0, pit1;
+  int64_t start;
+
+  ASSERT (intr_get_level () == INTR_ON);
+
+  if ((cpu_features () & CPUID_TSC) != 0)
+    {
+      old_level = intr_disable ();
+      pit0 = timer_pit_cycles ();
+      tsc0 = rdtsc ();
+      intr_set_level (old_level);
+
+      start = timer_ticks ();
+      while (timer_elapsed (start) < CALIBRATE_TICKS)
+        barrier ();
+
+      old_level = intr_disable ();
+      pit1 = timer_pit_cycles ();
+      tsc1 = rdtsc ();
+      if (pit1 > pit0 && tsc1 > tsc0)
+        {
+          tsc_source.freq = (tsc1 - tsc0) * TIMER_PIT_FREQ / (pit1 - pit0);
+          clock_base_ns = cycles_to_ns (pit1, TIMER_PIT_FREQ);
+          clock_base = tsc1;
+          clock = &tsc_source;
+        }
+      intr_set_level (old_level);
+    }
+
+  printf ("Clock source: %s, %'"PRIu64" Hz.\n", clock->name, clock->freq);
+}
+
+/* Returns the name of the clock source in use. */
+const char *
+clock_name (void) 
+{
+  return clock->name;
+}
+
+/* Returns true if the clock source is the calibrated TSC. */
+bool
+clock_is_tsc (void) 
+{
+  return clock == &tsc_source;
+}
+
+/* Returns the raw count of the clock source in use.  Differences
+   between two counts may be converted with
+   clock_cycles_to_ns(). */
+uint64_t
+clock_read (void) 
+{
+  return clock->read ();
+}
+
+/* Returns the frequency of the clock source in use, in Hz. */
+uint64_t
+clock_freq (void) 
+{
+  return clock->freq;
+}
+
+/* Converts CYCLES counts of the clock source in use into
+   nanoseconds. */
+int64_t
+clock_cycles_to_ns (uint64_t cycles) 
+{
+  return cycles_to_ns (cycles, clock->freq);
+}
+
+/* Returns the number of nanoseconds since timer_init(). */
+int64_t
+clock_ns (void) 
+{
+  if (clock == &pit_source)
+    return cycles_to_ns (pit_read (), TIMER_PIT_FREQ);
+  else
+    return clock_base_ns + clock_cycles_to_ns (clock->read () - clock_base);
+}
+
+/* Busy-waits for approximately NS nanoseconds. */
+void
+clock_spin (int64_t ns) 
+{
+  int64_t end = clock_ns () + ns;
+
+  while (clock_ns () < end)
+    barrier ();
+}
+
+/* Reads the PIT clock source. */
+static uint64_t
+pit_read (void) 
+{
+  enum intr_level old_level = intr_disable ();
+  uint64_t cycles = timer_pit_cycles ();
+  intr_set_level (old_level);
+  return cycles;
+}
+
+/* Reads the TSC clock source. */
+static uint64_t
+tsc_read (void) 
+{
+  return rdtsc ();
+}
+
+/* Converts CYCLES counts at FREQ Hz into nanoseconds, without
+   overflowing for any reasonable uptime. */
+static int64_t
+cycles_to_ns (uint64_t cycles, uint64_t freq) 
+{
+  return (cycles / freq) * NSEC_PER_SEC + (cycles % freq) * NSEC_PER_SEC / freq;
+}
@@ -0,0 +1,30 @@
+#ifndef DEVICES_CLOCK_H
+#define DEVICES_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Nanoseconds per second. */
+#define NSEC_PER_SEC 1000000000
+
+/* A clock source: a free-running counter and its frequency. */
+struct clock_source
+  {
+    const char *name;           /* Name, e.g. "tsc". */
+    uint64_t (*read) (void);    /* Returns the current count. */
+    uint64_t freq;              /* Counts per second. */
+  };
+
+void clock_init (void);
+
+const char *clock_name (void);
+bool clock_is_tsc (void);
+
+uint64_t clock_read (void);
+uint64_t clock_freq (void);
+int64_t clock_cycles_to_ns (uint64_t cycles);
+
+int64_t clock_ns (void);
+void clock_spin (int64_t ns);
+
+#endif /* devices/clock.h */
@@ -7,6 +7,7 @@
 #include "threads/io.h"
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 
 /* The code in this file is an interface to an ATA (IDE)
    controller.  It attempts to comply to [ATA-3]. */
@@ -82,9 +83,17 @@ struct channel
 #define CHANNEL_CNT 2
 static struct channel channels[CHANNEL_CNT];
 
-static void reset_channel (struct channel *);
+/* Identifies disk D and command CMD in a TRACE_DISK_CMD event:
+   channel in bits 12...15, device in bits 8...11, and command in
+   bits 0...7. */
+#define DISK_TRACE_ID(D, CMD) \
+        ((((D)->channel - channels) << 12) | ((D)->dev_no << 8) | (CMD))
+
+static void reset_start (struct channel *, bool present[2]);
+static void reset_finish (struct channel *, const bool present[2]);
 static bool check_device_type (struct disk *);
-static void identify_ata_device (struct disk *);
+static void identify_start (struct disk *);
+static void identify_finish (struct disk *);
 
 static void select_sector (struct disk *, disk_sector_t);
 static void issue_pio_command (struct channel *, uint8_t command);
@@ -95,13 +104,19 @@ static void wait_until_idle (const struct disk *);
 static bool wait_while_busy (const struct disk *);
 static void select_device (const struct disk *);
 static void select_device_wait (const struct disk *);
+static void poll_delay (int *delay);
 
 static void interrupt_handler (struct intr_frame *);
 
-/* Initialize the disk subsystem and detect disks. */
+/* Initialize the disk subsystem and detect disks.
+
+   Probing is done one step at a time across both channels, so
+   that the waits for the two channels' devices overlap. */
 void
 disk_init (void) 
 {
+  bool present[CHANNEL_CNT][2];
+  struct disk *first[CHANNEL_CNT];
   size_t chan_no;
 
   for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
@@ -132,7 +147,7 @@ disk_init (void)
       for (dev_no = 0; dev_no < 2; dev_no++)
         {
           struct disk *d = &c->devices[dev_no];
-          snprintf (d->name, sizeof d->name, "%s:%d", c->name, dev_no);
+          snprintf (d->name, sizeof d->name, "hd%zu:%d", chan_no, dev_no);
           d->channel = c;
           d->dev_no = dev_no;
 
@@ -144,18 +159,53 @@ disk_init (void)
 
       /* Register interrupt handler. */
       intr_register_ext (c->irq, interrupt_handler, c->name);
+    }
 
-      /* Reset hardware. */
-      reset_channel (c);
+  /* Reset hardware.  The ATA standard asks us to wait 2 ms after
+     a reset before looking at the devices. */
+  for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
+    reset_start (&channels[chan_no], present[chan_no]);
+  timer_msleep (2);
+  for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
+    reset_finish (&channels[chan_no], present[chan_no]);
 
-      /* Distinguish ATA hard disks from other devices. */
+  /* Distinguish ATA hard disks from other devices. */
+  for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
+    {
+      struct channel *c = &channels[chan_no];
       if (check_device_type (&c->devices[0]))
         check_device_type (&c->devices[1]);
+    }
+
+  /* Read hard disk identity information.  A channel runs one
+     command at a time, so start the first IDENTIFY DEVICE on
+     every channel before waiting for any of them. */
+  for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
+    {
+      struct channel *c = &channels[chan_no];
+      if (c->devices[0].is_ata)
+        first[chan_no] = &c->devices[0];
+      else if (c->devices[1].is_ata)
+        first[chan_no] = &c->devices[1];
+      else
+        first[chan_no] = NULL;
+      if (first[chan_no] != NULL)
+        identify_start (first[chan_no]);
+    }
+  for (chan_no = 0; chan_no < CHANNEL_CNT; chan_no++)
+    {
+      struct channel *c = &channels[chan_no];
+      int dev_no;
 
-      /* Read hard disk identity information. */
       for (dev_no = 0; dev_no < 2; dev_no++)
-        if (c->devices[dev_no].is_ata)
-          identify_ata_device (&c->devices[dev_no]);
+        {
+          struct disk *d = &c->devices[dev_no];
+          if (!d->is_ata)
+            continue;
+          if (d != first[chan_no])
+            identify_start (d);
+          identify_finish (d);
+        }
     }
 }
 
@@ -179,6 +229,26 @@ disk_print_stats (void)
     }
 }
 
+/* Stores the number of sectors read from and written to disk D
+   into *READ_CNT and *WRITE_CNT. */
+void
+disk_get_stats (struct disk *d, long long *read_cnt, long long *write_cnt) 
+{
+  ASSERT (d != NULL);
+
+  *read_cnt = d->read_cnt;
+  *write_cnt = d->write_cnt;
+}
+
+/* Returns the name of disk D, e.g. "hd0:1". */
+const char *
+disk_name (struct disk *d) 
+{
+  ASSERT (d != NULL);
+
+  return d->name;
+}
+
 /* Returns the disk numbered DEV_NO--either 0 or 1 for master or
    slave, respectively--within the channel numbered CHAN_NO.
 
@@ -187,6 +257,8 @@ disk_print_stats (void)
         0:1 - file system
         1:0 - scratch
         1:1 - swap
+   These are only defaults for the block device roles: see
+   locate_block_devices() in threads/init.c.
 */
 struct disk *
 disk_get (int chan_no, int dev_no) 
@@ -227,6 +299,7 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer)
   c = d->channel;
   lock_acquire (&c->lock);
   select_sector (d, sec_no);
+  TRACE (TRACE_DISK_CMD, sec_no, DISK_TRACE_ID (d, CMD_READ_SECTOR_RETRY));
   issue_pio_command (c, CMD_READ_SECTOR_RETRY);
   sema_down (&c->completion_wait);
   if (!wait_while_busy (d))
@@ -252,6 +325,7 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer)
   c = d->channel;
   lock_acquire (&c->lock);
   select_sector (d, sec_no);
+  TRACE (TRACE_DISK_CMD, sec_no, DISK_TRACE_ID (d, CMD_WRITE_SECTOR_RETRY));
   issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
   if (!wait_while_busy (d))
     PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
@@ -265,12 +339,12 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer)
 
 static void print_ata_string (char *string, size_t size);
 
-/* Resets an ATA channel and waits for any devices present on it
-   to finish the reset. */
+/* Detects which devices are present on ATA channel C, storing
+   the result in PRESENT[], and starts resetting them.
+   reset_finish() waits for the reset to complete. */
 static void
-reset_channel (struct channel *c) 
+reset_start (struct channel *c, bool present[2]) 
 {
-  bool present[2];
   int dev_no;
 
   /* The ATA reset sequence depends on which devices are present,
@@ -301,9 +375,13 @@ reset_channel (struct channel *c)
   outb (reg_ctl (c), CTL_SRST);
   timer_usleep (10);
   outb (reg_ctl (c), 0);
+}
 
-  timer_msleep (150);
-
+/* Waits for the devices on channel C that reset_start() found
+   PRESENT to finish their reset. */
+static void
+reset_finish (struct channel *c, const bool present[2]) 
+{
   /* Wait for device 0 to clear BSY. */
   if (present[0]) 
     {
@@ -314,14 +392,15 @@ reset_channel (struct channel *c)
   /* Wait for device 1 to clear BSY. */
   if (present[1])
     {
-      int i;
+      int64_t start = timer_ticks ();
+      int delay = 0;
 
       select_device (&c->devices[1]);
-      for (i = 0; i < 3000; i++) 
+      while (timer_elapsed (start) < 30 * TIMER_FREQ) 
         {
           if (inb (reg_nsect (c)) == 1 && inb (reg_lbal (c)) == 1)
             break;
-          timer_msleep (10);
+          poll_delay (&delay);
         }
       wait_while_busy (&c->devices[1]);
     }
@@ -359,22 +438,32 @@ check_device_type (struct disk *d)
     }
 }
 
-/* Sends an IDENTIFY DEVICE command to disk D and reads the
-   response.  Initializes D's capacity member based on the result
-   and prints a message describing the disk to the console. */
+/* Sends an IDENTIFY DEVICE command to disk D.  The caller must
+   call identify_finish() before issuing another command on D's
+   channel. */
 static void
-identify_ata_device (struct disk *d) 
+identify_start (struct disk *d) 
+{
+  ASSERT (d->is_ata);
+
+  select_device_wait (d);
+  issue_pio_command (d->channel, CMD_IDENTIFY_DEVICE);
+}
+
+/* Waits for the response to the IDENTIFY DEVICE command sent to
+   disk D by identify_start() and reads it.  Initializes D's
+   capacity member based on the result and prints a message
+   describing the disk to the console. */
+static void
+identify_finish (struct disk *d) 
 {
   struct channel *c = d->channel;
   uint16_t id[DISK_SECTOR_SIZE / 2];
 
   ASSERT (d->is_ata);
 
-  /* Send the IDENTIFY DEVICE command, wait for an interrupt
-     indicating the device's response is ready, and read the data
-     into our buffer. */
-  select_device_wait (d);
-  issue_pio_command (c, CMD_IDENTIFY_DEVICE);
+  /* Wait for an interrupt indicating the device's response is
+     ready, and read the data into our buffer. */
   sema_down (&c->completion_wait);
   if (!wait_while_busy (d))
     {
@@ -504,25 +593,45 @@ static bool
 wait_while_busy (const struct disk *d) 
 {
   struct channel *c = d->channel;
-  int i;
+  int64_t start = timer_ticks ();
+  bool warned = false;
+  int delay = 0;
   
-  for (i = 0; i < 3000; i++)
+  for (;;)
     {
-      if (i == 700)
-        printf ("%s: busy, waiting...", d->name);
       if (!(inb (reg_alt_status (c)) & STA_BSY)) 
         {
-          if (i >= 700)
+          if (warned)
             printf ("ok\n");
           return (inb (reg_alt_status (c)) & STA_DRQ) != 0;
         }
-      timer_msleep (10);
+      if (timer_elapsed (start) >= 30 * TIMER_FREQ)
+        break;
+      if (!warned && timer_elapsed (start) >= 7 * TIMER_FREQ)
+        {
+          printf ("%s: busy, waiting...", d->name);
+          warned = true;
+        }
+      poll_delay (&delay);
     }
 
   printf ("failed\n");
   return false;
 }
 
+/* Sleeps before polling a device again.  *DELAY is the previous
+   delay in microseconds, initially 0.  Delays double from 10 us
+   up to 10 ms, so that a device that is quick to respond is
+   noticed quickly without spinning for long on a slow one. */
+static void
+poll_delay (int *delay) 
+{
+  *delay = *delay == 0 ? 10 : *delay * 2;
+  if (*delay > 10000)
+    *delay = 10000;
+  timer_usleep (*delay);
+}
+
 /* Program D's channel so that D is now the selected disk. */
 static void
 select_device (const struct disk *d)
@@ -558,6 +667,7 @@ interrupt_handler (struct intr_frame *f)
         if (c->expecting_interrupt) 
           {
             inb (reg_status (c));               /* Acknowledge interrupt. */
+            TRACE (TRACE_DISK_DONE, c - channels, 0);
             sema_up (&c->completion_wait);      /* Wake up waiter. */
           }
         else
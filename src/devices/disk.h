@@ -22,5 +22,8 @@ struct disk *disk_get (int chan_no, int dev_no);
 disk_sector_t disk_size (struct disk *);
 void disk_read (struct disk *, disk_sector_t, void *);
 void disk_write (struct disk *, disk_sector_t, const void *);
+void disk_get_stats (struct disk *, long long *read_cnt,
+                     long long *write_cnt);
+const char *disk_name (struct disk *);
 
 #endif /* devices/disk.h */
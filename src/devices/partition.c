@@ -0,0 +1,124 @@
+#include "devices/partition.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/block.h"
+#include "threads/malloc.h"
+
+/* Partitions of a block device, as described by a PC partition
+   table (a "master boot record") in the device's first sector.
+   Only the four primary partitions are supported; extended
+   partitions are skipped.  Each partition is registered as a
+   block device named after its device and its slot in the
+   table, e.g. "hd1:1p2", and reads and writes are forwarded to
+   the device at the partition's offset. */
+
+/* A partition. */
+struct partition
+  {
+    struct block *block;        /* Underlying device. */
+    disk_sector_t start;        /* First sector within BLOCK. */
+  };
+
+/* Format of a partition table entry. */
+struct partition_table_entry
+  {
+    uint8_t bootable;           /* 0x00=not bootable, 0x80=bootable. */
+    uint8_t start_chs[3];       /* Encoded starting cylinder, head, sector. */
+    uint8_t type;               /* Partition type; 0 if unused. */
+    uint8_t end_chs[3];         /* Encoded ending cylinder, head, sector. */
+    uint32_t offset;            /* Start sector offset from the table. */
+    uint32_t size;              /* Number of sectors. */
+  }
+__attribute__ ((packed));
+
+/* Format of the sector that holds the partition table. */
+struct partition_table
+  {
+    uint8_t loader[446];        /* Loader, in a boot sector. */
+    struct partition_table_entry partitions[4]; /* Table entries. */
+    uint16_t signature;         /* Should be 0xaa55. */
+  }
+__attribute__ ((packed));
+
+static bool is_extended (uint8_t type);
+static void partition_read (void *, disk_sector_t, void *);
+static void partition_write (void *, disk_sector_t, const void *);
+
+static const struct block_operations partition_operations =
+  {
+    partition_read,
+    partition_write,
+    NULL,
+    NULL,
+  };
+
+/* Reads the partition table on BLOCK, if there is one, and
+   registers a block device for each valid primary partition. */
+void
+partition_scan (struct block *block)
+{
+  struct partition_table *pt;
+  size_t i;
+
+  if (block_size (block) == 0)
+    return;
+
+  ASSERT (sizeof *pt == DISK_SECTOR_SIZE);
+  pt = malloc (sizeof *pt);
+  if (pt == NULL)
+    PANIC ("%s: out of memory reading partition table", block_name (block));
+  block_read (block, 0, pt);
+
+  if (pt->signature == 0xaa55)
+    for (i = 0; i < sizeof pt->partitions / sizeof *pt->partitions; i++)
+      {
+        struct partition_table_entry *e = &pt->partitions[i];
+        struct partition *p;
+        char name[16];
+
+        if (e->type == 0 || is_extended (e->type))
+          continue;
+        snprintf (name, sizeof name, "%sp%zu", block_name (block), i + 1);
+        if (e->offset == 0 || e->size == 0
+            || e->offset >= block_size (block)
+            || e->size > block_size (block) - e->offset)
+          {
+            printf ("%s: invalid partition table entry ignored\n", name);
+            continue;
+          }
+
+        p = malloc (sizeof *p);
+        if (p == NULL)
+          PANIC ("%s: out of memory registering partition", name);
+        p->block = block;
+        p->start = e->offset;
+        block_register (name, BLOCK_PARTITION, e->size,
+                        &partition_operations, p);
+      }
+
+  free (pt);
+}
+
+/* Returns true if TYPE is one of the partition types that
+   describe an extended partition. */
+static bool
+is_extended (uint8_t type)
+{
+  return type == 0x05 || type == 0x0f || type == 0x85;
+}
+
+/* Partition driver: forwards to the underlying device. */
+static void
+partition_read (void *p_, disk_sector_t sector, void *buffer)
+{
+  struct partition *p = p_;
+  block_read (p->block, p->start + sector, buffer);
+}
+
+static void
+partition_write (void *p_, disk_sector_t sector, const void *buffer)
+{
+  struct partition *p = p_;
+  block_write (p->block, p->start + sector, buffer);
+}
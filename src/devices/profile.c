@@ -0,0 +1,209 @@
+#include "devices/profile.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/io.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/thread-names.h"
+#include "threads/vaddr.h"
+
+/* Statistical profiler.
+
+   When enabled with "-o profile=HZ", we record, HZ times per
+   second, the instruction pointer of the code that was
+   interrupted, the thread that was running it, and whether it
+   was running in user or kernel mode.  At rates up to TIMER_FREQ
+   the samples are taken from the timer interrupt; faster rates
+   use the periodic interrupt of the real-time clock, which runs
+   at a power of two between 2 and 8192 Hz.
+
+   Samples go into a buffer allocated at boot, so that taking
+   one never allocates memory.  profile_dump() prints them to the
+   console at power off, where utils/pintos-prof can pick them
+   up and symbolize them against kernel.o and the user programs.
+   Code that runs with interrupts disabled is never sampled. */
+
+/* One sample. */
+struct sample
+  {
+    uint32_t eip;               /* Interrupted instruction. */
+    tid_t tid;                  /* Running thread. */
+    bool user;                  /* In user mode? */
+  };
+
+/* Size of the sample buffer, in pages. */
+#define SAMPLE_PAGES 32
+#define SAMPLE_CNT (SAMPLE_PAGES * PGSIZE / sizeof (struct sample))
+
+static int requested_hz;        /* Rate requested by "-o profile". */
+static int sample_hz;           /* Actual sampling rate, 0 if off. */
+static int timer_divisor;       /* Timer ticks per sample, or 0. */
+
+static struct sample *samples;  /* Sample buffer. */
+static size_t sample_cnt;       /* Number of samples taken. */
+static long long dropped_cnt;   /* Number of samples not recorded. */
+
+static struct thread_names names; /* Threads seen in samples. */
+
+/* CMOS real-time clock registers, selected through port 0x70
+   with NMI disabled. */
+#define RTC_REG_A 0x8a          /* Periodic interrupt rate. */
+#define RTC_REG_B 0x8b          /* Periodic interrupt enable. */
+#define RTC_REG_C 0x8c          /* Interrupt status. */
+#define RTC_PIE 0x40            /* Periodic interrupt enable bit. */
+#define RTC_BASE_FREQ 32768     /* Periodic rate is derived from this. */
+
+static void record (struct intr_frame *);
+static void rtc_start (int hz);
+static intr_handler_func rtc_interrupt;
+static uint8_t rtc_read (uint8_t reg);
+static void rtc_write (uint8_t reg, uint8_t value);
+
+/* Requests sampling at HZ samples per second, which takes
+   effect when profile_init() is called. */
+void
+profile_configure (int hz) 
+{
+  requested_hz = hz;
+}
+
+/* Allocates the sample buffer and starts sampling, if it was
+   requested.  Must be called after the timer is initialized. */
+void
+profile_init (void) 
+{
+  if (requested_hz <= 0)
+    return;
+
+  samples = palloc_get_multiple (0, SAMPLE_PAGES);
+  if (samples == NULL)
+    {
+      printf ("Profiler: out of memory, not profiling.\n");
+      return;
+    }
+
+  if (requested_hz <= TIMER_FREQ)
+    {
+      timer_divisor = (TIMER_FREQ + requested_hz / 2) / requested_hz;
+      sample_hz = TIMER_FREQ / timer_divisor;
+    }
+  else
+    rtc_start (requested_hz);
+  printf ("Profiler: sampling at %d Hz.\n", sample_hz);
+}
+
+/* Returns true if samples are being taken. */
+bool
+profile_enabled (void) 
+{
+  return sample_hz > 0;
+}
+
+/* Called from the timer interrupt handler with the interrupted
+   context F. */
+void
+profile_timer_tick (struct intr_frame *f) 
+{
+  if (timer_divisor > 0 && timer_ticks () % timer_divisor == 0)
+    record (f);
+}
+
+/* Prints all the samples taken, in the form understood by
+   utils/pintos-prof:
+
+        Profile: N samples at HZ Hz, D dropped
+        PROF-THREAD TID NAME
+        ...
+        PROF TID k|u EIP
+        ...
+        Profile: end */
+void
+profile_dump (void) 
+{
+  size_t i;
+
+  if (sample_hz == 0)
+    return;
+
+  printf ("Profile: %zu samples at %d Hz, %lld dropped\n",
+          sample_cnt, sample_hz, dropped_cnt);
+  thread_names_print (&names, "PROF-THREAD");
+  for (i = 0; i < sample_cnt; i++)
+    printf ("PROF %d %c %#"PRIx32"\n", samples[i].tid,
+            samples[i].user ? 'u' : 'k', samples[i].eip);
+  printf ("Profile: end\n");
+}
+
+/* Records a sample of interrupted context F. */
+static void
+record (struct intr_frame *f) 
+{
+  struct thread *t = thread_current ();
+  struct sample *s;
+
+  if (sample_cnt >= SAMPLE_CNT)
+    {
+      dropped_cnt++;
+      return;
+    }
+
+  s = &samples[sample_cnt++];
+  s->eip = (uint32_t) f->eip;
+  s->tid = t->tid;
+  s->user = (f->cs & 3) == 3;
+  thread_names_add (&names, t);
+}
+
+/* Starts the RTC's periodic interrupt at the lowest rate that is
+   at least HZ, or as fast as it goes. */
+static void
+rtc_start (int hz) 
+{
+  enum intr_level old_level;
+  int rate;
+
+  /* The RTC interrupts at RTC_BASE_FREQ >> (RATE - 1) Hz, for
+     RATE between 3 (8192 Hz) and 15 (2 Hz). */
+  for (rate = 15; rate > 3; rate--)
+    if ((RTC_BASE_FREQ >> (rate - 1)) >= hz)
+      break;
+  sample_hz = RTC_BASE_FREQ >> (rate - 1);
+
+  intr_register_ext (0x28, rtc_interrupt, "RTC");
+
+  old_level = intr_disable ();
+  rtc_write (RTC_REG_A, (rtc_read (RTC_REG_A) & 0xf0) | rate);
+  rtc_write (RTC_REG_B, rtc_read (RTC_REG_B) | RTC_PIE);
+  rtc_read (RTC_REG_C);
+  intr_set_level (old_level);
+}
+
+/* RTC interrupt handler. */
+static void
+rtc_interrupt (struct intr_frame *f) 
+{
+  record (f);
+
+  /* Acknowledge the interrupt, or the RTC won't send another. */
+  rtc_read (RTC_REG_C);
+}
+
+/* Returns the value of RTC register REG. */
+static uint8_t
+rtc_read (uint8_t reg) 
+{
+  outb (0x70, reg);
+  return inb (0x71);
+}
+
+/* Sets RTC register REG to VALUE. */
+static void
+rtc_write (uint8_t reg, uint8_t value) 
+{
+  outb (0x70, reg);
+  outb (0x71, value);
+}
@@ -0,0 +1,14 @@
+#ifndef DEVICES_PROFILE_H
+#define DEVICES_PROFILE_H
+
+#include <stdbool.h>
+
+struct intr_frame;
+
+void profile_configure (int hz);
+void profile_init (void);
+bool profile_enabled (void);
+void profile_timer_tick (struct intr_frame *);
+void profile_dump (void);
+
+#endif /* devices/profile.h */
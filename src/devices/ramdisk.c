@@ -0,0 +1,94 @@
+#include "devices/ramdisk.h"
+#include <debug.h>
+#include <round.h>
+#include <string.h>
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* RAM disk: a block device whose sectors are kept in zeroed
+   pages from the user pool.  All of its pages are allocated when
+   it is created, so that reads and writes never need memory.
+   Everything is lost at shutdown, so a RAM disk used as the file
+   system must be formatted with -f. */
+
+/* Sectors per page. */
+#define SECTORS_PER_PAGE (PGSIZE / DISK_SECTOR_SIZE)
+
+/* A RAM disk. */
+struct ramdisk
+  {
+    struct lock lock;           /* Makes each transfer atomic. */
+    uint8_t **pages;            /* Data pages. */
+  };
+
+static void ramdisk_read (void *, disk_sector_t, void *);
+static void ramdisk_write (void *, disk_sector_t, const void *);
+
+static const struct block_operations ramdisk_operations =
+  {
+    ramdisk_read,
+    ramdisk_write,
+    NULL,
+    NULL,
+  };
+
+/* Creates and registers a RAM disk named NAME with SIZE sectors.
+   Returns the new block device.  Panics if memory is exhausted,
+   since this is only done during boot. */
+struct block *
+ramdisk_create (const char *name, disk_sector_t size)
+{
+  size_t page_cnt = DIV_ROUND_UP (size, SECTORS_PER_PAGE);
+  struct ramdisk *rd;
+  size_t i;
+
+  ASSERT (size > 0);
+
+  rd = malloc (sizeof *rd);
+  if (rd != NULL)
+    rd->pages = calloc (page_cnt, sizeof *rd->pages);
+  if (rd == NULL || rd->pages == NULL)
+    PANIC ("%s: out of memory creating RAM disk", name);
+  for (i = 0; i < page_cnt; i++)
+    {
+      rd->pages[i] = palloc_get_page (PAL_USER | PAL_ZERO);
+      if (rd->pages[i] == NULL)
+        PANIC ("%s: out of memory creating RAM disk "
+               "(%zu of %zu pages allocated)", name, i, page_cnt);
+    }
+  lock_init (&rd->lock);
+
+  return block_register (name, BLOCK_RAMDISK, size, &ramdisk_operations, rd);
+}
+
+/* Returns the address of SECTOR in RD. */
+static uint8_t *
+locate (struct ramdisk *rd, disk_sector_t sector)
+{
+  return (rd->pages[sector / SECTORS_PER_PAGE]
+          + sector % SECTORS_PER_PAGE * DISK_SECTOR_SIZE);
+}
+
+/* RAM disk driver. */
+static void
+ramdisk_read (void *rd_, disk_sector_t sector, void *buffer)
+{
+  struct ramdisk *rd = rd_;
+
+  lock_acquire (&rd->lock);
+  memcpy (buffer, locate (rd, sector), DISK_SECTOR_SIZE);
+  lock_release (&rd->lock);
+}
+
+static void
+ramdisk_write (void *rd_, disk_sector_t sector, const void *buffer)
+{
+  struct ramdisk *rd = rd_;
+
+  lock_acquire (&rd->lock);
+  memcpy (locate (rd, sector), buffer, DISK_SECTOR_SIZE);
+  lock_release (&rd->lock);
+}
@@ -0,0 +1,261 @@
+#include "devices/stripe.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* RAID-0 striping.
+
+   A stripe spreads its sectors over two or more member devices
+   in chunks of STRIPE_CHUNK sectors, round robin: chunk 0 goes
+   to the first member, chunk 1 to the second, and so on.  With
+   members on different ATA channels, which have separate
+   controllers, transfers to the members can overlap.
+
+   A single sector is read or written by the caller itself.  A
+   run of sectors that spans several members is split up: each
+   member's share, except the first one, is handed to a worker
+   thread for that member, and the caller does the first share
+   itself and then waits for the workers to finish.  A member's
+   chunks within a run are adjacent on the member, so each
+   member sees sequential I/O.
+
+   There is no redundancy: losing any member loses the stripe. */
+
+/* Sectors per chunk: one page. */
+#define STRIPE_CHUNK 8
+
+/* A member's share of a run of sectors. */
+struct stripe_job
+  {
+    struct list_elem elem;      /* Element in the member's jobs. */
+    disk_sector_t sector;       /* First sector of the run. */
+    size_t cnt;                 /* Sectors in the run. */
+    uint8_t *buffer;            /* Data for the whole run. */
+    bool write;                 /* Write, or read? */
+    struct semaphore *done;     /* Up'd when the share is done. */
+  };
+
+/* A member device. */
+struct stripe_member
+  {
+    struct stripe *stripe;      /* Stripe it belongs to. */
+    size_t idx;                 /* Index within the stripe. */
+    struct block *block;        /* Device. */
+    struct list jobs;           /* Queued stripe_jobs. */
+    struct lock lock;           /* Protects JOBS. */
+    struct condition queued;    /* Signaled when a job is queued. */
+  };
+
+/* A stripe. */
+struct stripe
+  {
+    size_t member_cnt;          /* Number of members. */
+    struct stripe_member members[STRIPE_MAX];
+  };
+
+static void stripe_read (void *, disk_sector_t, void *);
+static void stripe_write (void *, disk_sector_t, const void *);
+static void stripe_read_range (void *, disk_sector_t, size_t, void *);
+static void stripe_write_range (void *, disk_sector_t, size_t,
+                                const void *);
+static thread_func worker NO_RETURN;
+
+static const struct block_operations stripe_operations =
+  {
+    stripe_read,
+    stripe_write,
+    stripe_read_range,
+    stripe_write_range,
+  };
+
+/* Creates and registers a stripe named NAME over the MEMBER_CNT
+   devices in MEMBERS[], which it claims, and starts a worker
+   thread for each of them.  The stripe is as large as its
+   smallest member allows.  Returns the new block device.  Panics
+   on error, since this is only done during boot. */
+struct block *
+stripe_create (const char *name, struct block *members[], size_t member_cnt)
+{
+  disk_sector_t member_size;
+  struct stripe *s;
+  size_t i;
+
+  if (member_cnt < 2 || member_cnt > STRIPE_MAX)
+    PANIC ("%s: stripe needs 2 to %d devices", name, STRIPE_MAX);
+  s = malloc (sizeof *s);
+  if (s == NULL)
+    PANIC ("%s: out of memory creating stripe", name);
+
+  s->member_cnt = member_cnt;
+  member_size = block_size (members[0]);
+  for (i = 0; i < member_cnt; i++)
+    {
+      struct stripe_member *m = &s->members[i];
+
+      if (!block_claim (members[i]))
+        PANIC ("%s: %s is already in use", name, block_name (members[i]));
+      if (block_size (members[i]) < member_size)
+        member_size = block_size (members[i]);
+
+      m->stripe = s;
+      m->idx = i;
+      m->block = members[i];
+      list_init (&m->jobs);
+      lock_init (&m->lock);
+      cond_init (&m->queued);
+    }
+  member_size -= member_size % STRIPE_CHUNK;
+  if (member_size == 0)
+    PANIC ("%s: stripe members are too small", name);
+
+  for (i = 0; i < member_cnt; i++)
+    {
+      char thread_name[16];
+      snprintf (thread_name, sizeof thread_name, "%s:%zu", name, i);
+      thread_create (thread_name, PRI_DEFAULT, worker, &s->members[i]);
+    }
+
+  return block_register (name, BLOCK_STRIPE, member_size * member_cnt,
+                         &stripe_operations, s);
+}
+
+/* Returns the member of S that holds SECTOR, and stores the
+   sector's number within that member in *MEMBER_SECTOR. */
+static struct stripe_member *
+locate (struct stripe *s, disk_sector_t sector, disk_sector_t *member_sector)
+{
+  disk_sector_t chunk = sector / STRIPE_CHUNK;
+
+  *member_sector = (chunk / s->member_cnt * STRIPE_CHUNK
+                    + sector % STRIPE_CHUNK);
+  return &s->members[chunk % s->member_cnt];
+}
+
+/* Transfers M's share of the CNT sectors of M's stripe starting
+   at SECTOR, whose data is in BUFFER, reading them if WRITE is
+   false and writing them otherwise. */
+static void
+transfer (struct stripe_member *m, disk_sector_t sector, size_t cnt,
+          uint8_t *buffer, bool write)
+{
+  disk_sector_t end = sector + cnt;
+  disk_sector_t chunk_start;
+
+  /* Walk the run a chunk at a time, picking out M's pieces. */
+  chunk_start = sector - sector % STRIPE_CHUNK;
+  while (chunk_start < end)
+    {
+      disk_sector_t first, member_sector;
+      size_t run;
+
+      first = chunk_start > sector ? chunk_start : sector;
+      run = (chunk_start + STRIPE_CHUNK < end ? chunk_start + STRIPE_CHUNK
+             : end) - first;
+      if (locate (m->stripe, first, &member_sector) == m)
+        {
+          uint8_t *data = buffer + (first - sector) * DISK_SECTOR_SIZE;
+          if (write)
+            block_write_range (m->block, member_sector, run, data);
+          else
+            block_read_range (m->block, member_sector, run, data);
+        }
+      chunk_start += STRIPE_CHUNK;
+    }
+}
+
+/* Transfers the CNT sectors of S starting at SECTOR, whose data
+   is in BUFFER, reading them if WRITE is false and writing them
+   otherwise, using every member concerned at once. */
+static void
+transfer_range (struct stripe *s, disk_sector_t sector, size_t cnt,
+                uint8_t *buffer, bool write)
+{
+  struct stripe_job jobs[STRIPE_MAX];
+  struct semaphore done;
+  size_t first, chunk_cnt, member_cnt, i;
+
+  if (cnt == 0)
+    return;
+
+  first = sector / STRIPE_CHUNK % s->member_cnt;
+  chunk_cnt = (sector + cnt - 1) / STRIPE_CHUNK - sector / STRIPE_CHUNK + 1;
+  member_cnt = chunk_cnt < s->member_cnt ? chunk_cnt : s->member_cnt;
+
+  /* Hand the other members' shares to their workers. */
+  sema_init (&done, 0);
+  for (i = 1; i < member_cnt; i++)
+    {
+      struct stripe_member *m = &s->members[(first + i) % s->member_cnt];
+      struct stripe_job *job = &jobs[i];
+
+      job->sector = sector;
+      job->cnt = cnt;
+      job->buffer = buffer;
+      job->write = write;
+      job->done = &done;
+      lock_acquire (&m->lock);
+      list_push_back (&m->jobs, &job->elem);
+      cond_signal (&m->queued, &m->lock);
+      lock_release (&m->lock);
+    }
+
+  transfer (&s->members[first], sector, cnt, buffer, write);
+  for (i = 1; i < member_cnt; i++)
+    sema_down (&done);
+}
+
+/* A worker thread: carries out member M's shares of runs, in
+   the order they were queued, forever. */
+static void
+worker (void *m_)
+{
+  struct stripe_member *m = m_;
+
+  for (;;)
+    {
+      struct stripe_job *job;
+
+      lock_acquire (&m->lock);
+      while (list_empty (&m->jobs))
+        cond_wait (&m->queued, &m->lock);
+      job = list_entry (list_pop_front (&m->jobs), struct stripe_job, elem);
+      lock_release (&m->lock);
+
+      transfer (m, job->sector, job->cnt, job->buffer, job->write);
+      sema_up (job->done);
+    }
+}
+
+/* Stripe driver. */
+static void
+stripe_read (void *s_, disk_sector_t sector, void *buffer)
+{
+  disk_sector_t member_sector;
+  struct stripe_member *m = locate (s_, sector, &member_sector);
+  block_read (m->block, member_sector, buffer);
+}
+
+static void
+stripe_write (void *s_, disk_sector_t sector, const void *buffer)
+{
+  disk_sector_t member_sector;
+  struct stripe_member *m = locate (s_, sector, &member_sector);
+  block_write (m->block, member_sector, buffer);
+}
+
+static void
+stripe_read_range (void *s, disk_sector_t sector, size_t cnt, void *buffer)
+{
+  transfer_range (s, sector, cnt, buffer, false);
+}
+
+static void
+stripe_write_range (void *s, disk_sector_t sector, size_t cnt,
+                    const void *buffer)
+{
+  transfer_range (s, sector, cnt, (uint8_t *) buffer, true);
+}
@@ -0,0 +1,14 @@
+#ifndef DEVICES_STRIPE_H
+#define DEVICES_STRIPE_H
+
+#include <stddef.h>
+
+struct block;
+
+/* Maximum number of devices in a stripe. */
+#define STRIPE_MAX 4
+
+struct block *stripe_create (const char *name, struct block *members[],
+                             size_t member_cnt);
+
+#endif /* devices/stripe.h */
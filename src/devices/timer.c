@@ -7,6 +7,8 @@
 #include "threads/io.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "devices/clock.h"
+#include "devices/profile.h"
   
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -20,12 +22,21 @@
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
+/* 8254 counter 0 reload value, i.e. input clock cycles per
+   tick.  Initialized by timer_init(). */
+static uint16_t pit_count;
+
+/* Last value returned by timer_pit_cycles(), to keep it
+   monotonic. */
+static uint64_t last_pit_cycles;
+
 /* Number of loops per timer tick.
    Initialized by timer_calibrate(). */
 static unsigned loops_per_tick;
 
 static intr_handler_func timer_interrupt;
 static bool too_many_loops (unsigned loops);
+static void calibrate_with_clock (void);
 static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
 
@@ -37,16 +48,20 @@ timer_init (void)
 {
   /* 8254 input frequency divided by TIMER_FREQ, rounded to
      nearest. */
-  uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+  uint16_t count = (TIMER_PIT_FREQ + TIMER_FREQ / 2) / TIMER_FREQ;
 
   outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
   outb (0x40, count & 0xff);
   outb (0x40, count >> 8);
+  pit_count = count;
 
   intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Calibrates loops_per_tick, used to implement brief delays.
+   If clock_init() has already calibrated the TSC, this takes
+   well under a millisecond; otherwise it takes a few dozen timer
+   ticks. */
 void
 timer_calibrate (void) 
 {
@@ -55,6 +70,13 @@ timer_calibrate (void)
     ASSERT (intr_get_level () == INTR_ON);
     printf ("Calibrating timer...  ");
 
+    if (clock_is_tsc ())
+      {
+        calibrate_with_clock ();
+        printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+        return;
+      }
+
     /* Approximate loops_per_tick as the largest power-of-two
      still less than one timer tick. */
     loops_per_tick = 1u << 10;
@@ -92,6 +114,34 @@ timer_elapsed (int64_t then)
   return timer_ticks () - then;
 }
 
+/* Returns the number of 8254 input clock cycles (at
+   TIMER_PIT_FREQ Hz) since timer_init().  Unlike timer_ticks(),
+   this has sub-tick resolution, because it also reads the
+   current count of counter 0.  Must be called with interrupts
+   off. */
+uint64_t
+timer_pit_cycles (void)
+{
+  uint8_t lo, hi;
+  uint64_t cycles;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  outb (0x43, 0x00);    /* CW: counter 0, latch count. */
+  lo = inb (0x40);
+  hi = inb (0x40);
+  cycles = (uint64_t) ticks * pit_count + (pit_count - (lo | (hi << 8)));
+
+  /* If the counter reloaded but its interrupt is still pending,
+     `ticks' lags by one. */
+  if (cycles < last_pit_cycles)
+    cycles += pit_count;
+  if (cycles < last_pit_cycles)
+    cycles = last_pit_cycles;
+  last_pit_cycles = cycles;
+  return cycles;
+}
+
 /* Suspends execution for approximately TICKS timer ticks. */
 void
 timer_sleep (int64_t ticks) 
@@ -133,10 +183,11 @@ timer_print_stats (void)
 
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED)
+timer_interrupt (struct intr_frame *args)
 {
   ticks++;
-  thread_tick ();
+  profile_timer_tick (args);
+  thread_tick (args);
 }
 
 /* Returns true if LOOPS iterations waits for more than one timer
@@ -158,6 +209,37 @@ too_many_loops (unsigned loops)
   return start != ticks;
 }
 
+/* Sets loops_per_tick by timing a fixed number of busy_wait()
+   loops against the high-resolution clock, instead of probing
+   for the loop count that fills a timer tick one tick at a time.
+   Keeps the fastest of a few runs, in case the first ones are
+   slowed by cache misses. */
+static void
+calibrate_with_clock (void) 
+{
+  const int64_t loops = 1 << 16;
+  uint64_t best = UINT64_MAX;
+  uint64_t cycles_per_tick = clock_freq () / TIMER_FREQ;
+  int i;
+
+  for (i = 0; i < 4; i++) 
+    {
+      enum intr_level old_level = intr_disable ();
+      uint64_t start = clock_read ();
+      uint64_t elapsed;
+
+      busy_wait (loops);
+      elapsed = clock_read () - start;
+      intr_set_level (old_level);
+      if (elapsed > 0 && elapsed < best)
+        best = elapsed;
+    }
+
+  loops_per_tick = loops * cycles_per_tick / best;
+  if (loops_per_tick == 0)
+    loops_per_tick = 1;
+}
+
 /* Iterates through a simple loop LOOPS times, for implementing
    brief delays.
 
@@ -192,6 +274,12 @@ real_time_sleep (int64_t num, int32_t denom)
          processes. */                
       timer_sleep (ticks); 
     }
+  else if (clock_is_tsc ())
+    {
+      /* Otherwise, if the TSC has been calibrated, spin on it for
+         accurate sub-tick timing. */
+      clock_spin (num * NSEC_PER_SEC / denom);
+    }
   else 
     {
       /* Otherwise, use a busy-wait loop for more accurate
@@ -7,11 +7,15 @@
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Input clock frequency of the 8254 PIT, in Hz. */
+#define TIMER_PIT_FREQ 1193180
+
 void timer_init (void);
 void timer_calibrate (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+uint64_t timer_pit_cycles (void);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
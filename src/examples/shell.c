@@ -5,6 +5,7 @@
 
 static void read_line (char line[], size_t);
 static bool backspace (char **pos, char line[]);
+static void run_pipeline (char *left, char *right);
 
 int
 main (void)
@@ -26,6 +27,12 @@ main (void)
           if (!chdir (command + 3))
             printf ("\"%s\": chdir failed\n", command + 3);
         }
+      else if (strchr (command, '|') != NULL)
+        {
+          char *bar = strchr (command, '|');
+          *bar = '\0';
+          run_pipeline (command, bar + 1);
+        }
       else if (command[0] == '\0') 
         {
           /* Empty command. */
@@ -102,3 +109,42 @@ backspace (char **pos, char line[])
   else
     return false;
 }
+
+/* Runs LEFT and RIGHT at the same time, with the standard output
+   of LEFT connected to the standard input of RIGHT by a pipe,
+   and waits for both. */
+static void
+run_pipeline (char *left, char *right)
+{
+  pid_t writer, reader;
+  int fds[2];
+
+  if (pipe (fds) != 0)
+    {
+      printf ("pipe failed\n");
+      return;
+    }
+
+  /* Nothing can be printed while our standard output is the
+     pipe.  LEFT also inherits the read end, which we still
+     need, but RIGHT must not inherit the write end or it would
+     never see end-of-file. */
+  dup2 (fds[1], STDOUT_FILENO);
+  close (fds[1]);
+  writer = exec (left);
+  close (STDOUT_FILENO);
+
+  dup2 (fds[0], STDIN_FILENO);
+  close (fds[0]);
+  reader = exec (right);
+  close (STDIN_FILENO);
+
+  if (writer != PID_ERROR)
+    printf ("\"%s\": exit code %d\n", left, wait (writer));
+  else
+    printf ("\"%s\": exec failed\n", left);
+  if (reader != PID_ERROR)
+    printf ("\"%s\": exit code %d\n", right, wait (reader));
+  else
+    printf ("\"%s\": exec failed\n", right);
+}
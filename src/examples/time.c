@@ -0,0 +1,78 @@
+/* time.c
+
+   Runs the command given on the command line and then reports
+   the wall-clock time it took and the resources it used, for
+   example:
+
+        time cat sample.txt */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+
+static int64_t
+elapsed_us (const struct timespec *start, const struct timespec *end) 
+{
+  return ((end->tv_sec - start->tv_sec) * 1000000
+          + (end->tv_nsec - start->tv_nsec) / 1000);
+}
+
+static void
+print_seconds (const char *label, int64_t us) 
+{
+  printf ("%-8s%4d.%03ds\n", label, (int) (us / 1000000),
+          (int) (us / 1000 % 1000));
+}
+
+int
+main (int argc, char *argv[]) 
+{
+  char command[256];
+  struct timespec start, end;
+  struct rusage usage;
+  pid_t pid;
+  int status;
+  int i;
+
+  if (argc < 2) 
+    {
+      printf ("usage: time COMMAND [ARG...]\n");
+      return EXIT_FAILURE;
+    }
+
+  command[0] = '\0';
+  for (i = 1; i < argc; i++) 
+    {
+      if (i > 1)
+        strlcat (command, " ", sizeof command);
+      strlcat (command, argv[i], sizeof command);
+    }
+
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  pid = exec (command);
+  if (pid == PID_ERROR) 
+    {
+      printf ("time: %s: exec failed\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+  status = wait (pid);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  if (getrusage (RUSAGE_CHILDREN, &usage) < 0) 
+    {
+      printf ("time: getrusage failed\n");
+      return EXIT_FAILURE;
+    }
+
+  printf ("\n");
+  print_seconds ("real", elapsed_us (&start, &end));
+  print_seconds ("user", (usage.ru_utime.tv_sec * 1000000
+                          + usage.ru_utime.tv_nsec / 1000));
+  print_seconds ("sys", (usage.ru_stime.tv_sec * 1000000
+                         + usage.ru_stime.tv_nsec / 1000));
+  printf ("%ld page faults (%ld major), %ld sectors read, %ld written, "
+          "%ld system calls\n",
+          usage.ru_minflt + usage.ru_majflt, usage.ru_majflt,
+          usage.ru_inblock, usage.ru_oublock, usage.ru_nsyscalls);
+  return status;
+}
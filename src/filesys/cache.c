@@ -1,8 +1,34 @@
+#include <debug.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "filesys/cache.h"
+#include "devices/block.h"
+#include "threads/thread.h"
+#include "threads/trace.h"
 
-extern struct disk *filesys_disk;
+extern struct block *filesys_disk;
+
+// 한 번의 block_read_range/block_write_range로 옮기는 최대 섹터 수.
+// 한 페이지 분량이다.  stripe에서는 여러 member에 동시에 걸친다.
+#define CACHE_RUN_MAX 8
+
+static long long cache_hit_cnt; // 캐시 hit 횟수.
+static long long cache_miss_cnt; // 캐시 miss 횟수.
+static long long cache_evict_cnt; // 쫓겨난 buffer 수.
+
+// 연속된 섹터를 읽고 쓸 때 쓰는 공간. sema_cache로 보호된다.
+static uint8_t run_buf[CACHE_RUN_MAX * DISK_SECTOR_SIZE];
+
+// 마지막 miss에서 읽은 섹터들 바로 다음 섹터. 다음 miss가 여기면
+// 순차 접근으로 보고 read-ahead 한다. sema_cache로 보호된다.
+static disk_sector_t next_seq_sector = (disk_sector_t) -1;
+
+static struct buffer *find_buff(disk_sector_t index);
+static struct buffer *fill_buff(disk_sector_t index);
+static void write_back_run(void);
+static bool buff_index_less(const struct list_elem *a_,
+                            const struct list_elem *b_, void *aux);
 
 void init_buff_cache() {
 	list_init (&buff_list);
@@ -12,16 +38,54 @@ void init_buff_cache() {
 void destory_buff_cache() {
 	sema_down(&sema_cache);
 
+	// sector 순서로 정렬해서, 연속된 dirty buffer들은 한 번에 쓴다.
+	list_sort (&buff_list, buff_index_less, NULL);
 	while (!list_empty (&buff_list)) {
-		struct list_elem *first_elem = list_pop_front (&buff_list);
-		struct buffer *bf = list_entry (first_elem, struct buffer, elem);
+		struct buffer *bf = list_entry (list_front (&buff_list), struct buffer, elem);
 
-		free_buff (bf);
+		if (bf->dirty)
+			write_back_run ();
+		else {
+			list_pop_front (&buff_list);
+			free_buff (bf);
+		}
 	}
 
 	sema_up(&sema_cache);
 }
 
+// buff_list 맨 앞부터 sector 번호가 연속된 dirty buffer들을
+// CACHE_RUN_MAX개까지 빼내서 한 번에 쓰고 해제한다.
+// buff_list는 sector 순서로 정렬되어 있어야 한다.
+static void write_back_run(void)
+{
+	disk_sector_t start = list_entry (list_front (&buff_list), struct buffer, elem)->index;
+	size_t cnt = 0;
+
+	while (cnt < CACHE_RUN_MAX && !list_empty (&buff_list)) {
+		struct buffer *bf = list_entry (list_front (&buff_list), struct buffer, elem);
+
+		if (!bf->dirty || bf->index != start + cnt)
+			break;
+		memcpy (run_buf + cnt * DISK_SECTOR_SIZE, bf->addr, DISK_SECTOR_SIZE);
+		bf->dirty = false;
+		list_pop_front (&buff_list);
+		free_buff (bf);
+		cnt++;
+	}
+
+	block_write_range (filesys_disk, start, cnt, run_buf);
+}
+
+static bool buff_index_less(const struct list_elem *a_,
+                            const struct list_elem *b_, void *aux UNUSED)
+{
+	const struct buffer *a = list_entry (a_, struct buffer, elem);
+	const struct buffer *b = list_entry (b_, struct buffer, elem);
+
+	return a->index < b->index;
+}
+
 // cache list에서 빼는 작업은 안한다.
 // 그래서 sema가 필요없다.
 void free_buff(struct buffer *bf) {
@@ -43,7 +107,7 @@ void free_buff_with_elem(struct list_elem *bf_elem)
 
 void buffer_write_back(struct buffer *bf)
 {
-	disk_write (filesys_disk, bf->index, bf->addr);
+	block_write (filesys_disk, bf->index, bf->addr);
 }
 
 
@@ -52,37 +116,29 @@ void buffer_write_back(struct buffer *bf)
 	생각해보자.
 */
 void access_buff_cache(enum cache_access access, disk_sector_t index, void *addr, off_t offset, off_t size) {
-	struct list_elem *iter;
-	struct buffer *bf = NULL;
+	struct buffer *bf;
 
 	sema_down(&sema_cache);
 
-	for(iter = list_begin(&buff_list); iter != list_end(&buff_list); iter = list_next(iter)) {
-		bf = list_entry(iter, struct buffer, elem);
-	    if(bf->index == index){
-	    	break;
-	    }
-	    bf = NULL;
+	bf = find_buff(index);
+	if (bf == NULL) {
+		cache_miss_cnt++;
+		TRACE (TRACE_CACHE_MISS, index, access == WRITE);
+		bf = fill_buff(index);
 	}
-
-	if (bf == NULL || iter == list_end(&buff_list)) {
-		bf = malloc (sizeof (struct buffer));
-		bf->addr = malloc (DISK_SECTOR_SIZE);
-		bf->index = index;
-		bf->access = false;
-		bf->dirty = false;
-
-		insert_buff(bf);
-
-		disk_read (filesys_disk, bf->index, bf->addr);
+	else {
+		cache_hit_cnt++;
+		TRACE (TRACE_CACHE_HIT, index, access == WRITE);
 	}
 
 	bf->access = true;
 
 	if (access == READ) {
+		thread_usage ()->read_cnt++;
 		memcpy(addr, bf->addr+offset, size);
 	}
 	else if (access == WRITE) {
+		thread_usage ()->write_cnt++;
 		bf->dirty = true;
 		memcpy(bf->addr+offset, addr, size);
 	}
@@ -90,6 +146,65 @@ void access_buff_cache(enum cache_access access, disk_sector_t index, void *addr
 	sema_up(&sema_cache);
 }
 
+// 캐시에서 index 섹터의 buffer를 찾는다. 없으면 NULL.
+static struct buffer *find_buff(disk_sector_t index)
+{
+	struct list_elem *iter;
+
+	for(iter = list_begin(&buff_list); iter != list_end(&buff_list); iter = list_next(iter)) {
+		struct buffer *bf = list_entry(iter, struct buffer, elem);
+	    if(bf->index == index)
+	    	return bf;
+	}
+	return NULL;
+}
+
+// miss 난 index 섹터를 읽어서 캐시에 넣고, 그 buffer를 돌려준다.
+// 장치가 여러 섹터를 한 번에 옮길 수 있고 (stripe 등) 접근이
+// 순차적으로 보이면, 그 뒤로 캐시에 없는 섹터들도 CACHE_RUN_MAX개까지
+// block_read_range 한 번으로 같이 읽어 둔다 (read-ahead).
+// 그 밖의 경우에 미리 읽으면 디스크 I/O만 늘고 캐시에서 다른
+// buffer를 쫓아내게 된다.
+static struct buffer *fill_buff(disk_sector_t index)
+{
+	disk_sector_t disk_size = block_size (filesys_disk);
+	struct buffer *first = NULL;
+	size_t cnt = 1, i;
+
+	if (index == next_seq_sector && block_has_range (filesys_disk))
+		for (; cnt < CACHE_RUN_MAX && index + cnt < disk_size; cnt++)
+			if (find_buff (index + cnt) != NULL)
+				break;
+	next_seq_sector = index + cnt;
+
+	block_read_range (filesys_disk, index, cnt, run_buf);
+
+	// 먼저 넣은 buffer가 먼저 쫓겨나므로, 뒤의 read-ahead
+	// buffer들을 넣는 동안 first는 쫓겨나지 않는다.
+	for (i = 0; i < cnt; i++) {
+		struct buffer *bf = malloc (sizeof (struct buffer));
+		void *data = malloc (DISK_SECTOR_SIZE);
+
+		if (bf == NULL || data == NULL) {
+			free (bf);
+			free (data);
+			if (i == 0)
+				PANIC ("out of memory for buffer cache");
+			break;
+		}
+		bf->addr = data;
+		bf->index = index + i;
+		bf->access = false;
+		bf->dirty = false;
+		memcpy (bf->addr, run_buf + i * DISK_SECTOR_SIZE, DISK_SECTOR_SIZE);
+
+		insert_buff(bf);
+		if (i == 0)
+			first = bf;
+	}
+	return first;
+}
+
 void insert_buff(struct buffer *bf)
 {
 	int cache_size = get_cache_size();
@@ -105,6 +220,7 @@ void insert_buff(struct buffer *bf)
 
 		list_push_back(&buff_list, &bf->elem);
 		free_buff(victim);
+		cache_evict_cnt++;
 		/*if(iter->access)
 		{
 			iter->access = 0;
@@ -136,4 +252,13 @@ void write_buff(disk_sector_t index, void *addr, off_t offset, off_t size)
 int get_cache_size()
 {
 	return list_size(&buff_list);
-}
\ No newline at end of file
+}
+// 지금까지의 hit, miss, eviction 횟수를 돌려준다.
+void get_cache_stats(long long *hits, long long *misses, long long *evictions)
+{
+	sema_down(&sema_cache);
+	*hits = cache_hit_cnt;
+	*misses = cache_miss_cnt;
+	*evictions = cache_evict_cnt;
+	sema_up(&sema_cache);
+}
@@ -36,5 +36,6 @@ void insert_buff(struct buffer *bf);
 void read_buff(disk_sector_t index, void *addr, off_t offset, off_t size);
 void write_buff(disk_sector_t index, void *addr, off_t offset, off_t size);
 int get_cache_size();
+void get_cache_stats(long long *hits, long long *misses, long long *evictions);
 
 #endif
\ No newline at end of file
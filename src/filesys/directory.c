@@ -304,6 +304,9 @@ struct dir *parse_directory (char *path, bool not_use_last) // 마지막 segment
 
     if(path == NULL || path == '\0' || strlen(path) == 0) return NULL;
 
+    // /proc, /tmp 같이 mount된 곳에는 디렉토리가 없다.
+    if (filesys_is_mounted (path)) return NULL;
+
     buff = malloc (length+1);
     memcpy (buff, path, length+1);
 
@@ -1,7 +1,11 @@
 #include "filesys/file.h"
 #include <debug.h>
 #include "filesys/inode.h"
+#include "filesys/tmpfs.h"
+#include <string.h>
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
 
 /* An open file. */
 
@@ -27,11 +31,67 @@ file_open (struct inode *inode)
     }
 }
 
+/* Opens a read-only file with no inode whose contents are the
+   LENGTH bytes in BUFFER, a page obtained from palloc_get_page(),
+   of which it takes ownership.  If IS_DIR is true, BUFFER holds
+   the names of directory entries, one per line, for
+   file_readdir().  Returns the new file, or a null pointer if an
+   allocation fails or BUFFER is null. */
+struct file *
+file_open_buffer (char *buffer, off_t length, bool is_dir) 
+{
+  struct file *file = calloc (1, sizeof *file);
+
+  ASSERT (length >= 0 && length <= PGSIZE);
+
+  if (buffer != NULL && file != NULL)
+    {
+      file->buffer = buffer;
+      file->buffer_length = length;
+      file->buffer_is_dir = is_dir;
+      return file;
+    }
+  else
+    {
+      palloc_free_page (buffer);
+      free (file);
+      return NULL;
+    }
+}
+
+/* Opens a file whose data is in memory file system node NODE.
+   The caller must account for the new opener of NODE.  Returns
+   the new file, or a null pointer if an allocation fails. */
+struct file *
+file_open_tmpfs (struct tmpfs_node *node) 
+{
+  struct file *file = calloc (1, sizeof *file);
+
+  if (file != NULL)
+    file->tmpfs = node;
+  return file;
+}
+
 /* Opens and returns a new file for the same inode as FILE.
    Returns a null pointer if unsuccessful. */
 struct file *
 file_reopen (struct file *file) 
 {
+  if (file->tmpfs != NULL) 
+    {
+      struct file *new = file_open_tmpfs (file->tmpfs);
+      if (new != NULL)
+        tmpfs_reopen (new->tmpfs);
+      return new;
+    }
+  if (file->inode == NULL) 
+    {
+      char *buffer = palloc_get_page (0);
+      if (buffer != NULL)
+        memcpy (buffer, file->buffer, file->buffer_length);
+      return file_open_buffer (buffer, file->buffer_length,
+                               file->buffer_is_dir);
+    }
   return file_open (inode_reopen (file->inode));
 }
 
@@ -42,12 +102,18 @@ file_close (struct file *file)
   if (file != NULL)
     {
       file_allow_write (file);
-      inode_close (file->inode);
+      if (file->inode != NULL)
+        inode_close (file->inode);
+      else if (file->tmpfs != NULL)
+        tmpfs_close (file->tmpfs);
+      else
+        palloc_free_page (file->buffer);
       free (file); 
     }
 }
 
-/* Returns the inode encapsulated by FILE. */
+/* Returns the inode encapsulated by FILE, or a null pointer if
+   FILE was opened with file_open_buffer() or file_open_tmpfs(). */
 struct inode *
 file_get_inode (struct file *file) 
 {
@@ -62,7 +128,7 @@ file_get_inode (struct file *file)
 off_t
 file_read (struct file *file, void *buffer, off_t size) 
 {
-  off_t bytes_read = inode_read_at (file->inode, buffer, size, file->pos);
+  off_t bytes_read = file_read_at (file, buffer, size, file->pos);
   file->pos += bytes_read;
   return bytes_read;
 }
@@ -75,9 +141,48 @@ file_read (struct file *file, void *buffer, off_t size)
 off_t
 file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs) 
 {
+  if (file->tmpfs != NULL)
+    return tmpfs_read_at (file->tmpfs, buffer, size, file_ofs);
+  if (file->inode == NULL) 
+    {
+      if (file_ofs >= file->buffer_length)
+        return 0;
+      if (size > file->buffer_length - file_ofs)
+        size = file->buffer_length - file_ofs;
+      memcpy (buffer, file->buffer + file_ofs, size);
+      return size;
+    }
   return inode_read_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Reads the next directory entry from FILE, which must have been
+   opened with file_open_buffer() as a directory, into NAME.
+   Returns true if successful, false if no entries are left.
+   Advances FILE's position past the entry. */
+bool
+file_readdir (struct file *file, char *name, size_t size) 
+{
+  off_t end;
+  size_t length;
+
+  ASSERT (file->inode == NULL && file->tmpfs == NULL && file->buffer_is_dir);
+  ASSERT (size > 0);
+
+  if (file->pos >= file->buffer_length)
+    return false;
+  for (end = file->pos; end < file->buffer_length; end++)
+    if (file->buffer[end] == '\n')
+      break;
+
+  length = end - file->pos;
+  if (length >= size)
+    length = size - 1;
+  memcpy (name, file->buffer + file->pos, length);
+  name[length] = '\0';
+  file->pos = end + 1;
+  return true;
+}
+
 /* Writes SIZE bytes from BUFFER into FILE,
    starting at the file's current position.
    Returns the number of bytes actually written,
@@ -88,7 +193,7 @@ file_read_at (struct file *file, void *buffer, off_t size, off_t file_ofs)
 off_t
 file_write (struct file *file, const void *buffer, off_t size) 
 {
-  off_t bytes_written = inode_write_at (file->inode, buffer, size, file->pos);
+  off_t bytes_written = file_write_at (file, buffer, size, file->pos);
   file->pos += bytes_written;
   return bytes_written;
 }
@@ -104,6 +209,10 @@ off_t
 file_write_at (struct file *file, const void *buffer, off_t size,
                off_t file_ofs) 
 {
+  if (file->tmpfs != NULL)
+    return tmpfs_write_at (file->tmpfs, buffer, size, file_ofs);
+  if (file->inode == NULL)
+    return 0;
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
@@ -113,7 +222,7 @@ void
 file_deny_write (struct file *file) 
 {
   ASSERT (file != NULL);
-  if (!file->deny_write) 
+  if (!file->deny_write && file->inode != NULL) 
     {
       file->deny_write = true;
       inode_deny_write (file->inode);
@@ -139,6 +248,10 @@ off_t
 file_length (struct file *file) 
 {
   ASSERT (file != NULL);
+  if (file->tmpfs != NULL)
+    return tmpfs_length (file->tmpfs);
+  if (file->inode == NULL)
+    return file->buffer_length;
   return inode_length (file->inode);
 }
 
@@ -1,20 +1,33 @@
 #ifndef FILESYS_FILE_H
 #define FILESYS_FILE_H
 
+#include <stddef.h>
 #include "filesys/off_t.h"
 #include "filesys/inode.h"
 
 //struct inode;
+struct tmpfs_node;
 
 struct file
 {
-  struct inode *inode;        /* File's inode. */
+  struct inode *inode;        /* File's inode, or null (see below). */
   off_t pos;                  /* Current position. */
   bool deny_write;            /* Has file_deny_write() been called? */
+
+  /* Files without an inode, such as those under /proc, read
+     from a buffer filled in when they were opened. */
+  char *buffer;               /* One page of contents. */
+  off_t buffer_length;        /* Bytes of contents in BUFFER. */
+  bool buffer_is_dir;         /* Does BUFFER list directory entries? */
+
+  /* Files in the memory file system have no inode either. */
+  struct tmpfs_node *tmpfs;   /* File's data, or null. */
 };
 
 /* Opening and closing files. */
 struct file *file_open (struct inode *);
+struct file *file_open_buffer (char *, off_t length, bool is_dir);
+struct file *file_open_tmpfs (struct tmpfs_node *);
 struct file *file_reopen (struct file *);
 void file_close (struct file *);
 struct inode *file_get_inode (struct file *);
@@ -22,6 +35,7 @@ struct inode *file_get_inode (struct file *);
 /* Reading and writing. */
 off_t file_read (struct file *, void *, off_t);
 off_t file_read_at (struct file *, void *, off_t size, off_t start);
+bool file_readdir (struct file *, char *name, size_t size);
 off_t file_write (struct file *, const void *, off_t);
 off_t file_write_at (struct file *, const void *, off_t size, off_t start);
 
@@ -7,12 +7,41 @@
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "filesys/cache.h"
-#include "devices/disk.h"
+#include "filesys/procfs.h"
+#include "filesys/tmpfs.h"
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
 
-/* The disk that contains the file system. */
-struct disk *filesys_disk;
+/* The block device that contains the file system. */
+struct block *filesys_disk;
+
+/* A file system mounted over part of the name space of the disk
+   file system.  Paths at or under PATH go to its handlers, with
+   the part after PATH and any slashes that follow it, so that
+   the mount point itself is "".  Relative paths are made
+   absolute first, so "proc/stat" in the root directory is
+   PROCFS_ROOT "/stat". */
+struct mount
+  {
+    const char *path;                   /* Mount point. */
+    struct file *(*open) (const char *name);
+    bool (*create) (const char *name, off_t initial_size); /* Or null. */
+    bool (*remove) (const char *name);  /* Or null. */
+  };
+
+/* Mounted file systems.  A null CREATE or REMOVE makes a file
+   system read-only. */
+static struct mount mounts[] =
+  {
+    {PROCFS_ROOT, procfs_open, NULL, NULL},
+    {TMPFS_ROOT, tmpfs_open, tmpfs_create, tmpfs_remove},
+  };
+#define MOUNT_CNT (sizeof mounts / sizeof *mounts)
 
 static void do_format (void);
+static const struct mount *find_mount (const char *name, char **path,
+                                       const char **rest);
 
 /* Initializes the file system module.
    If FORMAT is true, reformats the file system. */
@@ -22,12 +51,14 @@ filesys_init (bool format)
   // initiation of buffer cache
   init_buff_cache();
 
-  filesys_disk = disk_get (0, 1);
+  filesys_disk = block_get_role (BLOCK_FILESYS);
   if (filesys_disk == NULL)
-    PANIC ("hd0:1 (hdb) not present, file system initialization failed");
+    PANIC ("No file system device found, can't initialize file system.");
 
   inode_init ();
   free_map_init ();
+  tmpfs_init ();
+  mounts[1].path = tmpfs_root;
 
   if (format) 
     do_format ();
@@ -52,6 +83,19 @@ bool
 filesys_create (const char *name, off_t initial_size) 
 {
   disk_sector_t inode_sector = 0;
+  char *path;
+  const char *rest;
+  const struct mount *mount = find_mount (name, &path, &rest);
+
+  if (mount != NULL)
+    {
+      bool success = (mount->create != NULL
+                      && mount->create (rest, initial_size));
+      free (path);
+      return success;
+    }
+  free (path);
+
   struct dir *dir = parse_directory(name, true);
 
   if(dir == NULL)
@@ -87,6 +131,16 @@ filesys_open (const char *name)
 {
   if(strcmp(name, "/") == 0)
     return file_open(inode_open(ROOT_DIR_SECTOR));
+  char *path;
+  const char *rest;
+  const struct mount *mount = find_mount (name, &path, &rest);
+  if (mount != NULL)
+    {
+      struct file *file = mount->open (rest);
+      free (path);
+      return file;
+    }
+  free (path);
 
   struct dir *dir = parse_directory (name, true);
   if(dir == NULL) return NULL;
@@ -117,6 +171,17 @@ filesys_open (const char *name)
 bool
 filesys_remove (const char *name) 
 {
+  char *path;
+  const char *rest;
+  const struct mount *mount = find_mount (name, &path, &rest);
+  if (mount != NULL)
+    {
+      bool success = mount->remove != NULL && mount->remove (rest);
+      free (path);
+      return success;
+    }
+  free (path);
+
   struct dir *dir = parse_directory(name, true);
 
   if(dir == NULL)
@@ -138,7 +203,101 @@ filesys_remove (const char *name)
   return success;
 }
 
-
+/* Returns true if NAME is in a file system mounted over the disk
+   file system, where directories can't be created or entered. */
+bool
+filesys_is_mounted (const char *name) 
+{
+  char *path;
+  const char *rest;
+  bool mounted = find_mount (name, &path, &rest) != NULL;
+
+  free (path);
+  return mounted;
+}
+
+/* If NAME is at or under a mount point, returns that mount and
+   stores the rest of NAME into *REST.  Otherwise, returns a null
+   pointer.  A relative NAME is first made absolute, in a new
+   string stored into *PATH that *REST points into; the caller
+   must free *PATH, which is otherwise set to a null pointer. */
+static const struct mount *
+find_mount (const char *name, char **path, const char **rest) 
+{
+  size_t i;
+
+  *path = NULL;
+  if (name[0] != '/')
+    {
+      *path = filesys_absolute_path (name);
+      if (*path == NULL)
+        return NULL;
+      name = *path;
+    }
+  for (i = 0; i < MOUNT_CNT; i++)
+    {
+      const struct mount *m = &mounts[i];
+      size_t len = strlen (m->path);
+
+      if (!memcmp (name, m->path, len)
+          && (name[len] == '\0' || name[len] == '/'))
+        {
+          name += len;
+          while (*name == '/')
+            name++;
+          *rest = name;
+          return m;
+        }
+    }
+  return NULL;
+}
+
+/* Returns NAME as an absolute path, in a new string that the
+   caller must free.  A relative NAME is joined to the current
+   thread's working directory, and "." and ".." components are
+   resolved.  Returns a null pointer if memory is exhausted. */
+char *
+filesys_absolute_path (const char *name) 
+{
+  const char *cwd = thread_current ()->cwd_path;
+  char *joined, *path;
+  char *token, *save_ptr;
+  size_t size;
+
+  if (name[0] == '/' || cwd == NULL)
+    cwd = "";
+  size = strlen (cwd) + strlen (name) + 2;
+  joined = malloc (size);
+  path = malloc (size);
+  if (joined == NULL || path == NULL)
+    {
+      free (joined);
+      free (path);
+      return NULL;
+    }
+
+  snprintf (joined, size, "%s/%s", cwd, name);
+  path[0] = '\0';
+  for (token = strtok_r (joined, "/", &save_ptr); token != NULL;
+       token = strtok_r (NULL, "/", &save_ptr))
+    if (!strcmp (token, ".."))
+      {
+        char *slash = strrchr (path, '/');
+        if (slash != NULL)
+          *slash = '\0';
+      }
+    else if (strcmp (token, "."))
+      {
+        strlcat (path, "/", size);
+        strlcat (path, token, size);
+      }
+  if (path[0] == '\0')
+    strlcpy (path, "/", size);
+
+  free (joined);
+  return path;
+}
+
 /* Formats the file system. */
 static void
 do_format (void)
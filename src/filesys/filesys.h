@@ -8,13 +8,15 @@
 #define FREE_MAP_SECTOR 0       /* Free map file inode sector. */
 #define ROOT_DIR_SECTOR 1       /* Root directory file inode sector. */
 
-/* Disk used for file system. */
-extern struct disk *filesys_disk;
+/* Block device used for file system. */
+extern struct block *filesys_disk;
 
 void filesys_init (bool format);
 void filesys_done (void);
 bool filesys_create (const char *name, off_t initial_size);
 struct file *filesys_open (const char *name);
 bool filesys_remove (const char *name);
+bool filesys_is_mounted (const char *name);
+char *filesys_absolute_path (const char *name);
 
 #endif /* filesys/filesys.h */
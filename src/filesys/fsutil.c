@@ -6,7 +6,7 @@
 #include "filesys/directory.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
-#include "devices/disk.h"
+#include "devices/block.h"
 #include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/vaddr.h"
@@ -84,7 +84,7 @@ fsutil_put (char **argv)
   static disk_sector_t sector = 0;
 
   const char *file_name = argv[1];
-  struct disk *src;
+  struct block *src;
   struct file *dst;
   off_t size;
   void *buffer;
@@ -97,12 +97,12 @@ fsutil_put (char **argv)
     PANIC ("couldn't allocate buffer");
 
   /* Open source disk and read file size. */
-  src = disk_get (1, 0);
+  src = block_get_role (BLOCK_SCRATCH);
   if (src == NULL)
-    PANIC ("couldn't open source disk (hdc or hd1:0)");
+    PANIC ("couldn't open scratch device");
 
   /* Read file size. */
-  disk_read (src, sector++, buffer);
+  block_read (src, sector++, buffer);
   if (memcmp (buffer, "PUT", 4))
     PANIC ("%s: missing PUT signature on scratch disk", file_name);
   size = ((int32_t *) buffer)[1];
@@ -129,7 +129,7 @@ fsutil_put (char **argv)
   while (size > 0)
     {
       int chunk_size = size > DISK_SECTOR_SIZE ? DISK_SECTOR_SIZE : size;
-      disk_read (src, sector++, buffer);
+      block_read (src, sector++, buffer);
       if (file_write (dst, buffer, chunk_size) != chunk_size)
         PANIC ("%s: write failed with %"PROTd" bytes unwritten",
                file_name, size);
@@ -160,7 +160,7 @@ fsutil_get (char **argv)
   const char *file_name = argv[1];
   void *buffer;
   struct file *src;
-  struct disk *dst;
+  struct block *dst;
   off_t size;
 
   printf ("Getting '%s' from the file system...\n", file_name);
@@ -177,26 +177,26 @@ fsutil_get (char **argv)
   size = file_length (src);
 
   /* Open target disk. */
-  dst = disk_get (1, 0);
+  dst = block_get_role (BLOCK_SCRATCH);
   if (dst == NULL)
-    PANIC ("couldn't open target disk (hdc or hd1:0)");
+    PANIC ("couldn't open scratch device");
   
   /* Write size to sector 0. */
   memset (buffer, 0, DISK_SECTOR_SIZE);
   memcpy (buffer, "GET", 4);
   ((int32_t *) buffer)[1] = size;
-  disk_write (dst, sector++, buffer);
+  block_write (dst, sector++, buffer);
   
   /* Do copy. */
   while (size > 0) 
     {
       int chunk_size = size > DISK_SECTOR_SIZE ? DISK_SECTOR_SIZE : size;
-      if (sector >= disk_size (dst))
+      if (sector >= block_size (dst))
         PANIC ("%s: out of space on scratch disk", file_name);
       if (file_read (src, buffer, chunk_size) != chunk_size)
         PANIC ("%s: read failed with %"PROTd" bytes unread", file_name, size);
       memset (buffer + chunk_size, 0, DISK_SECTOR_SIZE - chunk_size);
-      disk_write (dst, sector++, buffer);
+      block_write (dst, sector++, buffer);
       size -= chunk_size;
     }
 
@@ -7,6 +7,9 @@
 #include "filesys/free-map.h"
 #include "filesys/cache.h"
 #include "threads/malloc.h"
+#ifdef USERPROG
+#include "userprog/exec-cache.h"
+#endif
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -261,6 +264,9 @@ inode_remove (struct inode *inode)
 {
   ASSERT (inode != NULL);
   inode->removed = true;
+#ifdef USERPROG
+  exec_cache_invalidate (inode->sector);
+#endif
 }
 
 void inode_disk_remove(disk_sector_t sector)
@@ -362,6 +368,13 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   if (inode->deny_write_cnt)
     return 0;
 
+#ifdef USERPROG
+  /* Any cached executable image of this inode is now stale, and
+     so is any being loaded while we write. */
+  if (size > 0)
+    exec_cache_invalidate (inode->sector);
+#endif
+
   if(!inode_expand(&inode->data, inode->sector, offset + size, LV2, inode->data.is_dir)) return 0;
 
   while (size > 0) 
@@ -414,6 +427,13 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
     }
   // free (bounce);
 
+#ifdef USERPROG
+  /* A loader that started during the write may have read part of
+     it. */
+  if (bytes_written > 0)
+    exec_cache_invalidate (inode->sector);
+#endif
+
   return bytes_written;
 }
 
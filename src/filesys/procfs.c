@@ -0,0 +1,319 @@
+/* Read-only virtual directory of runtime statistics at /proc.
+
+   Each file's contents are generated when it is opened, as lines
+   of the form "NAME: VALUE", so a monitoring program samples the
+   running system by opening, reading, and closing a file.  The
+   files are:
+
+        stat     Timer ticks and page faults since boot.
+        sched    Scheduler queue lengths and context switches.
+        locks    Lock acquisitions and how many had to wait.
+        cache    Buffer cache hits, misses, and evictions.
+        disk     Sectors read and written, per block device.
+        meminfo  Free and total pages in each page pool.
+        PID      CPU, I/O, and memory use of user process PID.
+
+   Opening /proc itself gives a directory that lists them all,
+   for readdir(). */
+
+#include "filesys/procfs.h"
+#include <debug.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "devices/block.h"
+#include "devices/timer.h"
+#include "filesys/cache.h"
+#include "filesys/file.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#ifdef USERPROG
+#include "userprog/exception.h"
+#include "userprog/pagedir.h"
+#endif
+
+/* Contents of a /proc file under construction, at most one
+   page. */
+struct proc_buf 
+  {
+    char *data;                 /* Page to write into. */
+    size_t length;              /* Bytes written so far. */
+  };
+
+static void proc_printf (struct proc_buf *, const char *, ...)
+     PRINTF_FORMAT (2, 3);
+
+/* Appends formatted output to B, truncating at the end of its
+   page. */
+static void
+proc_printf (struct proc_buf *b, const char *format, ...) 
+{
+  va_list args;
+  int n;
+
+  va_start (args, format);
+  n = vsnprintf (b->data + b->length, PGSIZE - b->length, format, args);
+  va_end (args);
+
+  if (n > 0 && (size_t) n >= PGSIZE - b->length)
+    n = PGSIZE - b->length - 1;
+  if (n > 0)
+    b->length += n;
+}
+
+static void
+show_stat (struct proc_buf *b) 
+{
+  struct thread_stats st;
+
+  thread_get_stats (&st);
+  proc_printf (b, "uptime-ticks: %lld\n", timer_ticks ());
+  proc_printf (b, "timer-freq: %d\n", TIMER_FREQ);
+  proc_printf (b, "idle-ticks: %lld\n", st.idle_ticks);
+  proc_printf (b, "kernel-ticks: %lld\n", st.kernel_ticks);
+  proc_printf (b, "user-ticks: %lld\n", st.user_ticks);
+#ifdef USERPROG
+  proc_printf (b, "page-faults: %lld\n", exception_page_fault_cnt ());
+#endif
+}
+
+static void
+show_sched (struct proc_buf *b) 
+{
+  struct thread_stats st;
+
+  thread_get_stats (&st);
+  proc_printf (b, "threads: %zu\n", st.thread_cnt);
+  proc_printf (b, "ready: %zu\n", st.ready_cnt);
+  proc_printf (b, "rt-ready: %zu\n", st.rt_ready_cnt);
+  proc_printf (b, "rt-throttled: %zu\n", st.rt_throttled_cnt);
+  proc_printf (b, "context-switches: %lld\n", st.switch_cnt);
+  proc_printf (b, "rt-overruns: %lld\n", st.rt_throttle_cnt);
+  proc_printf (b, "rt-deadline-misses: %lld\n", st.rt_miss_cnt);
+}
+
+static void
+show_locks (struct proc_buf *b) 
+{
+  long long acquire_cnt, contended_cnt;
+
+  lock_get_stats (&acquire_cnt, &contended_cnt);
+  proc_printf (b, "acquires: %lld\n", acquire_cnt);
+  proc_printf (b, "contended: %lld\n", contended_cnt);
+  proc_printf (b, "contended-percent: %lld\n",
+               acquire_cnt > 0 ? contended_cnt * 100 / acquire_cnt : 0);
+}
+
+static void
+show_cache (struct proc_buf *b) 
+{
+  long long hits, misses, evictions;
+
+  get_cache_stats (&hits, &misses, &evictions);
+  proc_printf (b, "sectors: %d\n", get_cache_size ());
+  proc_printf (b, "capacity: %d\n", MAX_CACHE_SIZE);
+  proc_printf (b, "hits: %lld\n", hits);
+  proc_printf (b, "misses: %lld\n", misses);
+  proc_printf (b, "evictions: %lld\n", evictions);
+  proc_printf (b, "hit-percent: %lld\n",
+               hits + misses > 0 ? hits * 100 / (hits + misses) : 0);
+}
+
+static void
+show_disk (struct proc_buf *b) 
+{
+  struct block *d;
+
+  for (d = block_first (); d != NULL; d = block_next (d)) 
+    {
+      long long read_cnt, write_cnt;
+
+      block_get_stats (d, &read_cnt, &write_cnt);
+      proc_printf (b, "%s: %lld reads, %lld writes\n",
+                   block_name (d), read_cnt, write_cnt);
+    }
+}
+
+static void
+show_meminfo (struct proc_buf *b) 
+{
+  size_t free_cnt, page_cnt;
+
+  palloc_get_stats (0, &free_cnt, &page_cnt);
+  proc_printf (b, "kernel-pages: %zu\n", page_cnt);
+  proc_printf (b, "kernel-free: %zu\n", free_cnt);
+  palloc_get_stats (PAL_USER, &free_cnt, &page_cnt);
+  proc_printf (b, "user-pages: %zu\n", page_cnt);
+  proc_printf (b, "user-free: %zu\n", free_cnt);
+}
+
+/* A /proc file other than a process's. */
+struct proc_node 
+  {
+    const char *name;                   /* File name. */
+    void (*show) (struct proc_buf *);   /* Generates its contents. */
+  };
+
+static const struct proc_node nodes[] = 
+  {
+    {"stat", show_stat},
+    {"sched", show_sched},
+    {"locks", show_locks},
+    {"cache", show_cache},
+    {"disk", show_disk},
+    {"meminfo", show_meminfo},
+  };
+
+#define NODE_CNT (sizeof nodes / sizeof *nodes)
+
+#ifdef USERPROG
+/* Returns true if T is the leader of a user process. */
+static bool
+is_process (const struct thread *t) 
+{
+  return t->leader == t && t->pagedir != NULL && t->status != THREAD_DYING;
+}
+
+/* A process, as seen by show_process(). */
+struct process_info 
+  {
+    tid_t pid;                  /* Process to find. */
+    bool found;                 /* Was it found? */
+    char name[16];              /* Its name. */
+    enum thread_status status;  /* Its leader's status. */
+    int thread_cnt;             /* Number of threads. */
+    size_t page_cnt;            /* Resident user pages. */
+    struct usage usage;         /* Resources used by it. */
+    struct usage child_usage;   /* Resources used by its children. */
+  };
+
+/* thread_foreach() callback that fills in the process_info AUX
+   if T is the process it asks for. */
+static void
+find_process (struct thread *t, void *info_) 
+{
+  struct process_info *info = info_;
+
+  if (t->tid == info->pid && is_process (t)) 
+    {
+      info->found = true;
+      strlcpy (info->name, t->name, sizeof info->name);
+      info->status = t->status;
+      info->thread_cnt = 1 + t->uthread_cnt;
+      info->page_cnt = pagedir_count_pages (t->pagedir);
+      info->usage = t->usage;
+      info->child_usage = t->child_usage;
+    }
+}
+
+/* Generates the /proc file for process PID into B.  Returns
+   false if there is no such process. */
+static bool
+show_process (struct proc_buf *b, tid_t pid) 
+{
+  static const char *status_names[] = {"running", "ready", "blocked",
+                                       "dying"};
+  struct process_info info;
+  enum intr_level old_level;
+
+  info.pid = pid;
+  info.found = false;
+  old_level = intr_disable ();
+  thread_foreach (find_process, &info);
+  intr_set_level (old_level);
+  if (!info.found)
+    return false;
+
+  proc_printf (b, "pid: %d\n", pid);
+  proc_printf (b, "name: %s\n", info.name);
+  proc_printf (b, "state: %s\n", status_names[info.status]);
+  proc_printf (b, "threads: %d\n", info.thread_cnt);
+  proc_printf (b, "resident-kB: %zu\n", info.page_cnt * PGSIZE / 1024);
+  proc_printf (b, "user-ticks: %lld\n", info.usage.user_ticks);
+  proc_printf (b, "kernel-ticks: %lld\n", info.usage.kernel_ticks);
+  proc_printf (b, "page-faults: %ld\n", info.usage.fault_cnt);
+  proc_printf (b, "major-faults: %ld\n", info.usage.major_fault_cnt);
+  proc_printf (b, "fs-reads: %ld\n", info.usage.read_cnt);
+  proc_printf (b, "fs-writes: %ld\n", info.usage.write_cnt);
+  proc_printf (b, "syscalls: %ld\n", info.usage.syscall_cnt);
+  proc_printf (b, "children-user-ticks: %lld\n",
+               info.child_usage.user_ticks);
+  proc_printf (b, "children-kernel-ticks: %lld\n",
+               info.child_usage.kernel_ticks);
+  return true;
+}
+
+/* thread_foreach() callback that lists T in the proc_buf AUX if
+   it is a process. */
+static void
+list_process (struct thread *t, void *b) 
+{
+  if (is_process (t))
+    proc_printf (b, "%d\n", t->tid);
+}
+#endif /* USERPROG */
+
+/* Generates the listing of /proc into B. */
+static void
+show_root (struct proc_buf *b) 
+{
+  size_t i;
+
+  for (i = 0; i < NODE_CNT; i++)
+    proc_printf (b, "%s\n", nodes[i].name);
+#ifdef USERPROG
+  {
+    enum intr_level old_level = intr_disable ();
+    thread_foreach (list_process, b);
+    intr_set_level (old_level);
+  }
+#endif
+}
+
+/* Opens NAME, a file in /proc, or /proc itself if NAME is
+   empty.  Returns the new file, or a null pointer if there is no
+   such file or memory allocation fails. */
+struct file *
+procfs_open (const char *name) 
+{
+  struct proc_buf b;
+  bool is_dir = false;
+  bool found = false;
+
+  b.data = palloc_get_page (0);
+  b.length = 0;
+  if (b.data == NULL)
+    return NULL;
+
+  if (*name == '\0') 
+    {
+      show_root (&b);
+      is_dir = found = true;
+    }
+  else if (strchr (name, '/') == NULL) 
+    {
+      size_t i;
+
+      for (i = 0; i < NODE_CNT; i++)
+        if (!strcmp (name, nodes[i].name)) 
+          {
+            nodes[i].show (&b);
+            found = true;
+          }
+#ifdef USERPROG
+      if (!found && name[strspn (name, "0123456789")] == '\0')
+        found = show_process (&b, atoi (name));
+#endif
+    }
+
+  if (!found) 
+    {
+      palloc_free_page (b.data);
+      return NULL;
+    }
+  return file_open_buffer (b.data, b.length, is_dir);
+}
@@ -0,0 +1,11 @@
+#ifndef FILESYS_PROCFS_H
+#define FILESYS_PROCFS_H
+
+#include <stdbool.h>
+
+/* Directory that the process file system appears at. */
+#define PROCFS_ROOT "/proc"
+
+struct file *procfs_open (const char *name);
+
+#endif /* filesys/procfs.h */
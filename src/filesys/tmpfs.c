@@ -0,0 +1,303 @@
+/* Memory file system, mounted at tmpfs_root (by default /tmp).
+
+   Files here never touch the disk: a file's data lives in pages
+   from the user pool, allocated as the file is written, and
+   everything is lost at shutdown.  There are no inodes, free map
+   updates, or buffer cache traffic, which makes this the place
+   for scratch files that are deleted soon after they are made.
+
+   The file system is a single flat directory.  Opening the mount
+   point itself gives a directory listing for readdir(), as
+   for /proc.  A file that is removed while open goes away when
+   it is last closed.  Pages that were never written are holes
+   that read as zeros. */
+
+#include "filesys/tmpfs.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Mount point.  Set by the kernel command line option
+   "-o tmpfs=PATH". */
+const char *tmpfs_root = TMPFS_ROOT;
+
+/* A file. */
+struct tmpfs_node
+  {
+    struct list_elem elem;      /* Element in nodes, unless removed. */
+    char name[NAME_MAX + 1];    /* Name, null-terminated. */
+    off_t length;               /* File size in bytes. */
+    size_t page_cnt;            /* Number of elements in PAGES. */
+    uint8_t **pages;            /* Data pages, or nulls for holes. */
+    int open_cnt;               /* Number of openers. */
+    bool removed;               /* Removed while open? */
+  };
+
+static struct list nodes;       /* All files, in creation order. */
+static struct lock tmpfs_lock;  /* Protects everything here. */
+
+/* Initializes the memory file system. */
+void
+tmpfs_init (void)
+{
+  list_init (&nodes);
+  lock_init (&tmpfs_lock);
+}
+
+/* Returns the file named NAME, or a null pointer if there is
+   none. */
+static struct tmpfs_node *
+lookup (const char *name)
+{
+  struct list_elem *e;
+
+  ASSERT (lock_held_by_current_thread (&tmpfs_lock));
+
+  for (e = list_begin (&nodes); e != list_end (&nodes); e = list_next (e))
+    {
+      struct tmpfs_node *node = list_entry (e, struct tmpfs_node, elem);
+      if (!strcmp (node->name, name))
+        return node;
+    }
+  return NULL;
+}
+
+/* Frees NODE and its data. */
+static void
+destroy (struct tmpfs_node *node)
+{
+  size_t i;
+
+  for (i = 0; i < node->page_cnt; i++)
+    palloc_free_page (node->pages[i]);
+  free (node->pages);
+  free (node);
+}
+
+/* Returns a directory listing, one name per line. */
+static struct file *
+open_root (void)
+{
+  char *buffer = palloc_get_page (0);
+  struct list_elem *e;
+  off_t length = 0;
+
+  if (buffer == NULL)
+    return NULL;
+  for (e = list_begin (&nodes); e != list_end (&nodes); e = list_next (e))
+    {
+      struct tmpfs_node *node = list_entry (e, struct tmpfs_node, elem);
+      size_t name_len = strlen (node->name);
+      if (length + name_len + 1 > PGSIZE)
+        break;
+      memcpy (buffer + length, node->name, name_len);
+      buffer[length + name_len] = '\n';
+      length += name_len + 1;
+    }
+  return file_open_buffer (buffer, length, true);
+}
+
+/* Opens NAME, or the mount point if NAME is empty.  Returns the
+   new file, or a null pointer if there is no such file or
+   memory is exhausted. */
+struct file *
+tmpfs_open (const char *name)
+{
+  struct tmpfs_node *node;
+  struct file *file = NULL;
+
+  lock_acquire (&tmpfs_lock);
+  if (*name == '\0')
+    file = open_root ();
+  else
+    {
+      node = lookup (name);
+      if (node != NULL)
+        {
+          file = file_open_tmpfs (node);
+          if (file != NULL)
+            node->open_cnt++;
+        }
+    }
+  lock_release (&tmpfs_lock);
+  return file;
+}
+
+/* Creates a file named NAME that is INITIAL_SIZE bytes long.
+   Returns false if NAME is not a valid file name, already
+   exists, or if memory is exhausted. */
+bool
+tmpfs_create (const char *name, off_t initial_size)
+{
+  struct tmpfs_node *node;
+
+  if (*name == '\0' || strlen (name) > NAME_MAX
+      || strchr (name, '/') != NULL || initial_size < 0)
+    return false;
+
+  node = calloc (1, sizeof *node);
+  if (node == NULL)
+    return false;
+  strlcpy (node->name, name, sizeof node->name);
+  node->length = initial_size;
+
+  lock_acquire (&tmpfs_lock);
+  if (lookup (name) != NULL)
+    {
+      lock_release (&tmpfs_lock);
+      free (node);
+      return false;
+    }
+  list_push_back (&nodes, &node->elem);
+  lock_release (&tmpfs_lock);
+  return true;
+}
+
+/* Removes the file named NAME.  Returns false if there is no
+   such file. */
+bool
+tmpfs_remove (const char *name)
+{
+  struct tmpfs_node *node;
+
+  lock_acquire (&tmpfs_lock);
+  node = lookup (name);
+  if (node != NULL)
+    {
+      list_remove (&node->elem);
+      if (node->open_cnt == 0)
+        destroy (node);
+      else
+        node->removed = true;
+    }
+  lock_release (&tmpfs_lock);
+  return node != NULL;
+}
+
+/* Records another opener of NODE. */
+void
+tmpfs_reopen (struct tmpfs_node *node)
+{
+  lock_acquire (&tmpfs_lock);
+  node->open_cnt++;
+  lock_release (&tmpfs_lock);
+}
+
+/* Records that an opener of NODE has closed it, and frees NODE
+   if it has been removed and this was the last opener. */
+void
+tmpfs_close (struct tmpfs_node *node)
+{
+  lock_acquire (&tmpfs_lock);
+  ASSERT (node->open_cnt > 0);
+  if (--node->open_cnt == 0 && node->removed)
+    destroy (node);
+  lock_release (&tmpfs_lock);
+}
+
+/* Reads up to SIZE bytes at offset OFS in NODE into BUFFER.
+   Returns the number of bytes read, which is less than SIZE
+   only at end of file. */
+off_t
+tmpfs_read_at (struct tmpfs_node *node, void *buffer_, off_t size,
+               off_t ofs)
+{
+  uint8_t *buffer = buffer_;
+  off_t bytes_read = 0;
+
+  lock_acquire (&tmpfs_lock);
+  if (ofs < node->length && size > node->length - ofs)
+    size = node->length - ofs;
+  while (ofs < node->length && bytes_read < size)
+    {
+      size_t page_idx = ofs / PGSIZE;
+      off_t chunk = PGSIZE - ofs % PGSIZE;
+      if (chunk > size - bytes_read)
+        chunk = size - bytes_read;
+
+      if (page_idx < node->page_cnt && node->pages[page_idx] != NULL)
+        memcpy (buffer + bytes_read, node->pages[page_idx] + ofs % PGSIZE,
+                chunk);
+      else
+        memset (buffer + bytes_read, 0, chunk);
+      bytes_read += chunk;
+      ofs += chunk;
+    }
+  lock_release (&tmpfs_lock);
+  return bytes_read;
+}
+
+/* Makes NODE's page array at least PAGE_CNT elements long.
+   Returns false if memory is exhausted. */
+static bool
+grow_pages (struct tmpfs_node *node, size_t page_cnt)
+{
+  uint8_t **pages;
+
+  if (page_cnt <= node->page_cnt)
+    return true;
+  pages = realloc (node->pages, page_cnt * sizeof *pages);
+  if (pages == NULL)
+    return false;
+  memset (pages + node->page_cnt, 0,
+          (page_cnt - node->page_cnt) * sizeof *pages);
+  node->pages = pages;
+  node->page_cnt = page_cnt;
+  return true;
+}
+
+/* Writes SIZE bytes from BUFFER at offset OFS in NODE, extending
+   the file as needed.  Returns the number of bytes written,
+   which is less than SIZE only if memory is exhausted. */
+off_t
+tmpfs_write_at (struct tmpfs_node *node, const void *buffer_, off_t size,
+                off_t ofs)
+{
+  const uint8_t *buffer = buffer_;
+  off_t bytes_written = 0;
+
+  lock_acquire (&tmpfs_lock);
+  if (size > 0 && !grow_pages (node, DIV_ROUND_UP (ofs + size, PGSIZE)))
+    size = 0;
+  while (bytes_written < size)
+    {
+      size_t page_idx = ofs / PGSIZE;
+      off_t chunk = PGSIZE - ofs % PGSIZE;
+      if (chunk > size - bytes_written)
+        chunk = size - bytes_written;
+
+      if (node->pages[page_idx] == NULL)
+        {
+          node->pages[page_idx] = palloc_get_page (PAL_USER | PAL_ZERO);
+          if (node->pages[page_idx] == NULL)
+            break;
+        }
+      memcpy (node->pages[page_idx] + ofs % PGSIZE, buffer + bytes_written,
+              chunk);
+      bytes_written += chunk;
+      ofs += chunk;
+    }
+  if (ofs > node->length)
+    node->length = ofs;
+  lock_release (&tmpfs_lock);
+  return bytes_written;
+}
+
+/* Returns NODE's length in bytes. */
+off_t
+tmpfs_length (struct tmpfs_node *node)
+{
+  off_t length;
+
+  lock_acquire (&tmpfs_lock);
+  length = node->length;
+  lock_release (&tmpfs_lock);
+  return length;
+}
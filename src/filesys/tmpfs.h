@@ -0,0 +1,29 @@
+#ifndef FILESYS_TMPFS_H
+#define FILESYS_TMPFS_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+/* Default directory that the memory file system appears at. */
+#define TMPFS_ROOT "/tmp"
+
+struct tmpfs_node;
+
+extern const char *tmpfs_root;
+
+void tmpfs_init (void);
+
+/* Mount handlers, for names relative to tmpfs_root. */
+struct file *tmpfs_open (const char *name);
+bool tmpfs_create (const char *name, off_t initial_size);
+bool tmpfs_remove (const char *name);
+
+/* Used by filesys/file.c. */
+void tmpfs_reopen (struct tmpfs_node *);
+void tmpfs_close (struct tmpfs_node *);
+off_t tmpfs_read_at (struct tmpfs_node *, void *, off_t size, off_t ofs);
+off_t tmpfs_write_at (struct tmpfs_node *, const void *, off_t size,
+                      off_t ofs);
+off_t tmpfs_length (struct tmpfs_node *);
+
+#endif /* filesys/tmpfs.h */
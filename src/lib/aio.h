@@ -0,0 +1,21 @@
+#ifndef __LIB_AIO_H
+#define __LIB_AIO_H
+
+/* Operations for struct aiocb. */
+#define AIO_READ 0              /* Read from the file into BUFFER. */
+#define AIO_WRITE 1             /* Write BUFFER to the file. */
+
+/* An asynchronous read or write, submitted with aio_submit().
+   The caller must leave it and its buffer alone until aio_wait()
+   returns it. */
+struct aiocb
+  {
+    int fd;                     /* File descriptor. */
+    int op;                     /* AIO_READ or AIO_WRITE. */
+    void *buffer;               /* Data to read into or write from. */
+    unsigned size;              /* Number of bytes. */
+    unsigned offset;            /* Byte offset in the file. */
+    int result;                 /* Bytes transferred, set on completion. */
+  };
+
+#endif /* lib/aio.h */
@@ -69,6 +69,28 @@ last_mask (const struct bitmap *b)
   return last_bits ? ((elem_type) 1 << last_bits) - 1 : (elem_type) -1;
 }
 
+/* Returns an elem_type in which the CNT bits starting at bit
+   OFS are turned on, where OFS + CNT <= ELEM_BITS. */
+static inline elem_type
+range_mask (size_t ofs, size_t cnt) 
+{
+  ASSERT (cnt > 0 && ofs + cnt <= ELEM_BITS);
+  return ((elem_type) -1 >> (ELEM_BITS - cnt)) << ofs;
+}
+
+/* Returns the index of the lowest 1-bit in X, which must be
+   nonzero.  See the description of the BSF instruction in
+   [IA32-v2a]. */
+static inline size_t
+lowest_set_bit (elem_type x) 
+{
+  elem_type idx;
+
+  ASSERT (x != 0);
+  asm ("bsfl %1, %0" : "=r" (idx) : "rm" (x) : "cc");
+  return idx;
+}
+
 /* Creation and destruction. */
 
 /* Initializes B to be a bitmap of BIT_CNT bits
@@ -214,18 +236,34 @@ bitmap_set_all (struct bitmap *b, bool value)
   bitmap_set_multiple (b, 0, bitmap_size (b), value);
 }
 
-/* Sets the CNT bits starting at START in B to VALUE. */
+/* Sets the CNT bits starting at START in B to VALUE.
+   Each element is updated atomically, but the bits as a whole
+   are not. */
 void
 bitmap_set_multiple (struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
+  size_t end = start + cnt;
   size_t i;
   
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    bitmap_set (b, start + i, value);
+  for (i = start; i < end; ) 
+    {
+      size_t ofs = i % ELEM_BITS;
+      size_t n = end - i < ELEM_BITS - ofs ? end - i : ELEM_BITS - ofs;
+      elem_type mask = range_mask (ofs, n);
+      elem_type *elem = &b->bits[elem_idx (i)];
+
+      /* Atomic on a uniprocessor, as in bitmap_mark() and
+         bitmap_reset(). */
+      if (value)
+        asm ("orl %1, %0" : "+m" (*elem) : "r" (mask) : "cc");
+      else
+        asm ("andl %1, %0" : "+m" (*elem) : "r" (~mask) : "cc");
+      i += n;
+    }
 }
 
 /* Returns the number of bits in B between START and START + CNT,
@@ -251,15 +289,23 @@ bitmap_count (const struct bitmap *b, size_t start, size_t cnt, bool value)
 bool
 bitmap_contains (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
+  size_t end = start + cnt;
   size_t i;
   
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
   ASSERT (start + cnt <= b->bit_cnt);
 
-  for (i = 0; i < cnt; i++)
-    if (bitmap_test (b, start + i) == value)
-      return true;
+  for (i = start; i < end; ) 
+    {
+      size_t ofs = i % ELEM_BITS;
+      size_t n = end - i < ELEM_BITS - ofs ? end - i : ELEM_BITS - ofs;
+      elem_type elem = b->bits[elem_idx (i)];
+
+      if ((value ? elem : ~elem) & range_mask (ofs, n))
+        return true;
+      i += n;
+    }
   return false;
 }
 
@@ -296,16 +342,67 @@ bitmap_all (const struct bitmap *b, size_t start, size_t cnt)
 size_t
 bitmap_scan (const struct bitmap *b, size_t start, size_t cnt, bool value) 
 {
+  size_t run_start, run_len;
+  size_t i;
+
   ASSERT (b != NULL);
   ASSERT (start <= b->bit_cnt);
 
-  if (cnt <= b->bit_cnt) 
+  if (cnt > b->bit_cnt)
+    return BITMAP_ERROR;
+  if (cnt == 0)
+    return start;
+
+  /* Walk the bitmap an element at a time, tracking the run of
+     VALUE bits that ends at bit I.  Elements entirely of VALUE
+     extend the run and elements with none of them are skipped
+     in one step; otherwise BSF finds where the run breaks. */
+  run_start = start;
+  run_len = 0;
+  for (i = start; i < b->bit_cnt; ) 
     {
-      size_t last = b->bit_cnt - cnt;
-      size_t i;
-      for (i = start; i <= last; i++)
-        if (!bitmap_contains (b, i, cnt, !value))
-          return i; 
+      size_t ofs = i % ELEM_BITS;
+      size_t n = (b->bit_cnt - i < ELEM_BITS - ofs
+                  ? b->bit_cnt - i : ELEM_BITS - ofs);
+      elem_type elem = b->bits[elem_idx (i)];
+      elem_type want = ((value ? elem : ~elem) >> ofs) & range_mask (0, n);
+
+      if (run_len == 0) 
+        {
+          /* Not in a run: skip to the next VALUE bit. */
+          size_t skip;
+
+          if (want == 0) 
+            {
+              i += n;
+              continue;
+            }
+          skip = lowest_set_bit (want);
+          i += skip;
+          run_start = i;
+          if (skip > 0)
+            continue;
+        }
+
+      if (want == range_mask (0, n)) 
+        {
+          /* The whole element extends the run. */
+          run_len += n;
+          i += n;
+        }
+      else 
+        {
+          /* The run ends at the first !VALUE bit. */
+          size_t len = lowest_set_bit (~want);
+          run_len += len;
+          if (run_len >= cnt)
+            return run_start;
+          run_len = 0;
+          i += len;
+          continue;
+        }
+      if (run_len >= cnt)
+        return run_start;
     }
   return BITMAP_ERROR;
 }
@@ -12,12 +12,15 @@
 #define list_elem_to_hash_elem(LIST_ELEM)                       \
         list_entry(LIST_ELEM, struct hash_elem, list_elem)
 
-static struct list *find_bucket (struct hash *, struct hash_elem *);
+static struct list *find_bucket (struct hash *, unsigned hash);
 static struct hash_elem *find_elem (struct hash *, struct list *,
                                     struct hash_elem *);
+static struct hash_elem *lookup (struct hash *, unsigned hash,
+                                 struct hash_elem *);
 static void insert_elem (struct hash *, struct list *, struct hash_elem *);
 static void remove_elem (struct hash *, struct hash_elem *);
 static void rehash (struct hash *);
+static void finish_rehash (struct hash *);
 
 /* Initializes hash table H to compute hash values using HASH and
    compare hash elements using LESS, given auxiliary data AUX. */
@@ -28,6 +31,9 @@ hash_init (struct hash *h,
   h->elem_cnt = 0;
   h->bucket_cnt = 4;
   h->buckets = malloc (sizeof *h->buckets * h->bucket_cnt);
+  h->old_bucket_cnt = 0;
+  h->old_buckets = NULL;
+  h->migrate_idx = 0;
   h->hash = hash;
   h->less = less;
   h->aux = aux;
@@ -55,6 +61,7 @@ hash_clear (struct hash *h, hash_action_func *destructor)
 {
   size_t i;
 
+  finish_rehash (h);
   for (i = 0; i < h->bucket_cnt; i++) 
     {
       struct list *bucket = &h->buckets[i];
@@ -89,6 +96,7 @@ hash_destroy (struct hash *h, hash_action_func *destructor)
   if (destructor != NULL)
     hash_clear (h, destructor);
   free (h->buckets);
+  free (h->old_buckets);
 }
 
 /* Inserts NEW into hash table H and returns a null pointer, if
@@ -98,11 +106,11 @@ hash_destroy (struct hash *h, hash_action_func *destructor)
 struct hash_elem *
 hash_insert (struct hash *h, struct hash_elem *new)
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  unsigned hash = h->hash (new, h->aux);
+  struct hash_elem *old = lookup (h, hash, new);
 
   if (old == NULL) 
-    insert_elem (h, bucket, new);
+    insert_elem (h, find_bucket (h, hash), new);
 
   rehash (h);
 
@@ -114,12 +122,12 @@ hash_insert (struct hash *h, struct hash_elem *new)
 struct hash_elem *
 hash_replace (struct hash *h, struct hash_elem *new) 
 {
-  struct list *bucket = find_bucket (h, new);
-  struct hash_elem *old = find_elem (h, bucket, new);
+  unsigned hash = h->hash (new, h->aux);
+  struct hash_elem *old = lookup (h, hash, new);
 
   if (old != NULL)
     remove_elem (h, old);
-  insert_elem (h, bucket, new);
+  insert_elem (h, find_bucket (h, hash), new);
 
   rehash (h);
 
@@ -131,7 +139,7 @@ hash_replace (struct hash *h, struct hash_elem *new)
 struct hash_elem *
 hash_find (struct hash *h, struct hash_elem *e) 
 {
-  return find_elem (h, find_bucket (h, e), e);
+  return lookup (h, h->hash (e, h->aux), e);
 }
 
 /* Finds, removes, and returns an element equal to E in hash
@@ -144,7 +152,7 @@ hash_find (struct hash *h, struct hash_elem *e)
 struct hash_elem *
 hash_delete (struct hash *h, struct hash_elem *e)
 {
-  struct hash_elem *found = find_elem (h, find_bucket (h, e), e);
+  struct hash_elem *found = lookup (h, h->hash (e, h->aux), e);
   if (found != NULL) 
     {
       remove_elem (h, found);
@@ -158,7 +166,8 @@ hash_delete (struct hash *h, struct hash_elem *e)
    Modifying hash table H while hash_apply() is running, using
    any of the functions hash_clear(), hash_destroy(),
    hash_insert(), hash_replace(), or hash_delete(), yields
-   undefined behavior, whether done from ACTION or elsewhere. */
+   undefined behavior, whether done from ACTION or elsewhere.
+   Completes any rehash in progress. */
 void
 hash_apply (struct hash *h, hash_action_func *action) 
 {
@@ -166,6 +175,7 @@ hash_apply (struct hash *h, hash_action_func *action)
   
   ASSERT (action != NULL);
 
+  finish_rehash (h);
   for (i = 0; i < h->bucket_cnt; i++) 
     {
       struct list *bucket = &h->buckets[i];
@@ -195,13 +205,15 @@ hash_apply (struct hash *h, hash_action_func *action)
    Modifying hash table H during iteration, using any of the
    functions hash_clear(), hash_destroy(), hash_insert(),
    hash_replace(), or hash_delete(), invalidates all
-   iterators. */
+   iterators.  Completes any rehash in progress, so that
+   iteration only has to visit one bucket array. */
 void
 hash_first (struct hash_iterator *i, struct hash *h) 
 {
   ASSERT (i != NULL);
   ASSERT (h != NULL);
 
+  finish_rehash (h);
   i->hash = h;
   i->bucket = i->hash->buckets;
   i->elem = list_elem_to_hash_elem (list_head (i->bucket));
@@ -301,14 +313,29 @@ hash_int (int i)
   return hash_bytes (&i, sizeof i);
 }
 
-/* Returns the bucket in H that E belongs in. */
+/* Returns the bucket in H that an element with hash value HASH
+   belongs in. */
 static struct list *
-find_bucket (struct hash *h, struct hash_elem *e) 
+find_bucket (struct hash *h, unsigned hash) 
 {
-  size_t bucket_idx = h->hash (e, h->aux) & (h->bucket_cnt - 1);
+  size_t bucket_idx = hash & (h->bucket_cnt - 1);
   return &h->buckets[bucket_idx];
 }
 
+/* Returns the old bucket in H that may still hold an element
+   with hash value HASH, or a null pointer if H is not being
+   rehashed or that bucket has already been moved. */
+static struct list *
+find_old_bucket (struct hash *h, unsigned hash) 
+{
+  size_t bucket_idx;
+
+  if (h->old_buckets == NULL)
+    return NULL;
+  bucket_idx = hash & (h->old_bucket_cnt - 1);
+  return bucket_idx >= h->migrate_idx ? &h->old_buckets[bucket_idx] : NULL;
+}
+
 /* Searches BUCKET in H for a hash element equal to E.  Returns
    it if found or a null pointer otherwise. */
 static struct hash_elem *
@@ -325,6 +352,22 @@ find_elem (struct hash *h, struct list *bucket, struct hash_elem *e)
   return NULL;
 }
 
+/* Searches H for a hash element equal to E, whose hash value is
+   HASH, in both the current buckets and, during a rehash, the
+   old ones.  Returns it if found or a null pointer otherwise. */
+static struct hash_elem *
+lookup (struct hash *h, unsigned hash, struct hash_elem *e) 
+{
+  struct hash_elem *found = find_elem (h, find_bucket (h, hash), e);
+  if (found == NULL) 
+    {
+      struct list *old_bucket = find_old_bucket (h, hash);
+      if (old_bucket != NULL)
+        found = find_elem (h, old_bucket, e);
+    }
+  return found;
+}
+
 /* Returns X with its lowest-order bit set to 1 turned off. */
 static inline size_t
 turn_off_least_1bit (size_t x) 
@@ -344,72 +387,106 @@ is_power_of_2 (size_t x)
 #define BEST_ELEMS_PER_BUCKET 2 /* Ideal elems/bucket. */
 #define MAX_ELEMS_PER_BUCKET  4 /* Elems/bucket > 4: increase # of buckets. */
 
-/* Changes the number of buckets in hash table H to match the
-   ideal.  This function can fail because of an out-of-memory
-   condition, but that'll just make hash accesses less efficient;
-   we can still continue. */
+/* Number of old buckets moved by each insertion or deletion
+   while a rehash is in progress.  A resize that becomes due
+   during a rehash waits until the rehash finishes. */
+#define REHASH_STEP 2
+
+/* Moves the elements in the next old bucket in H into the new
+   buckets, and frees the old buckets once all have been
+   moved. */
 static void
-rehash (struct hash *h) 
+migrate_bucket (struct hash *h) 
 {
-  size_t old_bucket_cnt, new_bucket_cnt;
-  struct list *new_buckets, *old_buckets;
-  size_t i;
+  struct list *old_bucket = &h->old_buckets[h->migrate_idx++];
 
-  ASSERT (h != NULL);
+  while (!list_empty (old_bucket)) 
+    {
+      struct list_elem *elem = list_pop_front (old_bucket);
+      struct hash_elem *e = list_elem_to_hash_elem (elem);
+      list_push_front (find_bucket (h, h->hash (e, h->aux)), elem);
+    }
 
-  /* Save old bucket info for later use. */
-  old_buckets = h->buckets;
-  old_bucket_cnt = h->bucket_cnt;
-
-  /* Calculate the number of buckets to use now.
-     We want one bucket for about every BEST_ELEMS_PER_BUCKET.
-     We must have at least four buckets, and the number of
-     buckets must be a power of 2. */
-  new_bucket_cnt = h->elem_cnt / BEST_ELEMS_PER_BUCKET;
-  if (new_bucket_cnt < 4)
-    new_bucket_cnt = 4;
-  while (!is_power_of_2 (new_bucket_cnt))
-    new_bucket_cnt = turn_off_least_1bit (new_bucket_cnt);
-
-  /* Don't do anything if the bucket count wouldn't change. */
-  if (new_bucket_cnt == old_bucket_cnt)
-    return;
-
-  /* Allocate new buckets and initialize them as empty. */
-  new_buckets = malloc (sizeof *new_buckets * new_bucket_cnt);
-  if (new_buckets == NULL) 
+  if (h->migrate_idx >= h->old_bucket_cnt) 
     {
-      /* Allocation failed.  This means that use of the hash table will
-         be less efficient.  However, it is still usable, so
-         there's no reason for it to be an error. */
-      return;
+      free (h->old_buckets);
+      h->old_buckets = NULL;
+      h->old_bucket_cnt = 0;
+      h->migrate_idx = 0;
     }
-  for (i = 0; i < new_bucket_cnt; i++) 
-    list_init (&new_buckets[i]);
+}
+
+/* Moves every remaining old bucket in H, if H is being
+   rehashed. */
+static void
+finish_rehash (struct hash *h) 
+{
+  while (h->old_buckets != NULL)
+    migrate_bucket (h);
+}
 
-  /* Install new bucket info. */
-  h->buckets = new_buckets;
-  h->bucket_cnt = new_bucket_cnt;
+/* Continues a rehash of H that is in progress, or starts one if
+   the number of elements per bucket has left the range between
+   MIN_ELEMS_PER_BUCKET and MAX_ELEMS_PER_BUCKET.  Starting a
+   rehash only allocates the new, empty bucket array; the
+   elements move over REHASH_STEP buckets at a time on this and
+   later calls.  This function can fail because of an
+   out-of-memory condition, but that'll just make hash accesses
+   less efficient; we can still continue. */
+static void
+rehash (struct hash *h) 
+{
+  size_t new_bucket_cnt;
+  struct list *new_buckets;
+  size_t i;
 
-  /* Move each old element into the appropriate new bucket. */
-  for (i = 0; i < old_bucket_cnt; i++) 
-    {
-      struct list *old_bucket;
-      struct list_elem *elem, *next;
+  ASSERT (h != NULL);
 
-      old_bucket = &old_buckets[i];
-      for (elem = list_begin (old_bucket);
-           elem != list_end (old_bucket); elem = next) 
+  if (h->old_buckets == NULL) 
+    {
+      /* Don't do anything while the load is acceptable. */
+      if (h->elem_cnt >= h->bucket_cnt * MIN_ELEMS_PER_BUCKET
+          && h->elem_cnt <= h->bucket_cnt * MAX_ELEMS_PER_BUCKET)
+        return;
+
+      /* Calculate the number of buckets to use now.
+         We want one bucket for about every BEST_ELEMS_PER_BUCKET.
+         We must have at least four buckets, and the number of
+         buckets must be a power of 2. */
+      new_bucket_cnt = h->elem_cnt / BEST_ELEMS_PER_BUCKET;
+      if (new_bucket_cnt < 4)
+        new_bucket_cnt = 4;
+      while (!is_power_of_2 (new_bucket_cnt))
+        new_bucket_cnt = turn_off_least_1bit (new_bucket_cnt);
+
+      /* Don't do anything if the bucket count wouldn't change. */
+      if (new_bucket_cnt == h->bucket_cnt)
+        return;
+
+      /* Allocate new buckets and initialize them as empty. */
+      new_buckets = malloc (sizeof *new_buckets * new_bucket_cnt);
+      if (new_buckets == NULL) 
         {
-          struct list *new_bucket
-            = find_bucket (h, list_elem_to_hash_elem (elem));
-          next = list_next (elem);
-          list_remove (elem);
-          list_push_front (new_bucket, elem);
+          /* Allocation failed.  This means that use of the hash
+             table will be less efficient.  However, it is still
+             usable, so there's no reason for it to be an
+             error. */
+          return;
         }
+      for (i = 0; i < new_bucket_cnt; i++) 
+        list_init (&new_buckets[i]);
+
+      /* Install new bucket info, keeping the old buckets until
+         their elements have been moved. */
+      h->old_buckets = h->buckets;
+      h->old_bucket_cnt = h->bucket_cnt;
+      h->migrate_idx = 0;
+      h->buckets = new_buckets;
+      h->bucket_cnt = new_bucket_cnt;
     }
 
-  free (old_buckets);
+  for (i = 0; i < REHASH_STEP && h->old_buckets != NULL; i++)
+    migrate_bucket (h);
 }
 
 /* Inserts E into BUCKET (in hash table H). */
@@ -428,3 +505,165 @@ remove_elem (struct hash *h, struct hash_elem *e)
   list_remove (&e->list_elem);
 }
 
+
+/* Open-addressing maps. */
+
+/* A slot in a hash_map.  A key of 0 marks an empty slot. */
+struct hash_map_slot 
+  {
+    uintptr_t key;
+    void *value;
+  };
+
+/* Returns the preferred slot index for KEY in M.  Keys such as
+   page addresses have their low bits all zero, so mix the high
+   bits of the key down with a multiplicative hash first. */
+static inline size_t
+map_home (const struct hash_map *m, uintptr_t key) 
+{
+  uint32_t hash = key * 2654435769u;
+  return (hash ^ (hash >> 16)) & (m->slot_cnt - 1);
+}
+
+/* Initializes M as an empty map.  Returns true if successful,
+   false if memory allocation failed. */
+bool
+hash_map_init (struct hash_map *m) 
+{
+  m->elem_cnt = 0;
+  m->slot_cnt = 16;
+  m->slots = calloc (m->slot_cnt, sizeof *m->slots);
+  return m->slots != NULL;
+}
+
+/* Frees the storage used by M.  The values it maps to are not
+   touched. */
+void
+hash_map_destroy (struct hash_map *m) 
+{
+  free (m->slots);
+}
+
+/* Returns the slot in M that holds KEY, or the empty slot where
+   KEY would go if M does not contain it. */
+static struct hash_map_slot *
+map_probe (const struct hash_map *m, uintptr_t key) 
+{
+  size_t i;
+
+  for (i = map_home (m, key); ; i = (i + 1) & (m->slot_cnt - 1)) 
+    {
+      struct hash_map_slot *s = &m->slots[i];
+      if (s->key == key || s->key == 0)
+        return s;
+    }
+}
+
+/* Doubles the number of slots in M.  Returns true if
+   successful, false if memory allocation failed. */
+static bool
+map_grow (struct hash_map *m) 
+{
+  struct hash_map_slot *old_slots = m->slots;
+  size_t old_slot_cnt = m->slot_cnt;
+  size_t i;
+
+  m->slots = calloc (old_slot_cnt * 2, sizeof *m->slots);
+  if (m->slots == NULL) 
+    {
+      m->slots = old_slots;
+      return false;
+    }
+  m->slot_cnt = old_slot_cnt * 2;
+
+  for (i = 0; i < old_slot_cnt; i++)
+    if (old_slots[i].key != 0)
+      *map_probe (m, old_slots[i].key) = old_slots[i];
+  free (old_slots);
+  return true;
+}
+
+/* Maps KEY, which must be nonzero, to VALUE in M, replacing any
+   previous mapping for KEY.  Returns true if successful, false
+   if memory allocation failed. */
+bool
+hash_map_insert (struct hash_map *m, uintptr_t key, void *value) 
+{
+  struct hash_map_slot *s;
+
+  ASSERT (key != 0);
+
+  s = map_probe (m, key);
+  if (s->key == 0) 
+    {
+      /* Keep the map at most half full, so probe sequences stay
+         short. */
+      if ((m->elem_cnt + 1) * 2 > m->slot_cnt) 
+        {
+          if (!map_grow (m))
+            return false;
+          s = map_probe (m, key);
+        }
+      m->elem_cnt++;
+      s->key = key;
+    }
+  s->value = value;
+  return true;
+}
+
+/* Returns the value that KEY maps to in M, or a null pointer if
+   M does not contain KEY. */
+void *
+hash_map_find (const struct hash_map *m, uintptr_t key) 
+{
+  ASSERT (key != 0);
+
+  return map_probe (m, key)->value;
+}
+
+/* Removes KEY from M and returns the value it mapped to, or a
+   null pointer if M does not contain KEY. */
+void *
+hash_map_delete (struct hash_map *m, uintptr_t key) 
+{
+  struct hash_map_slot *s;
+  void *value;
+  size_t hole, i;
+
+  ASSERT (key != 0);
+
+  s = map_probe (m, key);
+  if (s->key == 0)
+    return NULL;
+  value = s->value;
+  m->elem_cnt--;
+
+  /* Close the hole by moving back later keys in the same probe
+   sequence, instead of leaving a tombstone. */
+  hole = s - m->slots;
+  for (i = (hole + 1) & (m->slot_cnt - 1); m->slots[i].key != 0;
+       i = (i + 1) & (m->slot_cnt - 1)) 
+    {
+      size_t mask = m->slot_cnt - 1;
+      size_t home = map_home (m, m->slots[i].key);
+
+      /* The key at I may fill the hole only if the hole lies on
+         its probe sequence, that is, cyclically between its home
+         slot and I. */
+      if (((i - home) & mask) >= ((i - hole) & mask)) 
+        {
+          m->slots[hole] = m->slots[i];
+          hole = i;
+        }
+    }
+  m->slots[hole].key = 0;
+  m->slots[hole].value = NULL;
+  return value;
+}
+
+/* Returns the number of keys in M. */
+size_t
+hash_map_size (const struct hash_map *m) 
+{
+  return m->elem_cnt;
+}
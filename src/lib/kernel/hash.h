@@ -18,7 +18,16 @@
    conversion from a struct hash_elem back to a structure object
    that contains it.  This is the same technique used in the
    linked list implementation.  Refer to lib/kernel/list.h for a
-   detailed explanation. */
+   detailed explanation.
+
+   The table is resized incrementally.  When it grows or shrinks,
+   the old bucket array stays live alongside the new one and each
+   insertion or deletion moves a few old buckets across, so no
+   single operation pays for moving every element.
+
+   For small integer keys, such as page addresses, struct
+   hash_map below is an open-addressing table that maps keys to
+   pointers without chaining. */
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -61,6 +70,9 @@ struct hash
     size_t elem_cnt;            /* Number of elements in table. */
     size_t bucket_cnt;          /* Number of buckets, a power of 2. */
     struct list *buckets;       /* Array of `bucket_cnt' lists. */
+    size_t old_bucket_cnt;      /* Number of buckets in `old_buckets'. */
+    struct list *old_buckets;   /* Buckets being rehashed, or null. */
+    size_t migrate_idx;         /* First old bucket not yet moved. */
     hash_hash_func *hash;       /* Hash function. */
     hash_less_func *less;       /* Comparison function. */
     void *aux;                  /* Auxiliary data for `hash' and `less'. */
@@ -95,6 +107,21 @@ struct hash_elem *hash_cur (struct hash_iterator *);
 size_t hash_size (struct hash *);
 bool hash_empty (struct hash *);
 
+/* Open-addressing map from nonzero integer keys to pointers. */
+struct hash_map 
+  {
+    size_t elem_cnt;            /* Number of keys in map. */
+    size_t slot_cnt;            /* Number of slots, a power of 2. */
+    struct hash_map_slot *slots; /* Array of `slot_cnt' slots. */
+  };
+
+bool hash_map_init (struct hash_map *);
+void hash_map_destroy (struct hash_map *);
+bool hash_map_insert (struct hash_map *, uintptr_t key, void *value);
+void *hash_map_find (const struct hash_map *, uintptr_t key);
+void *hash_map_delete (struct hash_map *, uintptr_t key);
+size_t hash_map_size (const struct hash_map *);
+
 /* Sample hash functions. */
 unsigned hash_bytes (const void *, size_t);
 unsigned hash_string (const char *);
@@ -0,0 +1,22 @@
+#ifndef __LIB_RESOURCE_H
+#define __LIB_RESOURCE_H
+
+#include <time.h>
+
+/* Whose usage getrusage() reports. */
+#define RUSAGE_SELF 0           /* The calling process. */
+#define RUSAGE_CHILDREN (-1)    /* Its children that have exited. */
+
+/* Resources used by a process. */
+struct rusage
+  {
+    struct timespec ru_utime;   /* CPU time in user mode. */
+    struct timespec ru_stime;   /* CPU time in kernel mode. */
+    long ru_minflt;             /* Page faults served without I/O. */
+    long ru_majflt;             /* Page faults that required I/O. */
+    long ru_inblock;            /* Sectors read through the cache. */
+    long ru_oublock;            /* Sectors written through the cache. */
+    long ru_nsyscalls;          /* System calls made. */
+  };
+
+#endif /* lib/resource.h */
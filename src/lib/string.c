@@ -1,5 +1,71 @@
 #include <string.h>
 #include <debug.h>
+#include <stdint.h>
+
+/* Blocks shorter than this are copied or set a byte at a time:
+   aligning and setting up a string instruction costs more than
+   it saves. */
+#define WORD_THRESHOLD 16
+
+/* Copies SIZE bytes upward from SRC to DST, a word at a time
+   once DST is aligned.  Safe if DST <= SRC even if they
+   overlap, because each word is read before it is written and
+   nothing already written is read again. */
+static void
+copy_up (unsigned char *dst, const unsigned char *src, size_t size) 
+{
+  if (size >= WORD_THRESHOLD) 
+    {
+      size_t head = -(uintptr_t) dst & 3;
+      size_t words;
+
+      size -= head;
+      while (head-- > 0)
+        *dst++ = *src++;
+
+      words = size / 4;
+      size %= 4;
+      asm volatile ("rep movsl"
+                    : "+D" (dst), "+S" (src), "+c" (words)
+                    : : "memory");
+    }
+  while (size-- > 0)
+    *dst++ = *src++;
+}
+
+/* Copies SIZE bytes downward from SRC to DST, a word at a time
+   once the end of DST is aligned.  Safe if DST >= SRC even if
+   they overlap. */
+static void
+copy_down (unsigned char *dst, const unsigned char *src, size_t size) 
+{
+  dst += size;
+  src += size;
+  if (size >= WORD_THRESHOLD) 
+    {
+      size_t tail = (uintptr_t) dst & 3;
+      size_t words;
+
+      size -= tail;
+      while (tail-- > 0)
+        *--dst = *--src;
+
+      /* With the direction flag set, "rep movsl" copies from
+         the word at ESI to the one at EDI and then steps both
+         down by 4. */
+      words = size / 4;
+      size %= 4;
+      dst -= 4;
+      src -= 4;
+      asm volatile ("std; rep movsl; cld"
+                    : "+D" (dst), "+S" (src), "+c" (words)
+                    : : "memory");
+      dst += 4;
+      src += 4;
+    }
+  while (size-- > 0)
+    *--dst = *--src;
+}
 
 /* Copies SIZE bytes from SRC to DST, which must not overlap.
    Returns DST. */
@@ -12,9 +78,7 @@ memcpy (void *dst_, const void *src_, size_t size)
   ASSERT (dst != NULL || size == 0);
   ASSERT (src != NULL || size == 0);
 
-  while (size-- > 0)
-    *dst++ = *src++;
-
+  copy_up (dst, src, size);
   return dst_;
 }
 
@@ -29,20 +93,12 @@ memmove (void *dst_, const void *src_, size_t size)
   ASSERT (dst != NULL || size == 0);
   ASSERT (src != NULL || size == 0);
 
-  if (dst < src) 
-    {
-      while (size-- > 0)
-        *dst++ = *src++;
-    }
-  else 
-    {
-      dst += size;
-      src += size;
-      while (size-- > 0)
-        *--dst = *--src;
-    }
+  if (dst < src)
+    copy_up (dst, src, size);
+  else if (dst > src)
+    copy_down (dst, src, size);
 
-  return dst;
+  return dst_;
 }
 
 /* Find the first differing byte in the two blocks of SIZE bytes
@@ -281,7 +337,24 @@ memset (void *dst_, int value, size_t size)
   unsigned char *dst = dst_;
 
   ASSERT (dst != NULL || size == 0);
-  
+
+  if (size >= WORD_THRESHOLD) 
+    {
+      size_t head = -(uintptr_t) dst & 3;
+      uint32_t word = (unsigned char) value * 0x01010101u;
+      size_t words;
+
+      size -= head;
+      while (head-- > 0)
+        *dst++ = value;
+
+      words = size / 4;
+      size %= 4;
+      asm volatile ("rep stosl"
+                    : "+D" (dst), "+c" (words)
+                    : "a" (word)
+                    : "memory");
+    }
   while (size-- > 0)
     *dst++ = value;
 
@@ -28,7 +28,27 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_CLOCK_GETTIME,          /* Reads a high-resolution clock. */
+    SYS_THREAD_SPAWN,           /* Starts another thread in this process. */
+    SYS_THREAD_JOIN,            /* Waits for a thread to finish. */
+    SYS_THREAD_EXIT,            /* Terminates the calling thread. */
+    SYS_RT_RESERVE,             /* Requests a real-time reservation. */
+    SYS_RT_WAIT,                /* Waits for the next real-time period. */
+    SYS_GETRUSAGE,              /* Reports resource usage. */
+    SYS_SYSSTAT,                /* Reports system-wide counters. */
+    SYS_PIPE,                   /* Creates a pipe. */
+    SYS_DUP2,                   /* Duplicates a pipe descriptor. */
+    SYS_SHM_ATTACH,             /* Maps a shared memory segment. */
+    SYS_SHM_DETACH,             /* Unmaps a shared memory segment. */
+    SYS_FUTEX_WAIT,             /* Waits on a futex. */
+    SYS_FUTEX_WAKE,             /* Wakes futex waiters. */
+    SYS_MSG_SEND,               /* Sends a message to a process. */
+    SYS_MSG_RECEIVE,            /* Receives a message. */
+    SYS_AIO_SUBMIT,             /* Starts asynchronous I/O. */
+    SYS_AIO_WAIT                /* Waits for asynchronous I/O. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,17 @@
+#ifndef __LIB_SYSSTAT_H
+#define __LIB_SYSSTAT_H
+
+#include <stdint.h>
+
+/* System-wide counters reported by sysstat(), for benchmarks.
+   All of them count from boot, so callers take the difference
+   between two snapshots. */
+struct sysstat
+  {
+    int64_t ticks;              /* Timer ticks. */
+    long long fs_reads;         /* Sectors read from the file system disk. */
+    long long fs_writes;        /* Sectors written to it. */
+    long long page_faults;      /* Page faults. */
+  };
+
+#endif /* lib/sysstat.h */
@@ -0,0 +1,16 @@
+#ifndef __LIB_TIME_H
+#define __LIB_TIME_H
+
+#include <stdint.h>
+
+/* Clocks for clock_gettime(). */
+#define CLOCK_MONOTONIC 0       /* Time since boot, never goes back. */
+
+/* A time value, in seconds and nanoseconds. */
+struct timespec
+  {
+    int64_t tv_sec;             /* Seconds. */
+    long tv_nsec;               /* Nanoseconds, 0...999,999,999. */
+  };
+
+#endif /* lib/time.h */
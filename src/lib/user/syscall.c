@@ -182,3 +182,120 @@ inumber (int fd)
 {
   return syscall1 (SYS_INUMBER, fd);
 }
+
+int
+clock_gettime (int clock_id, struct timespec *ts) 
+{
+  return syscall2 (SYS_CLOCK_GETTIME, clock_id, ts);
+}
+
+/* Entry point of threads created by thread_spawn().  Runs FUNC
+   and then terminates the thread with FUNC's return value. */
+static void
+thread_start (int (*func) (void *aux), void *aux) 
+{
+  thread_exit (func (aux));
+}
+
+tid_t
+thread_spawn (int (*func) (void *aux), void *aux) 
+{
+  return (tid_t) syscall3 (SYS_THREAD_SPAWN, thread_start, func, aux);
+}
+
+int
+thread_join (tid_t tid) 
+{
+  return syscall1 (SYS_THREAD_JOIN, tid);
+}
+
+void
+thread_exit (int status) 
+{
+  syscall1 (SYS_THREAD_EXIT, status);
+  NOT_REACHED ();
+}
+
+bool
+rt_reserve (unsigned runtime_ms, unsigned period_ms) 
+{
+  return syscall2 (SYS_RT_RESERVE, runtime_ms, period_ms);
+}
+
+void
+rt_wait (void) 
+{
+  syscall0 (SYS_RT_WAIT);
+}
+
+int
+getrusage (int who, struct rusage *usage) 
+{
+  return syscall2 (SYS_GETRUSAGE, who, usage);
+}
+
+int
+sysstat (struct sysstat *st) 
+{
+  return syscall1 (SYS_SYSSTAT, st);
+}
+
+int
+pipe (int fds[2]) 
+{
+  return syscall1 (SYS_PIPE, fds);
+}
+
+int
+dup2 (int old_fd, int new_fd) 
+{
+  return syscall2 (SYS_DUP2, old_fd, new_fd);
+}
+
+bool
+shm_attach (const char *name, void *addr, unsigned size) 
+{
+  return syscall3 (SYS_SHM_ATTACH, name, addr, size);
+}
+
+bool
+shm_detach (void *addr) 
+{
+  return syscall1 (SYS_SHM_DETACH, addr);
+}
+
+int
+futex_wait (int *addr, int val) 
+{
+  return syscall2 (SYS_FUTEX_WAIT, addr, val);
+}
+
+int
+futex_wake (int *addr, int cnt) 
+{
+  return syscall2 (SYS_FUTEX_WAKE, addr, cnt);
+}
+
+int
+msg_send (pid_t pid, const void *buffer, unsigned size) 
+{
+  return syscall3 (SYS_MSG_SEND, pid, buffer, size);
+}
+
+int
+msg_receive (void *buffer, unsigned size) 
+{
+  return syscall2 (SYS_MSG_RECEIVE, buffer, size);
+}
+
+int
+aio_submit (struct aiocb *cb) 
+{
+  return syscall1 (SYS_AIO_SUBMIT, cb);
+}
+
+struct aiocb *
+aio_wait (void) 
+{
+  return (struct aiocb *) syscall0 (SYS_AIO_WAIT);
+}
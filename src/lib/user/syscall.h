@@ -2,12 +2,20 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <aio.h>
 #include <debug.h>
+#include <resource.h>
+#include <sysstat.h>
+#include <time.h>
 
 /* Process identifier. */
 typedef int pid_t;
 #define PID_ERROR ((pid_t) -1)
 
+/* Thread identifier, for threads within a process. */
+typedef int tid_t;
+#define TID_ERROR ((tid_t) -1)
+
 /* Map region identifier. */
 typedef int mapid_t;
 #define MAP_FAILED ((mapid_t) -1)
@@ -45,4 +53,24 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int clock_gettime (int clock_id, struct timespec *);
+tid_t thread_spawn (int (*func) (void *aux), void *aux);
+int thread_join (tid_t);
+void thread_exit (int status) NO_RETURN;
+bool rt_reserve (unsigned runtime_ms, unsigned period_ms);
+void rt_wait (void);
+int getrusage (int who, struct rusage *);
+int sysstat (struct sysstat *);
+int pipe (int fds[2]);
+int dup2 (int old_fd, int new_fd);
+bool shm_attach (const char *name, void *addr, unsigned size);
+bool shm_detach (void *addr);
+int futex_wait (int *addr, int val);
+int futex_wake (int *addr, int cnt);
+int msg_send (pid_t, const void *buffer, unsigned size);
+int msg_receive (void *buffer, unsigned size);
+int aio_submit (struct aiocb *);
+struct aiocb *aio_wait (void);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,239 @@
+/* Test program for lib/kernel/hash.c.
+
+   Inserts, deletes, and looks up elements in a struct hash and
+   keys in a struct hash_map at random, checking every lookup
+   against a plain array, across the rehashes that growing and
+   shrinking them triggers.
+
+   This is not a test we will run on your submitted projects.
+   It is here for completeness.
+*/
+
+#undef NDEBUG
+#include <debug.h>
+#include <hash.h>
+#include <random.h>
+#include <stdio.h>
+#include "threads/test.h"
+#include "threads/vaddr.h"
+
+/* Number of distinct values or keys. */
+#define MAX_SIZE 1024
+
+/* Random insertions and deletions per round. */
+#define OP_CNT 20000
+
+/* Old buckets moved per insertion or deletion during a rehash,
+   as in lib/kernel/hash.c. */
+#define REHASH_STEP 2
+
+/* A hash table element. */
+struct value
+  {
+    struct hash_elem elem;      /* Hash element. */
+    int value;                  /* Item value. */
+  };
+
+static void test_hash (void);
+static void test_hash_map (void);
+static unsigned value_hash (const struct hash_elem *, void *);
+static bool value_less (const struct hash_elem *, const struct hash_elem *,
+                        void *);
+static void verify_hash (struct hash *, struct value[], const bool[]);
+static void verify_hash_map (struct hash_map *, const bool[]);
+
+/* Test the hash table implementations. */
+void
+test (void)
+{
+  test_hash ();
+  test_hash_map ();
+  printf ("hash: PASS\n");
+}
+
+/* Tests struct hash, whose rehashes are spread over the
+   insertions and deletions that follow them. */
+static void
+test_hash (void)
+{
+  static struct value values[MAX_SIZE];
+  static bool present[MAX_SIZE];
+  struct hash h;
+  size_t mid_rehash_cnt = 0;
+  size_t size = 0;
+  int i;
+
+  printf ("testing struct hash:");
+  ASSERT (hash_init (&h, value_hash, value_less, NULL));
+  for (i = 0; i < MAX_SIZE; i++)
+    {
+      values[i].value = i;
+      present[i] = false;
+    }
+
+  for (i = 0; i < OP_CNT; i++)
+    {
+      int v = random_ulong () % MAX_SIZE;
+
+      /* Grow for the first half and shrink for the second, so
+         that the table rehashes in both directions. */
+      if (random_ulong () % 4 < (i < OP_CNT / 2 ? 3u : 1u))
+        {
+          struct hash_elem *old = hash_insert (&h, &values[v].elem);
+          ASSERT (present[v] ? old == &values[v].elem : old == NULL);
+          if (!present[v])
+            size++;
+          present[v] = true;
+        }
+      else
+        {
+          struct hash_elem *old = hash_delete (&h, &values[v].elem);
+          ASSERT (present[v] ? old == &values[v].elem : old == NULL);
+          if (present[v])
+            size--;
+          present[v] = false;
+        }
+      ASSERT (hash_size (&h) == size);
+
+      /* Check everything while old buckets are still being
+         moved across, as well as now and then.  Count the checks
+         made after a rehash has moved more than one step's worth
+         of buckets but not all of them. */
+      if (h.old_buckets != NULL || i % 256 == 0)
+        {
+          if (h.old_buckets != NULL && h.migrate_idx > REHASH_STEP)
+            mid_rehash_cnt++;
+          verify_hash (&h, values, present);
+        }
+      if (i % (OP_CNT / 10) == 0)
+        printf (" %zu", size);
+    }
+  ASSERT (mid_rehash_cnt > 0);
+  verify_hash (&h, values, present);
+
+  hash_destroy (&h, NULL);
+  printf (" done\n");
+}
+
+/* Tests struct hash_map, keyed by page addresses as in a
+   supplementary page table. */
+static void
+test_hash_map (void)
+{
+  static bool present[MAX_SIZE];
+  struct hash_map m;
+  size_t grow_cnt = 0;
+  size_t size = 0;
+  int i;
+
+  printf ("testing struct hash_map:");
+  ASSERT (hash_map_init (&m));
+  for (i = 0; i < MAX_SIZE; i++)
+    present[i] = false;
+
+  for (i = 0; i < OP_CNT; i++)
+    {
+      int v = random_ulong () % MAX_SIZE;
+      uintptr_t key = (uintptr_t) (v + 1) * PGSIZE;
+      size_t slot_cnt = m.slot_cnt;
+
+      if (random_ulong () % 4 < (i < OP_CNT / 2 ? 3u : 1u))
+        {
+          ASSERT (hash_map_insert (&m, key, &present[v]));
+          if (!present[v])
+            size++;
+          present[v] = true;
+        }
+      else
+        {
+          void *old = hash_map_delete (&m, key);
+          ASSERT (old == (present[v] ? &present[v] : NULL));
+          if (present[v])
+            size--;
+          present[v] = false;
+        }
+      ASSERT (hash_map_size (&m) == size);
+
+      /* Check everything right after each rehash, as well as now
+         and then. */
+      if (m.slot_cnt != slot_cnt || i % 256 == 0)
+        {
+          if (m.slot_cnt != slot_cnt)
+            grow_cnt++;
+          verify_hash_map (&m, present);
+        }
+      if (i % (OP_CNT / 10) == 0)
+        printf (" %zu", size);
+    }
+  ASSERT (grow_cnt > 0);
+  verify_hash_map (&m, present);
+
+  hash_map_destroy (&m);
+  printf (" done\n");
+}
+
+/* Returns the hash of value E. */
+static unsigned
+value_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  return hash_int (hash_entry (e, struct value, elem)->value);
+}
+
+/* Returns true if value A is less than value B, false
+   otherwise. */
+static bool
+value_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED)
+{
+  const struct value *a = hash_entry (a_, struct value, elem);
+  const struct value *b = hash_entry (b_, struct value, elem);
+
+  return a->value < b->value;
+}
+
+/* Verifies that H contains exactly the VALUES for which PRESENT
+   is true by lookup, and also by iteration unless H is being
+   rehashed.  Iterating finishes any rehash in progress, so doing
+   it mid-rehash would leave the lookups in later rounds nothing
+   half-moved to check. */
+static void
+verify_hash (struct hash *h, struct value values[], const bool present[])
+{
+  struct hash_iterator i;
+  size_t cnt = 0;
+  int v;
+
+  for (v = 0; v < MAX_SIZE; v++)
+    {
+      struct value probe;
+      struct hash_elem *e;
+
+      probe.value = v;
+      e = hash_find (h, &probe.elem);
+      ASSERT (present[v] ? e == &values[v].elem : e == NULL);
+    }
+  if (h->old_buckets != NULL)
+    return;
+
+  hash_first (&i, h);
+  while (hash_next (&i))
+    {
+      ASSERT (present[hash_entry (hash_cur (&i), struct value, elem)->value]);
+      cnt++;
+    }
+  ASSERT (cnt == hash_size (h));
+}
+
+/* Verifies that M maps the key for each V for which PRESENT[V]
+   is true to &PRESENT[V], and has no other keys. */
+static void
+verify_hash_map (struct hash_map *m, const bool present[])
+{
+  int v;
+
+  for (v = 0; v < MAX_SIZE; v++)
+    {
+      uintptr_t key = (uintptr_t) (v + 1) * PGSIZE;
+      ASSERT (hash_map_find (m, key) == (present[v] ? &present[v] : NULL));
+    }
+}
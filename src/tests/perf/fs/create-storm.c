@@ -0,0 +1,52 @@
+/* Measures creating, opening, and removing many small files in
+   one directory. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define FILE_CNT 64
+
+void
+test_main (void) 
+{
+  char name[16];
+  struct perf p;
+  int i;
+
+  CHECK (mkdir ("storm"), "mkdir \"storm\"");
+
+  perf_start (&p, "create");
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      snprintf (name, sizeof name, "storm/f%d", i);
+      if (!create (name, 512))
+        fail ("create \"%s\" failed", name);
+    }
+  perf_end (&p, FILE_CNT, 0);
+
+  perf_start (&p, "open-close");
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      int fd;
+
+      snprintf (name, sizeof name, "storm/f%d", i);
+      if ((fd = open (name)) < 2)
+        fail ("open \"%s\" failed", name);
+      close (fd);
+    }
+  perf_end (&p, FILE_CNT, 0);
+
+  perf_start (&p, "remove");
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      snprintf (name, sizeof name, "storm/f%d", i);
+      if (!remove (name))
+        fail ("remove \"%s\" failed", name);
+    }
+  perf_end (&p, FILE_CNT, 0);
+
+  CHECK (remove ("storm"), "remove \"storm\"");
+}
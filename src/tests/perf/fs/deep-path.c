@@ -0,0 +1,70 @@
+/* Measures path lookup through a deep chain of directories, by
+   absolute path from the root and by relative path from halfway
+   down. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define DEPTH 16
+#define LOOKUP_CNT 200
+
+/* Opens and closes PATH LOOKUP_CNT times, as case NAME. */
+static void
+lookup (const char *path, const char *name) 
+{
+  struct perf p;
+  int i;
+
+  perf_start (&p, name);
+  for (i = 0; i < LOOKUP_CNT; i++) 
+    {
+      int fd = open (path);
+      if (fd < 2)
+        fail ("open \"%s\" failed", path);
+      close (fd);
+    }
+  perf_end (&p, LOOKUP_CNT, 0);
+}
+
+void
+test_main (void) 
+{
+  char path[DEPTH * 2 + 16];
+  size_t half;
+  int i;
+
+  /* Build /d/d/.../d, DEPTH levels deep, with a file at the
+     bottom. */
+  path[0] = '\0';
+  half = 0;
+  for (i = 0; i < DEPTH; i++) 
+    {
+      strlcat (path, "/d", sizeof path);
+      if (!mkdir (path))
+        fail ("mkdir \"%s\" failed", path);
+      if (i == DEPTH / 2 - 1)
+        half = strlen (path);
+    }
+  strlcat (path, "/file", sizeof path);
+  CHECK (create (path, 0), "create file %d levels deep", DEPTH);
+
+  lookup (path, "absolute");
+
+  path[half] = '\0';
+  CHECK (chdir (path), "chdir %d levels down", DEPTH / 2);
+  path[half] = '/';
+  lookup (path + half + 1, "relative");
+  CHECK (chdir ("/"), "chdir \"/\"");
+
+  /* Remove everything, deepest first. */
+  CHECK (remove (path), "remove file");
+  for (i = DEPTH; i > 0; i--) 
+    {
+      path[i * 2] = '\0';
+      if (!remove (path))
+        fail ("remove \"%s\" failed", path);
+    }
+}
@@ -0,0 +1,64 @@
+/* Measures listing and searching a directory with many
+   entries. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define FILE_CNT 200
+#define LIST_CNT 10
+
+void
+test_main (void) 
+{
+  char name[READDIR_MAX_LEN + 1];
+  char path[32];
+  struct perf p;
+  long entry_cnt;
+  int i, fd;
+
+  CHECK (mkdir ("big"), "mkdir \"big\"");
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      snprintf (path, sizeof path, "big/file%03d", i);
+      if (!create (path, 0))
+        fail ("create \"%s\" failed", path);
+    }
+  msg ("created %d files", FILE_CNT);
+
+  entry_cnt = 0;
+  perf_start (&p, "list");
+  for (i = 0; i < LIST_CNT; i++) 
+    {
+      if ((fd = open ("big")) < 2)
+        fail ("open \"big\" failed");
+      while (readdir (fd, name))
+        entry_cnt++;
+      close (fd);
+    }
+  perf_end (&p, entry_cnt, 0);
+  if (entry_cnt != (long) FILE_CNT * LIST_CNT)
+    fail ("listed %ld entries, expected %d", entry_cnt, FILE_CNT * LIST_CNT);
+
+  /* Look up entries from the end of the directory, which a
+     linear search reaches last. */
+  perf_start (&p, "lookup");
+  for (i = FILE_CNT; i-- > 0; ) 
+    {
+      snprintf (path, sizeof path, "big/file%03d", i);
+      if ((fd = open (path)) < 2)
+        fail ("open \"%s\" failed", path);
+      close (fd);
+    }
+  perf_end (&p, FILE_CNT, 0);
+
+  for (i = 0; i < FILE_CNT; i++) 
+    {
+      snprintf (path, sizeof path, "big/file%03d", i);
+      if (!remove (path))
+        fail ("remove \"%s\" failed", path);
+    }
+  CHECK (remove ("big"), "remove \"big\"");
+}
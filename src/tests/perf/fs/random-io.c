@@ -0,0 +1,66 @@
+/* Measures random reads and writes of 512-byte and 4 kB blocks
+   within a file larger than the buffer cache. */
+
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define FILE_SIZE (128 * 1024)
+#define OP_CNT 256
+
+static char buf[4096];
+
+/* Does OP_CNT reads, or writes if WRITING, of BS bytes at random
+   BS-aligned offsets in FD, and reports them as case NAME. */
+static void
+random_io (int fd, size_t bs, bool writing, const char *name) 
+{
+  struct perf p;
+  int i;
+
+  perf_start (&p, name);
+  for (i = 0; i < OP_CNT; i++) 
+    {
+      size_t ofs = random_ulong () % (FILE_SIZE / bs) * bs;
+      int n;
+
+      seek (fd, ofs);
+      n = writing ? write (fd, buf, bs) : read (fd, buf, bs);
+      if (n != (int) bs)
+        fail ("%s of %zu bytes at offset %zu failed",
+              writing ? "write" : "read", bs, ofs);
+    }
+  perf_end (&p, OP_CNT, (long long) OP_CNT * bs);
+}
+
+void
+test_main (void) 
+{
+  static const size_t block_sizes[] = {512, 4096};
+  size_t ofs, i;
+  int fd;
+
+  random_init (86);
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("random", FILE_SIZE), "create \"random\"");
+  CHECK ((fd = open ("random")) > 1, "open \"random\"");
+  for (ofs = 0; ofs < FILE_SIZE; ofs += sizeof buf)
+    if (write (fd, buf, sizeof buf) != (int) sizeof buf)
+      fail ("write at offset %zu failed", ofs);
+
+  for (i = 0; i < sizeof block_sizes / sizeof *block_sizes; i++) 
+    {
+      char name[32];
+
+      snprintf (name, sizeof name, "read-%zu", block_sizes[i]);
+      random_io (fd, block_sizes[i], false, name);
+      snprintf (name, sizeof name, "write-%zu", block_sizes[i]);
+      random_io (fd, block_sizes[i], true, name);
+    }
+  close (fd);
+  CHECK (remove ("random"), "remove \"random\"");
+}
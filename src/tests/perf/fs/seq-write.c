@@ -0,0 +1,41 @@
+/* Measures sequential write throughput to a newly created,
+   growing file at several block sizes. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define FILE_SIZE (128 * 1024)
+
+static char buf[16384];
+
+void
+test_main (void) 
+{
+  static const size_t block_sizes[] = {512, 4096, 16384};
+  size_t i;
+
+  memset (buf, 'w', sizeof buf);
+  for (i = 0; i < sizeof block_sizes / sizeof *block_sizes; i++) 
+    {
+      size_t bs = block_sizes[i];
+      char name[32];
+      struct perf p;
+      size_t ofs;
+      int fd;
+
+      CHECK (create ("seq", 0), "create \"seq\"");
+      CHECK ((fd = open ("seq")) > 1, "open \"seq\"");
+      snprintf (name, sizeof name, "write-%zu", bs);
+      perf_start (&p, name);
+      for (ofs = 0; ofs < FILE_SIZE; ofs += bs)
+        if (write (fd, buf, bs) != (int) bs)
+          fail ("write %zu bytes at offset %zu failed", bs, ofs);
+      perf_end (&p, FILE_SIZE / bs, FILE_SIZE);
+      close (fd);
+      CHECK (remove ("seq"), "remove \"seq\"");
+    }
+}
@@ -0,0 +1,63 @@
+/* Timing and reporting for the benchmarks under tests/perf.
+
+   Each measured case prints one line of the form
+
+        PERF TEST:CASE ops=N bytes=N us=N ticks=N fs-reads=N
+             fs-writes=N faults=N [kB/s=N] [ns/op=N]
+
+   (on a single line) that "make perf" collects.  Counters are
+   the change over the case, system-wide, so run benchmarks on an
+   otherwise idle system.  Disk writes made by the buffer cache
+   may be deferred past the end of the case that caused them. */
+
+#include "tests/perf/perf.h"
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+/* Returns the nanoseconds from A to B. */
+static long long
+elapsed_ns (const struct timespec *a, const struct timespec *b) 
+{
+  return ((b->tv_sec - a->tv_sec) * 1000000000LL
+          + (b->tv_nsec - a->tv_nsec));
+}
+
+/* Starts measuring case NAME. */
+void
+perf_start (struct perf *p, const char *name) 
+{
+  p->name = name;
+  if (sysstat (&p->stat) < 0)
+    fail ("sysstat failed");
+  clock_gettime (CLOCK_MONOTONIC, &p->start);
+}
+
+/* Finishes measuring P, which did OPS operations that
+   transferred BYTES bytes in total, and reports the result. */
+void
+perf_end (struct perf *p, long ops, long long bytes) 
+{
+  struct timespec end;
+  struct sysstat stat;
+  long long ns, us;
+
+  clock_gettime (CLOCK_MONOTONIC, &end);
+  if (sysstat (&stat) < 0)
+    fail ("sysstat failed");
+  ns = elapsed_ns (&p->start, &end);
+  us = ns / 1000;
+
+  printf ("PERF %s:%s ops=%ld bytes=%lld us=%lld ticks=%lld "
+          "fs-reads=%lld fs-writes=%lld faults=%lld",
+          test_name, p->name, ops, bytes, us,
+          (long long) (stat.ticks - p->stat.ticks),
+          stat.fs_reads - p->stat.fs_reads,
+          stat.fs_writes - p->stat.fs_writes,
+          stat.page_faults - p->stat.page_faults);
+  if (bytes > 0 && us > 0)
+    printf (" kB/s=%lld", bytes * 1000000 / 1024 / us);
+  if (ops > 0)
+    printf (" ns/op=%lld", ns / ops);
+  printf ("\n");
+}
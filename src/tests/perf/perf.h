@@ -0,0 +1,18 @@
+#ifndef TESTS_PERF_PERF_H
+#define TESTS_PERF_PERF_H
+
+#include <sysstat.h>
+#include <time.h>
+
+/* A benchmark measurement in progress. */
+struct perf
+  {
+    const char *name;           /* Case name, e.g. "write-4096". */
+    struct timespec start;      /* Wall-clock time at start. */
+    struct sysstat stat;        /* System counters at start. */
+  };
+
+void perf_start (struct perf *, const char *name);
+void perf_end (struct perf *, long ops, long long bytes);
+
+#endif /* tests/perf/perf.h */
@@ -0,0 +1,7 @@
+/* Child process for exec-wait.  Exits immediately. */
+
+int
+main (void) 
+{
+  return 0;
+}
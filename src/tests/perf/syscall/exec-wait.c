@@ -0,0 +1,27 @@
+/* Measures the round trip of starting a child process with
+   exec() and reaping it with wait(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define ITERATIONS 100
+
+void
+test_main (void) 
+{
+  struct perf p;
+  int i;
+
+  perf_start (&p, "exec-wait");
+  for (i = 0; i < ITERATIONS; i++) 
+    {
+      pid_t pid = exec ("exec-child");
+      if (pid == PID_ERROR)
+        fail ("exec \"exec-child\" failed");
+      if (wait (pid) != 0)
+        fail ("wait for \"exec-child\" returned nonzero");
+    }
+  perf_end (&p, ITERATIONS, 0);
+}
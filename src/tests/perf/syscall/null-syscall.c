@@ -0,0 +1,28 @@
+/* Measures the cost of entering and leaving the kernel, using
+   tell(), which does almost no work, as the "null" system
+   call. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define ITERATIONS 100000
+
+void
+test_main (void) 
+{
+  struct perf p;
+  int fd, i;
+
+  CHECK (create ("null", 0), "create \"null\"");
+  CHECK ((fd = open ("null")) > 1, "open \"null\"");
+
+  perf_start (&p, "tell");
+  for (i = 0; i < ITERATIONS; i++)
+    tell (fd);
+  perf_end (&p, ITERATIONS, 0);
+
+  close (fd);
+  CHECK (remove ("null"), "remove \"null\"");
+}
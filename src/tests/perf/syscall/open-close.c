@@ -0,0 +1,34 @@
+/* Measures the latency of opening and closing a file in the
+   root directory. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define ITERATIONS 5000
+
+static void
+open_close (const char *case_name, const char *file) 
+{
+  struct perf p;
+  int i;
+
+  perf_start (&p, case_name);
+  for (i = 0; i < ITERATIONS; i++) 
+    {
+      int fd = open (file);
+      if (fd < 2)
+        fail ("open \"%s\" failed", file);
+      close (fd);
+    }
+  perf_end (&p, ITERATIONS, 0);
+}
+
+void
+test_main (void) 
+{
+  CHECK (create ("oc", 0), "create \"oc\"");
+  open_close ("open-close", "oc");
+  CHECK (remove ("oc"), "remove \"oc\"");
+}
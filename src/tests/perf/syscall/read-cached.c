@@ -0,0 +1,53 @@
+/* Measures the per-call cost of reading 1 byte and 4 kB from a
+   file that is already in the buffer cache, so that the
+   difference is copying rather than disk time. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/perf/perf.h"
+
+#define FILE_SIZE 4096
+#define ITERATIONS 20000
+
+static char buf[FILE_SIZE];
+
+static void
+read_cached (int fd, const char *case_name, size_t size) 
+{
+  struct perf p;
+  int i;
+
+  perf_start (&p, case_name);
+  for (i = 0; i < ITERATIONS; i++) 
+    {
+      seek (fd, 0);
+      if (read (fd, buf, size) != (int) size)
+        fail ("read %zu bytes failed", size);
+    }
+  perf_end (&p, ITERATIONS, (long long) ITERATIONS * size);
+}
+
+void
+test_main (void) 
+{
+  int fd;
+
+  memset (buf, 'c', sizeof buf);
+  CHECK (create ("cached", FILE_SIZE), "create \"cached\"");
+  CHECK ((fd = open ("cached")) > 1, "open \"cached\"");
+  if (write (fd, buf, sizeof buf) != (int) sizeof buf)
+    fail ("write \"cached\" failed");
+
+  /* Warm the cache. */
+  seek (fd, 0);
+  if (read (fd, buf, sizeof buf) != (int) sizeof buf)
+    fail ("read \"cached\" failed");
+
+  read_cached (fd, "read-1", 1);
+  read_cached (fd, "read-4096", 4096);
+
+  close (fd);
+  CHECK (remove ("cached"), "remove \"cached\"");
+}
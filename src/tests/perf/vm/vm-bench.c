@@ -0,0 +1,135 @@
+/* Virtual memory benchmark.  Usage: NAME PATTERN PAGES
+
+   Touches a working set of PAGES pages with access PATTERN, one
+   of:
+
+     seq     Writes every page in order, then reads them back.
+     random  Writes 4 * PAGES pages chosen at random.
+     loop    Writes every page in order, 8 times over, which is
+             the worst case for LRU-like replacement once the
+             working set exceeds memory.
+     multi   Runs 4 processes at once, each doing "random" over
+             a quarter of the pages.
+
+   Tests/perf/vm/Make.tests builds this program under a name for
+   every combination of pattern, working set, and user pool size
+   (set with -ul), and the result is reported under that name.
+
+   BUF is in the BSS, which is loaded in full along with the
+   program until the kernel pages on demand, so MAX_PAGES is kept
+   small enough that a parent and CHILD_CNT children all fit in a
+   128-page user pool. */
+
+#include <random.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/perf/perf.h"
+
+#define PAGE_SIZE 4096
+#define MAX_PAGES 16
+#define CHILD_CNT 4
+
+static char buf[MAX_PAGES * PAGE_SIZE];
+
+/* Writes a stamp into page I. */
+static void
+touch (size_t i) 
+{
+  buf[i * PAGE_SIZE] = (char) i;
+  buf[i * PAGE_SIZE + PAGE_SIZE - 1] = (char) i;
+}
+
+/* Checks the stamp that touch() wrote into page I. */
+static void
+check (size_t i) 
+{
+  if (buf[i * PAGE_SIZE] != (char) i
+      || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) i)
+    fail ("page %zu lost its contents", i);
+}
+
+/* Touches 4 * PAGE_CNT random pages among the first PAGE_CNT,
+   and returns the number touched. */
+static long
+touch_random (size_t page_cnt) 
+{
+  long i;
+
+  for (i = 0; i < 4 * (long) page_cnt; i++)
+    touch (random_ulong () % page_cnt);
+  return i;
+}
+
+int
+main (int argc, char *argv[]) 
+{
+  const char *pattern;
+  size_t page_cnt, i;
+  struct perf p;
+  long ops = 0;
+  int pass;
+
+  test_name = argv[0];
+  if (argc < 3)
+    fail ("usage: %s PATTERN PAGES", argv[0]);
+  pattern = argv[1];
+  page_cnt = atoi (argv[2]);
+  if (page_cnt < 1 || page_cnt > MAX_PAGES)
+    fail ("PAGES must be between 1 and %d", MAX_PAGES);
+
+  /* A child of "multi", run as "NAME child PAGES INDEX": do the
+     work, and let the parent report. */
+  if (!strcmp (pattern, "child")) 
+    {
+      random_init (87 + (argc > 3 ? atoi (argv[3]) : 0));
+      touch_random (page_cnt);
+      return 0;
+    }
+
+  random_init (87);
+  perf_start (&p, pattern);
+  if (!strcmp (pattern, "seq")) 
+    {
+      for (i = 0; i < page_cnt; i++)
+        touch (i);
+      for (i = 0; i < page_cnt; i++)
+        check (i);
+      ops = 2 * page_cnt;
+    }
+  else if (!strcmp (pattern, "random"))
+    ops = touch_random (page_cnt);
+  else if (!strcmp (pattern, "loop")) 
+    {
+      for (pass = 0; pass < 8; pass++)
+        for (i = 0; i < page_cnt; i++)
+          touch (i);
+      for (i = 0; i < page_cnt; i++)
+        check (i);
+      ops = 9 * page_cnt;
+    }
+  else if (!strcmp (pattern, "multi")) 
+    {
+      char cmd[64];
+      pid_t pids[CHILD_CNT];
+      int c;
+
+      for (c = 0; c < CHILD_CNT; c++) 
+        {
+          snprintf (cmd, sizeof cmd, "%s child %zu %d", argv[0],
+                    (page_cnt + CHILD_CNT - 1) / CHILD_CNT, c + 1);
+          if ((pids[c] = exec (cmd)) == PID_ERROR)
+            fail ("exec \"%s\" failed", cmd);
+        }
+      for (c = 0; c < CHILD_CNT; c++)
+        if (wait (pids[c]) != 0)
+          fail ("child %d failed", c);
+      ops = 4 * (long) ((page_cnt + CHILD_CNT - 1) / CHILD_CNT) * CHILD_CNT;
+    }
+  else
+    fail ("unknown pattern \"%s\"", pattern);
+  perf_end (&p, ops, (long long) ops * PAGE_SIZE);
+  return 0;
+}
@@ -0,0 +1,86 @@
+/* Keeps several asynchronous writes, then reads, outstanding at
+   once, and checks that aio_wait() returns each request exactly
+   once with its result and that the data arrived.  Requests
+   that are not on a regular file must be refused. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define REQ_CNT 3
+#define REQ_SIZE 4096
+
+static char out[REQ_CNT][REQ_SIZE];
+static char in[REQ_CNT][REQ_SIZE];
+
+/* Submits REQ_CNT requests of type OP, request I on BUFS[I] and
+   REQ_SIZE * I bytes into FD, then waits for all of them. */
+static void
+run (int fd, int op, char bufs[REQ_CNT][REQ_SIZE], const char *what)
+{
+  struct aiocb cbs[REQ_CNT];
+  bool seen[REQ_CNT];
+  int i;
+
+  for (i = 0; i < REQ_CNT; i++)
+    {
+      cbs[i].fd = fd;
+      cbs[i].op = op;
+      cbs[i].buffer = bufs[i];
+      cbs[i].size = REQ_SIZE;
+      cbs[i].offset = REQ_SIZE * i;
+      cbs[i].result = -1;
+      seen[i] = false;
+      if (aio_submit (&cbs[i]) != 0)
+        fail ("aio_submit of %s %d failed", what, i);
+    }
+  msg ("submit %d %ss", REQ_CNT, what);
+
+  for (i = 0; i < REQ_CNT; i++)
+    {
+      struct aiocb *cb = aio_wait ();
+      int idx;
+
+      if (cb == NULL)
+        fail ("aio_wait returned null after %d %ss", i, what);
+      idx = cb - cbs;
+      if (idx < 0 || idx >= REQ_CNT || seen[idx])
+        fail ("aio_wait returned bad request %p", cb);
+      seen[idx] = true;
+      if (cb->result != REQ_SIZE)
+        fail ("%s %d transferred %d bytes", what, idx, cb->result);
+    }
+  msg ("wait for %d %ss", REQ_CNT, what);
+  CHECK (aio_wait () == NULL, "no %ss left", what);
+}
+
+void
+test_main (void) 
+{
+  struct aiocb bad;
+  int fd, i;
+
+  CHECK (create ("aio-data", REQ_CNT * REQ_SIZE), "create \"aio-data\"");
+  CHECK ((fd = open ("aio-data")) > 1, "open \"aio-data\"");
+
+  for (i = 0; i < REQ_CNT; i++)
+    memset (out[i], 'a' + i, REQ_SIZE);
+  run (fd, AIO_WRITE, out, "write");
+  run (fd, AIO_READ, in, "read");
+  for (i = 0; i < REQ_CNT; i++)
+    if (memcmp (in[i], out[i], REQ_SIZE))
+      fail ("block %d read back wrong", i);
+  msg ("data read back matches");
+
+  bad.fd = fd;
+  bad.op = 42;
+  bad.buffer = in[0];
+  bad.size = 1;
+  bad.offset = 0;
+  CHECK (aio_submit (&bad) == -1, "bad operation refused");
+  bad.fd = STDOUT_FILENO;
+  bad.op = AIO_WRITE;
+  CHECK (aio_submit (&bad) == -1, "console refused");
+}
@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(aio) begin
+(aio) create "aio-data"
+(aio) open "aio-data"
+(aio) submit 3 writes
+(aio) wait for 3 writes
+(aio) no writes left
+(aio) submit 3 reads
+(aio) wait for 3 reads
+(aio) no reads left
+(aio) data read back matches
+(aio) bad operation refused
+(aio) console refused
+(aio) end
+aio: exit(0)
+EOF
+pass;
@@ -0,0 +1,25 @@
+/* Child process run by fpu-switch test.
+
+   Computes a floating-point sum scaled by the first
+   command-line argument and exits with code 0 if the result is
+   exact. */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include "tests/lib.h"
+#include "tests/userprog/fpu-sum.h"
+
+const char *test_name = "child-fpu";
+
+int
+main (int argc UNUSED, char *argv[]) 
+{
+  int scale;
+
+  if (!isdigit (*argv[1]))
+    fail ("bad command-line arguments");
+  scale = atoi (argv[1]);
+  if (fpu_sum (scale) != fpu_sum_expected (scale))
+    fail ("wrong floating-point sum for scale %d", scale);
+  return 0;
+}
@@ -0,0 +1,31 @@
+/* Child process run by the msg-pass test.
+   Receives two messages and checks their contents, taking only
+   part of the second.  Prints nothing, so that its output
+   cannot interleave with the parent's. */
+
+#include <syscall.h>
+#include "tests/userprog/child-msg.h"
+
+const char *test_name = "child-msg";
+
+static char buf[4 * 4096] __attribute__ ((aligned (4096)));
+
+int
+main (void) 
+{
+  char *data = buf + CHILD_MSG_OFS;
+  int i;
+
+  if (msg_receive (data, CHILD_MSG_SIZE) != CHILD_MSG_SIZE)
+    return 1;
+  for (i = 0; i < CHILD_MSG_SIZE; i++)
+    if (data[i] != CHILD_MSG_BYTE (i))
+      return 2;
+
+  if (msg_receive (buf, CHILD_MSG_SHORT_TAKEN) != CHILD_MSG_SHORT_TAKEN)
+    return 3;
+  for (i = 0; i < CHILD_MSG_SHORT_TAKEN; i++)
+    if (buf[i] != CHILD_MSG_BYTE (i))
+      return 4;
+  return 0;
+}
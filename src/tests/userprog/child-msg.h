@@ -0,0 +1,15 @@
+/* Messages that the msg-pass test sends to child-msg. */
+
+/* Offset of the first message within a page, and its size,
+   which covers two whole pages with a partial page on each
+   side. */
+#define CHILD_MSG_OFS 100
+#define CHILD_MSG_SIZE (3 * 4096 + 200)
+
+/* Size of the second message, and how much of it the child
+   takes. */
+#define CHILD_MSG_SHORT_SIZE 100
+#define CHILD_MSG_SHORT_TAKEN 10
+
+/* Byte I of each message. */
+#define CHILD_MSG_BYTE(I) ((char) ((I) % 253))
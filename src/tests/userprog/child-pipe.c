@@ -0,0 +1,30 @@
+/* Child process run by the pipe test.
+   Writes CHILD_PIPE_SIZE bytes to its standard output, which the
+   parent has redirected into a pipe, in uneven pieces.  Prints
+   nothing else, so that the parent can read back exactly what
+   was written. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/userprog/child-pipe.h"
+
+const char *test_name = "child-pipe";
+
+int
+main (void) 
+{
+  static char buf[CHILD_PIPE_SIZE];
+  size_t ofs, chunk;
+  int i;
+
+  for (i = 0; i < CHILD_PIPE_SIZE; i++)
+    buf[i] = CHILD_PIPE_BYTE (i);
+
+  for (ofs = 0; ofs < CHILD_PIPE_SIZE; ofs += chunk)
+    {
+      chunk = CHILD_PIPE_SIZE - ofs < 1531 ? CHILD_PIPE_SIZE - ofs : 1531;
+      if (write (STDOUT_FILENO, buf + ofs, chunk) != (int) chunk)
+        return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,6 @@
+/* Number of bytes that child-pipe writes to its standard
+   output, which is more than a pipe holds at once. */
+#define CHILD_PIPE_SIZE 10000
+
+/* Byte I of child-pipe's output. */
+#define CHILD_PIPE_BYTE(I) ((char) ((I) % 251))
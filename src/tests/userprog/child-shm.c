@@ -0,0 +1,28 @@
+/* Child process run by the shm-futex test.
+   Attaches the parent's segment at a different address than the
+   parent, replies to the parent's value, then sets a flag and
+   wakes the parent, which is probably waiting on it. */
+
+#include <syscall.h>
+#include "tests/userprog/child-shm.h"
+
+const char *test_name = "child-shm";
+
+int
+main (void) 
+{
+  int *seg = (int *) 0x20000000;
+  int status = 0;
+
+  if (!shm_attach (CHILD_SHM_NAME, seg, CHILD_SHM_SIZE))
+    return 1;
+  if (seg[CHILD_SHM_MAGIC] == 12345)
+    seg[CHILD_SHM_REPLY] = 42;
+  else
+    status = 2;
+
+  /* An aligned store is atomic. */
+  seg[CHILD_SHM_FLAG] = 1;
+  futex_wake (&seg[CHILD_SHM_FLAG], 1);
+  return status;
+}
@@ -0,0 +1,9 @@
+/* Name of the segment shared by the shm-futex test and
+   child-shm, and its size in bytes. */
+#define CHILD_SHM_NAME "shm-futex"
+#define CHILD_SHM_SIZE (2 * 4096)
+
+/* Indexes of ints in the segment. */
+#define CHILD_SHM_FLAG 0        /* Set to 1 by the child. */
+#define CHILD_SHM_MAGIC 1       /* Set by the parent. */
+#define CHILD_SHM_REPLY 1024    /* On page 1, set by the child. */
@@ -0,0 +1,31 @@
+/* Shared by fpu-switch and child-fpu.
+
+   Adds SCALE * I for I in [0, FPU_SUM_CNT) in floating point.
+   Every partial sum is an integer small enough to be exact in a
+   double, so the result is exact unless the FPU registers are
+   corrupted, e.g. by another process's state leaking in during a
+   context switch. */
+
+#define FPU_SUM_CNT 1000000
+
+static inline double
+fpu_sum (int scale)
+{
+  double sum = 0.0;
+  double x = 0.0;
+  int i;
+
+  for (i = 0; i < FPU_SUM_CNT; i++)
+    {
+      sum += x * scale;
+      x += 1.0;
+    }
+  return sum;
+}
+
+/* Returns the value fpu_sum(SCALE) should return. */
+static inline double
+fpu_sum_expected (int scale)
+{
+  return (double) scale * FPU_SUM_CNT * (FPU_SUM_CNT - 1) / 2;
+}
@@ -0,0 +1,32 @@
+/* Runs several processes that all use the FPU at the same time,
+   to check that each one's floating-point registers survive
+   being preempted by the others. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/fpu-sum.h"
+
+#define CHILD_CNT 4
+
+void
+test_main (void) 
+{
+  pid_t pids[CHILD_CNT];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++)
+    {
+      char cmd[32];
+      snprintf (cmd, sizeof cmd, "child-fpu %d", i + 2);
+      CHECK ((pids[i] = exec (cmd)) != PID_ERROR, "exec \"%s\"", cmd);
+    }
+
+  if (fpu_sum (1) != fpu_sum_expected (1))
+    fail ("wrong floating-point sum in parent");
+  msg ("parent sum correct");
+
+  for (i = 0; i < CHILD_CNT; i++)
+    msg ("wait(child %d) = %d", i + 2, wait (pids[i]));
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fpu-switch) begin
+(fpu-switch) exec "child-fpu 2"
+(fpu-switch) exec "child-fpu 3"
+(fpu-switch) exec "child-fpu 4"
+(fpu-switch) exec "child-fpu 5"
+(fpu-switch) parent sum correct
+(fpu-switch) wait(child 2) = 0
+(fpu-switch) wait(child 3) = 0
+(fpu-switch) wait(child 4) = 0
+(fpu-switch) wait(child 5) = 0
+(fpu-switch) end
+EOF
+pass;
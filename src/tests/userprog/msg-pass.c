@@ -0,0 +1,44 @@
+/* Sends messages to a child process with msg_send().  The first
+   is large enough that whole pages can be moved into the child
+   instead of copied; the second is cut short by the child's
+   smaller buffer.  The child checks what it receives.  Sending
+   to a process that has exited must fail. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/child-msg.h"
+
+static char buf[4 * 4096] __attribute__ ((aligned (4096)));
+
+void
+test_main (void) 
+{
+  char *data = buf + CHILD_MSG_OFS;
+  int long_result, short_result;
+  pid_t child;
+  int i;
+
+  for (i = 0; i < CHILD_MSG_SIZE; i++)
+    data[i] = CHILD_MSG_BYTE (i);
+
+  /* Nothing is printed while the child runs. */
+  msg ("exec \"child-msg\" and send two messages");
+  child = exec ("child-msg");
+  long_result = msg_send (child, data, CHILD_MSG_SIZE);
+  for (i = 0; i < CHILD_MSG_SHORT_SIZE; i++)
+    buf[i] = CHILD_MSG_BYTE (i);
+  short_result = msg_send (child, buf, CHILD_MSG_SHORT_SIZE);
+  CHECK (wait (child) == 0, "wait for child-msg");
+
+  if (long_result != CHILD_MSG_SIZE)
+    fail ("first msg_send returned %d, expected %d",
+          long_result, CHILD_MSG_SIZE);
+  msg ("first message delivered whole");
+  if (short_result != CHILD_MSG_SHORT_TAKEN)
+    fail ("second msg_send returned %d, expected %d",
+          short_result, CHILD_MSG_SHORT_TAKEN);
+  msg ("second message cut short");
+
+  CHECK (msg_send (child, buf, 1) == -1, "send to exited child fails");
+}
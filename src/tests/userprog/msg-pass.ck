@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(msg-pass) begin
+(msg-pass) exec "child-msg" and send two messages
+child-msg: exit(0)
+(msg-pass) wait for child-msg
+(msg-pass) first message delivered whole
+(msg-pass) second message cut short
+(msg-pass) send to exited child fails
+(msg-pass) end
+msg-pass: exit(0)
+EOF
+pass;
@@ -0,0 +1,59 @@
+/* Checks that data written into a pipe can be read back, that a
+   pipe end installed as standard output with dup2() is inherited
+   through exec(), and that a reader sees end-of-file once the
+   last writer has gone.  Writing to a pipe without readers must
+   fail. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/child-pipe.h"
+
+void
+test_main (void) 
+{
+  static char buf[CHILD_PIPE_SIZE + 1];
+  int fds[2];
+  int dup_fd;
+  pid_t child;
+  int size, n, i;
+
+  CHECK (pipe (fds) == 0, "pipe");
+  if (fds[0] < 2 || fds[1] < 2 || fds[0] == fds[1])
+    fail ("pipe returned descriptors %d and %d", fds[0], fds[1]);
+
+  CHECK (write (fds[1], "hello", 5) == 5, "write \"hello\" into pipe");
+  CHECK (read (fds[0], buf, sizeof buf) == 5 && !memcmp (buf, "hello", 5),
+         "read \"hello\" back");
+  CHECK (read (fds[1], buf, 1) == -1, "read from write end fails");
+
+  /* Nothing may be printed while standard output is the pipe. */
+  msg ("redirect stdout and exec \"child-pipe\"");
+  dup_fd = dup2 (fds[1], STDOUT_FILENO);
+  close (fds[1]);
+  child = exec ("child-pipe");
+  close (STDOUT_FILENO);
+
+  size = 0;
+  while ((n = read (fds[0], buf + size, sizeof buf - size)) > 0)
+    size += n;
+  CHECK (wait (child) == 0, "wait for child-pipe");
+  CHECK (dup_fd == STDOUT_FILENO, "dup2 onto stdout");
+
+  if (size != CHILD_PIPE_SIZE)
+    fail ("read %d bytes from child, expected %d", size, CHILD_PIPE_SIZE);
+  for (i = 0; i < size; i++)
+    if (buf[i] != CHILD_PIPE_BYTE (i))
+      fail ("byte %d read from child is %d, expected %d",
+            i, buf[i], CHILD_PIPE_BYTE (i));
+  msg ("read %d bytes from child", size);
+  CHECK (read (fds[0], buf, 1) == 0, "end-of-file after child exits");
+  close (fds[0]);
+
+  CHECK (pipe (fds) == 0, "pipe");
+  close (fds[0]);
+  CHECK (write (fds[1], "x", 1) == -1, "write without reader fails");
+  close (fds[1]);
+}
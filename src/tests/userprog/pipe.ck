@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pipe) begin
+(pipe) pipe
+(pipe) write "hello" into pipe
+(pipe) read "hello" back
+(pipe) read from write end fails
+(pipe) redirect stdout and exec "child-pipe"
+child-pipe: exit(0)
+(pipe) wait for child-pipe
+(pipe) dup2 onto stdout
+(pipe) read 10000 bytes from child
+(pipe) end-of-file after child exits
+(pipe) pipe
+(pipe) write without reader fails
+(pipe) end
+pipe: exit(0)
+EOF
+pass;
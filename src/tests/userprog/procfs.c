@@ -0,0 +1,77 @@
+/* Reads /proc: its directory lists the statistics files and our
+   own process, the files hold "NAME: VALUE" lines, and it can be
+   neither written nor added to.  Relative names reach it too. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Opens /proc/NAME, reads it into BUFFER, and checks that it
+   starts with PREFIX.  LABEL names the file in messages. */
+static void
+check_proc_file (const char *name, const char *label, const char *prefix,
+            char *buffer, size_t size)
+{
+  char path[32];
+  int fd, n;
+
+  snprintf (path, sizeof path, "/proc/%s", name);
+  CHECK ((fd = open (path)) > 1, "open \"/proc/%s\"", label);
+  n = read (fd, buffer, size - 1);
+  if (n <= 0)
+    fail ("read \"%s\" returned %d", path, n);
+  buffer[n] = '\0';
+  if (memcmp (buffer, prefix, strlen (prefix)))
+    fail ("\"%s\" starts with \"%.20s\", expected \"%s\"", path, buffer, prefix);
+  close (fd);
+}
+
+void
+test_main (void) 
+{
+  char name[READDIR_MAX_LEN + 1];
+  char buffer[512];
+  char pid[READDIR_MAX_LEN + 1];
+  bool saw_stat = false;
+  int fd;
+
+  CHECK ((fd = open ("/proc")) > 1, "open \"/proc\"");
+  CHECK (isdir (fd), "isdir \"/proc\"");
+  pid[0] = '\0';
+  while (readdir (fd, name)) 
+    {
+      if (!strcmp (name, "stat"))
+        saw_stat = true;
+      else if (atoi (name) > 0)
+        strlcpy (pid, name, sizeof pid);
+    }
+  close (fd);
+  if (!saw_stat)
+    fail ("\"/proc\" does not list \"stat\"");
+  if (pid[0] == '\0')
+    fail ("\"/proc\" lists no processes");
+
+  check_proc_file ("stat", "stat", "uptime-ticks: ", buffer, sizeof buffer);
+  check_proc_file ("cache", "cache", "sectors: ", buffer, sizeof buffer);
+  check_proc_file (pid, "PID", "pid: ", buffer, sizeof buffer);
+  if (strstr (buffer, "name: procfs\n") == NULL)
+    fail ("process file does not name \"procfs\"");
+
+  CHECK ((fd = open ("/proc/stat")) > 1, "open \"/proc/stat\"");
+  CHECK (write (fd, "x", 1) == -1, "write \"/proc/stat\" fails");
+  close (fd);
+  CHECK (!create ("/proc/new", 0), "create \"/proc/new\" fails");
+  CHECK (open ("/proc/nonexistent") == -1, "open \"/proc/nonexistent\" fails");
+
+  CHECK ((fd = open ("proc/stat")) > 1, "open \"proc/stat\"");
+  CHECK (write (fd, "x", 1) == -1, "write \"proc/stat\" fails");
+  close (fd);
+  CHECK (mkdir ("procfs-dir"), "mkdir \"procfs-dir\"");
+  CHECK (chdir ("procfs-dir"), "chdir \"procfs-dir\"");
+  CHECK ((fd = open ("../proc/./stat")) > 1, "open \"../proc/./stat\"");
+  close (fd);
+  CHECK (!create ("../proc/new", 0), "create \"../proc/new\" fails");
+}
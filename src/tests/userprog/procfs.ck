@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(procfs) begin
+(procfs) open "/proc"
+(procfs) isdir "/proc"
+(procfs) open "/proc/stat"
+(procfs) open "/proc/cache"
+(procfs) open "/proc/PID"
+(procfs) open "/proc/stat"
+(procfs) write "/proc/stat" fails
+(procfs) create "/proc/new" fails
+(procfs) open "/proc/nonexistent" fails
+(procfs) open "proc/stat"
+(procfs) write "proc/stat" fails
+(procfs) mkdir "procfs-dir"
+(procfs) chdir "procfs-dir"
+(procfs) open "../proc/./stat"
+(procfs) create "../proc/new" fails
+(procfs) end
+procfs: exit(0)
+EOF
+pass;
@@ -0,0 +1,21 @@
+/* Checks admission control for real-time reservations, then
+   runs a few periods of a periodic task. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int i;
+
+  CHECK (!rt_reserve (20, 10), "runtime longer than period refused");
+  CHECK (!rt_reserve (100, 100), "full CPU refused");
+  CHECK (rt_reserve (10, 50), "reserve 10 ms every 50 ms");
+  CHECK (rt_reserve (20, 50), "change to 20 ms every 50 ms");
+  for (i = 0; i < 5; i++)
+    rt_wait ();
+  msg ("waited for 5 periods");
+  CHECK (rt_reserve (0, 0), "drop reservation");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rt-admit) begin
+(rt-admit) runtime longer than period refused
+(rt-admit) full CPU refused
+(rt-admit) reserve 10 ms every 50 ms
+(rt-admit) change to 20 ms every 50 ms
+(rt-admit) waited for 5 periods
+(rt-admit) drop reservation
+(rt-admit) end
+rt-admit: exit(0)
+EOF
+pass;
@@ -0,0 +1,38 @@
+/* Checks that getrusage() counts system calls and cache reads
+   for the calling process, and the usage of its children once
+   they have been waited for. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage before, after, children;
+  char buffer[128];
+  int fd;
+
+  CHECK (getrusage (RUSAGE_SELF, &before) == 0, "getrusage (RUSAGE_SELF)");
+  CHECK (before.ru_nsyscalls > 0, "system calls counted");
+
+  CHECK ((fd = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (read (fd, buffer, sizeof buffer) > 0, "read \"sample.txt\"");
+  close (fd);
+  CHECK (getrusage (RUSAGE_SELF, &after) == 0, "getrusage (RUSAGE_SELF)");
+  if (after.ru_nsyscalls < before.ru_nsyscalls + 4)
+    fail ("%ld system calls after 4 more, expected at least %ld",
+          after.ru_nsyscalls, before.ru_nsyscalls + 4);
+  if (after.ru_inblock <= before.ru_inblock)
+    fail ("reading a file did not count any sectors");
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  CHECK (children.ru_nsyscalls == 0, "no children yet");
+  wait (exec ("child-simple"));
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  CHECK (children.ru_nsyscalls > 0, "child's system calls counted");
+
+  CHECK (getrusage (42, &children) == -1, "getrusage (42) fails");
+}
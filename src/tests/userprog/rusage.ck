@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rusage) begin
+(rusage) getrusage (RUSAGE_SELF)
+(rusage) system calls counted
+(rusage) open "sample.txt"
+(rusage) read "sample.txt"
+(rusage) getrusage (RUSAGE_SELF)
+(rusage) getrusage (RUSAGE_CHILDREN)
+(rusage) no children yet
+(child-simple) run
+child-simple: exit(81)
+(rusage) getrusage (RUSAGE_CHILDREN)
+(rusage) child's system calls counted
+(rusage) getrusage (42) fails
+(rusage) end
+rusage: exit(0)
+EOF
+pass;
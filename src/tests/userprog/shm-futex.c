@@ -0,0 +1,46 @@
+/* Checks that a named shared memory segment attached by two
+   processes at different addresses is the same memory, and that
+   one process can sleep in futex_wait() until the other calls
+   futex_wake(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/child-shm.h"
+
+void
+test_main (void) 
+{
+  int *seg = (int *) 0x10000000;
+  volatile int *flag = &seg[CHILD_SHM_FLAG];
+  pid_t child;
+
+  CHECK (shm_attach (CHILD_SHM_NAME, seg, CHILD_SHM_SIZE),
+         "attach \"%s\"", CHILD_SHM_NAME);
+  CHECK (seg[CHILD_SHM_FLAG] == 0 && seg[CHILD_SHM_REPLY] == 0,
+         "segment is zeroed");
+  CHECK (!shm_attach (CHILD_SHM_NAME, (int *) 0x18000000,
+                      CHILD_SHM_SIZE + 4096),
+         "attaching more than the segment's size fails");
+  CHECK (!shm_attach (CHILD_SHM_NAME, (int *) 0xc0000000, 4096),
+         "attaching at a kernel address fails");
+  CHECK (!shm_attach (CHILD_SHM_NAME, (int *) 0xbffff000, 8192),
+         "attaching across PHYS_BASE fails");
+  CHECK (futex_wait (&seg[CHILD_SHM_FLAG], 1) == -1,
+         "futex_wait with a stale value returns at once");
+  CHECK (futex_wake (&seg[CHILD_SHM_FLAG], 1) == 0,
+         "futex_wake without waiters wakes none");
+  seg[CHILD_SHM_MAGIC] = 12345;
+
+  /* Nothing is printed until the child has exited, so the output
+     does not depend on whether we really had to sleep. */
+  msg ("exec \"child-shm\" and wait on futex");
+  child = exec ("child-shm");
+  while (*flag == 0)
+    futex_wait (&seg[CHILD_SHM_FLAG], 0);
+  CHECK (wait (child) == 0, "wait for child-shm");
+  CHECK (seg[CHILD_SHM_REPLY] == 42, "child's reply is visible");
+
+  CHECK (shm_detach (seg), "detach \"%s\"", CHILD_SHM_NAME);
+  CHECK (!shm_detach (seg), "detaching again fails");
+}
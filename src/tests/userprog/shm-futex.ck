@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(shm-futex) begin
+(shm-futex) attach "shm-futex"
+(shm-futex) segment is zeroed
+(shm-futex) attaching more than the segment's size fails
+(shm-futex) attaching at a kernel address fails
+(shm-futex) attaching across PHYS_BASE fails
+(shm-futex) futex_wait with a stale value returns at once
+(shm-futex) futex_wake without waiters wakes none
+(shm-futex) exec "child-shm" and wait on futex
+child-shm: exit(0)
+(shm-futex) wait for child-shm
+(shm-futex) child's reply is visible
+(shm-futex) detach "shm-futex"
+(shm-futex) detaching again fails
+(shm-futex) end
+shm-futex: exit(0)
+EOF
+pass;
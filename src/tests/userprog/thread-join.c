@@ -0,0 +1,59 @@
+/* Spawns several threads in one process and joins them.  Each
+   thread writes to memory shared with the main thread, and one
+   of them opens a file whose descriptor the main thread then
+   reads through, since threads share the descriptor table. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define THREAD_CNT 4
+
+static int results[THREAD_CNT];
+static int shared_fd;
+
+static int
+worker (void *aux) 
+{
+  int id = (int) aux;
+  int i;
+
+  for (i = 0; i <= 100; i++)
+    results[id] += i;
+  return id + 10;
+}
+
+static int
+opener (void *aux UNUSED) 
+{
+  shared_fd = open ("sample.txt");
+  return shared_fd > 1;
+}
+
+void
+test_main (void) 
+{
+  tid_t tids[THREAD_CNT];
+  tid_t tid;
+  char byte;
+  int i;
+
+  for (i = 0; i < THREAD_CNT; i++)
+    CHECK ((tids[i] = thread_spawn (worker, (void *) i)) != TID_ERROR,
+           "spawn thread %d", i);
+  for (i = 0; i < THREAD_CNT; i++)
+    {
+      int status = thread_join (tids[i]);
+      if (status != i + 10)
+        fail ("thread %d returned %d", i, status);
+      if (results[i] != 5050)
+        fail ("thread %d computed %d", i, results[i]);
+    }
+  msg ("joined %d threads", THREAD_CNT);
+
+  CHECK (thread_join (tids[0]) == -1, "join thread 0 again");
+
+  CHECK ((tid = thread_spawn (opener, NULL)) != TID_ERROR, "spawn opener");
+  CHECK (thread_join (tid) == 1, "join opener");
+  CHECK (read (shared_fd, &byte, 1) == 1, "read from opener's fd");
+}
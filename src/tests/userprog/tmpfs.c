@@ -0,0 +1,54 @@
+/* Uses /tmp: files there can be created, written, read back and
+   listed, a removed file stays readable until it is closed, and
+   no directories can be made inside it. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf1[9000];
+static char buf2[9000];
+
+void
+test_main (void) 
+{
+  char name[READDIR_MAX_LEN + 1];
+  bool saw_file = false;
+  size_t i;
+  int fd, dir_fd;
+
+  for (i = 0; i < sizeof buf1; i++)
+    buf1[i] = i * 7 + i / 256;
+
+  CHECK (create ("/tmp/scratch", 0), "create \"/tmp/scratch\"");
+  CHECK (!create ("/tmp/scratch", 0), "create \"/tmp/scratch\" again fails");
+  CHECK ((fd = open ("/tmp/scratch")) > 1, "open \"/tmp/scratch\"");
+  CHECK (write (fd, buf1, sizeof buf1) == sizeof buf1,
+         "write \"/tmp/scratch\"");
+  CHECK (filesize (fd) == sizeof buf1, "filesize \"/tmp/scratch\"");
+  seek (fd, 0);
+  CHECK (read (fd, buf2, sizeof buf2) == sizeof buf2,
+         "read \"/tmp/scratch\"");
+  if (memcmp (buf1, buf2, sizeof buf1))
+    fail ("data read back differs from data written");
+
+  CHECK ((dir_fd = open ("/tmp")) > 1, "open \"/tmp\"");
+  CHECK (isdir (dir_fd), "isdir \"/tmp\"");
+  while (readdir (dir_fd, name))
+    if (!strcmp (name, "scratch"))
+      saw_file = true;
+  close (dir_fd);
+  if (!saw_file)
+    fail ("\"/tmp\" does not list \"scratch\"");
+
+  CHECK (remove ("/tmp/scratch"), "remove \"/tmp/scratch\"");
+  CHECK (open ("/tmp/scratch") == -1, "open removed file fails");
+  seek (fd, 4096);
+  CHECK (read (fd, buf2, 100) == 100, "read removed file while open");
+  if (memcmp (buf1 + 4096, buf2, 100))
+    fail ("removed file lost its data");
+  close (fd);
+
+  CHECK (!mkdir ("/tmp/dir"), "mkdir \"/tmp/dir\" fails");
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(tmpfs) begin
+(tmpfs) create "/tmp/scratch"
+(tmpfs) create "/tmp/scratch" again fails
+(tmpfs) open "/tmp/scratch"
+(tmpfs) write "/tmp/scratch"
+(tmpfs) filesize "/tmp/scratch"
+(tmpfs) read "/tmp/scratch"
+(tmpfs) open "/tmp"
+(tmpfs) isdir "/tmp"
+(tmpfs) remove "/tmp/scratch"
+(tmpfs) open removed file fails
+(tmpfs) read removed file while open
+(tmpfs) mkdir "/tmp/dir" fails
+(tmpfs) end
+tmpfs: exit(0)
+EOF
+pass;
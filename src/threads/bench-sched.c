@@ -0,0 +1,285 @@
+/* Scheduler and synchronization microbenchmarks, run by the
+   "bench" action as "bench sched" (see threads/bench.c) in any
+   kernel.
+
+   Each benchmark repeats an operation and times every repetition
+   with the high-resolution clock (the TSC, when the CPU has one),
+   then prints one line of the form
+
+        PERF bench-sched:NAME samples=N min=NS median=NS p99=NS
+             max=NS [ops=N ns/op=NS]
+
+   (on a single line), with times in nanoseconds.  Run with interrupts from other sources quiet:
+   timer interrupts land in some samples, which is what the p99
+   and max columns show. */
+
+#include "threads/bench.h"
+#include <debug.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/clock.h"
+#include "devices/timer.h"
+
+/* Number of timed repetitions of most benchmarks. */
+#define SAMPLE_CNT 1000
+
+/* Threads contending for the lock in the lock benchmark. */
+#define LOCK_MAX_THREADS 8
+#define LOCK_ITERATIONS 250
+
+/* Waiters woken by each broadcast in the condition variable
+   benchmark, and the number of broadcasts. */
+#define COND_WAITERS 8
+#define COND_ROUNDS 100
+
+/* Timer sleeps in the sleep jitter benchmark. */
+#define SLEEP_CNT 50
+
+static uint64_t samples[SAMPLE_CNT];
+
+static int
+compare_u64 (const void *a_, const void *b_) 
+{
+  const uint64_t *a = a_;
+  const uint64_t *b = b_;
+
+  return *a < *b ? -1 : *a > *b;
+}
+
+/* Prints the distribution of the first CNT samples, which are in
+   clock cycles, as benchmark NAME.  If OPS is nonzero, also
+   prints the throughput of OPS operations over TOTAL cycles. */
+static void
+report (const char *name, size_t cnt, long ops, uint64_t total) 
+{
+  ASSERT (cnt > 0 && cnt <= SAMPLE_CNT);
+
+  qsort (samples, cnt, sizeof *samples, compare_u64);
+  printf ("PERF bench-sched:%s samples=%zu min=%lld median=%lld "
+          "p99=%lld max=%lld",
+          name, cnt, clock_cycles_to_ns (samples[0]),
+          clock_cycles_to_ns (samples[cnt / 2]),
+          clock_cycles_to_ns (samples[cnt * 99 / 100]),
+          clock_cycles_to_ns (samples[cnt - 1]));
+  if (ops > 0)
+    printf (" ops=%ld ns/op=%lld", ops, clock_cycles_to_ns (total) / ops);
+  printf ("\n");
+}
+
+/* Yield round trip: we yield to a thread that yields straight
+   back. */
+
+static volatile bool yield_done;
+
+static void
+yield_partner (void *aux UNUSED) 
+{
+  while (!yield_done)
+    thread_yield ();
+}
+
+static void
+bench_yield (void) 
+{
+  size_t i;
+
+  yield_done = false;
+  thread_create ("yielder", thread_get_priority (), yield_partner, NULL);
+  thread_yield ();
+  for (i = 0; i < SAMPLE_CNT; i++) 
+    {
+      uint64_t start = clock_read ();
+      thread_yield ();
+      samples[i] = clock_read () - start;
+    }
+  yield_done = true;
+  thread_yield ();
+  report ("yield", SAMPLE_CNT, 0, 0);
+}
+
+/* Semaphore ping-pong: we up one semaphore and down another,
+   which a partner thread ups in response. */
+
+static struct semaphore ping, pong;
+
+static void
+pong_partner (void *aux UNUSED) 
+{
+  size_t i;
+
+  for (i = 0; i < SAMPLE_CNT; i++) 
+    {
+      sema_down (&ping);
+      sema_up (&pong);
+    }
+}
+
+static void
+bench_sema (void) 
+{
+  size_t i;
+
+  sema_init (&ping, 0);
+  sema_init (&pong, 0);
+  thread_create ("ponger", thread_get_priority (), pong_partner, NULL);
+  for (i = 0; i < SAMPLE_CNT; i++) 
+    {
+      uint64_t start = clock_read ();
+      sema_up (&ping);
+      sema_down (&pong);
+      samples[i] = clock_read () - start;
+    }
+  report ("sema-pingpong", SAMPLE_CNT, 0, 0);
+}
+
+/* Contended lock: THREAD_CNT threads each acquire and release a
+   lock LOCK_ITERATIONS times, yielding while holding it so that
+   the others have to wait.  Samples are acquire latencies. */
+
+static struct lock bench_lock;
+static struct semaphore lock_done;
+static size_t lock_sample_cnt;
+
+static void
+lock_contender (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < LOCK_ITERATIONS; i++) 
+    {
+      uint64_t start = clock_read ();
+      lock_acquire (&bench_lock);
+      if (lock_sample_cnt < SAMPLE_CNT)
+        samples[lock_sample_cnt++] = clock_read () - start;
+      thread_yield ();
+      lock_release (&bench_lock);
+    }
+  sema_up (&lock_done);
+}
+
+static void
+bench_lock_contended (int thread_cnt) 
+{
+  uint64_t start;
+  char name[32];
+  int i;
+
+  lock_init (&bench_lock);
+  sema_init (&lock_done, 0);
+  lock_sample_cnt = 0;
+
+  start = clock_read ();
+  for (i = 0; i < thread_cnt; i++)
+    thread_create ("contender", thread_get_priority (), lock_contender, NULL);
+  for (i = 0; i < thread_cnt; i++)
+    sema_down (&lock_done);
+
+  snprintf (name, sizeof name, "lock-%d", thread_cnt);
+  report (name, lock_sample_cnt, (long) thread_cnt * LOCK_ITERATIONS,
+          clock_read () - start);
+}
+
+/* Condition variable broadcast: COND_WAITERS threads wait on a
+   condition; we time from the broadcast until the last of them
+   has woken and reacquired the lock. */
+
+static struct lock cond_lock;
+static struct condition cond;
+static struct semaphore cond_ready, cond_woken;
+static int cond_round;
+static int cond_awake;
+
+static void
+cond_waiter (void *aux UNUSED) 
+{
+  int round;
+
+  lock_acquire (&cond_lock);
+  for (round = 0; round < COND_ROUNDS; round++) 
+    {
+      sema_up (&cond_ready);
+      while (cond_round == round)
+        cond_wait (&cond, &cond_lock);
+      if (++cond_awake == COND_WAITERS)
+        sema_up (&cond_woken);
+    }
+  lock_release (&cond_lock);
+}
+
+static void
+bench_cond (void) 
+{
+  int round, i;
+
+  lock_init (&cond_lock);
+  cond_init (&cond);
+  sema_init (&cond_ready, 0);
+  sema_init (&cond_woken, 0);
+  cond_round = 0;
+
+  for (i = 0; i < COND_WAITERS; i++)
+    thread_create ("waiter", thread_get_priority (), cond_waiter, NULL);
+  for (round = 0; round < COND_ROUNDS; round++) 
+    {
+      uint64_t start;
+
+      for (i = 0; i < COND_WAITERS; i++)
+        sema_down (&cond_ready);
+
+      lock_acquire (&cond_lock);
+      cond_awake = 0;
+      cond_round++;
+      start = clock_read ();
+      cond_broadcast (&cond, &cond_lock);
+      lock_release (&cond_lock);
+      sema_down (&cond_woken);
+      samples[round] = clock_read () - start;
+    }
+  report ("cond-broadcast-8", COND_ROUNDS, 0, 0);
+}
+
+/* Sleep jitter: how far past one timer tick timer_sleep(1)
+   actually wakes us. */
+static void
+bench_sleep (void) 
+{
+  int64_t tick_ns = NSEC_PER_SEC / TIMER_FREQ;
+  size_t i;
+
+  for (i = 0; i < SLEEP_CNT; i++) 
+    {
+      int64_t start = clock_ns ();
+      int64_t late;
+
+      timer_sleep (1);
+      late = clock_ns () - start - tick_ns;
+      samples[i] = late > 0 ? late : -late;
+    }
+
+  /* Samples are already in nanoseconds, so don't go through
+     report(). */
+  qsort (samples, SLEEP_CNT, sizeof *samples, compare_u64);
+  printf ("PERF bench-sched:sleep-jitter samples=%d min=%lld median=%lld "
+          "p99=%lld max=%lld\n", SLEEP_CNT, (long long) samples[0],
+          (long long) samples[SLEEP_CNT / 2],
+          (long long) samples[SLEEP_CNT * 99 / 100],
+          (long long) samples[SLEEP_CNT - 1]);
+}
+
+/* Runs each of the scheduler benchmarks. */
+void
+bench_sched (void) 
+{
+  int thread_cnt;
+
+  printf ("bench-sched: clock source: %s\n", clock_name ());
+  bench_yield ();
+  bench_sema ();
+  for (thread_cnt = 2; thread_cnt <= LOCK_MAX_THREADS; thread_cnt *= 2)
+    bench_lock_contended (thread_cnt);
+  bench_cond ();
+  bench_sleep ();
+}
@@ -0,0 +1,371 @@
+/* In-kernel microbenchmarks for the library primitives that the
+   rest of the kernel is built on, run with the "bench" action:
+
+        pintos -- -q bench NAME
+
+   where NAME is one of the benchmarks in the table below, or
+   "all".  Each measured case prints one line of the form
+
+        PERF bench:CASE ops=N cycles/op=N ns/op=N
+
+   Cycles are those of the high-resolution clock (the TSC, when
+   the CPU has one).  Every case is run ROUNDS times and the
+   fastest round is reported, which filters out rounds that
+   happened to take a timer interrupt. */
+
+#include "threads/bench.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <random.h>
+#include <stdio.h>
+#include <string.h>
+#include "devices/clock.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+
+/* Times each case is repeated. */
+#define ROUNDS 5
+
+/* Prints the result of case NAME, which did OPS operations in
+   CYCLES clock cycles. */
+void
+bench_report (const char *name, long ops, uint64_t cycles) 
+{
+  ASSERT (ops > 0);
+
+  printf ("PERF bench:%s ops=%ld cycles/op=%llu ns/op=%lld\n",
+          name, ops, cycles / ops, clock_cycles_to_ns (cycles) / ops);
+}
+
+/* Keeps the fastest of several rounds of a case. */
+static void
+keep_best (uint64_t *best, uint64_t start) 
+{
+  uint64_t cycles = clock_read () - start;
+  if (cycles < *best)
+    *best = cycles;
+}
+
+/* Hash table insertion and lookup. */
+
+struct bench_value 
+  {
+    struct hash_elem hash_elem;
+    struct list_elem list_elem;
+    int key;
+  };
+
+static unsigned
+value_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  return hash_int (hash_entry (e, struct bench_value, hash_elem)->key);
+}
+
+static bool
+value_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED) 
+{
+  return (hash_entry (a, struct bench_value, hash_elem)->key
+          < hash_entry (b, struct bench_value, hash_elem)->key);
+}
+
+static void
+bench_hash_size (size_t size) 
+{
+  uint64_t insert = UINT64_MAX, find = UINT64_MAX;
+  struct bench_value *values;
+  char name[32];
+  size_t i;
+  int round;
+
+  values = malloc (size * sizeof *values);
+  if (values == NULL)
+    PANIC ("out of memory for %zu hash elements", size);
+  for (i = 0; i < size; i++)
+    values[i].key = random_ulong ();
+
+  for (round = 0; round < ROUNDS; round++) 
+    {
+      struct hash h;
+      uint64_t start;
+
+      hash_init (&h, value_hash, value_less, NULL);
+      start = clock_read ();
+      for (i = 0; i < size; i++)
+        hash_insert (&h, &values[i].hash_elem);
+      keep_best (&insert, start);
+
+      start = clock_read ();
+      for (i = 0; i < size; i++)
+        if (hash_find (&h, &values[i].hash_elem) == NULL)
+          PANIC ("hash_find lost element %zu", i);
+      keep_best (&find, start);
+      hash_destroy (&h, NULL);
+    }
+  free (values);
+
+  snprintf (name, sizeof name, "hash-insert-%zu", size);
+  bench_report (name, size, insert);
+  snprintf (name, sizeof name, "hash-find-%zu", size);
+  bench_report (name, size, find);
+}
+
+static void
+bench_hash_map_size (size_t size) 
+{
+  uint64_t insert = UINT64_MAX, find = UINT64_MAX;
+  char name[32];
+  size_t i;
+  int round;
+
+  for (round = 0; round < ROUNDS; round++) 
+    {
+      struct hash_map m;
+      uint64_t start;
+
+      if (!hash_map_init (&m))
+        PANIC ("out of memory for hash map");
+      start = clock_read ();
+      for (i = 0; i < size; i++)
+        if (!hash_map_insert (&m, (i + 1) << PGBITS, &m))
+          PANIC ("out of memory for %zu hash map keys", size);
+      keep_best (&insert, start);
+
+      start = clock_read ();
+      for (i = 0; i < size; i++)
+        if (hash_map_find (&m, (i + 1) << PGBITS) == NULL)
+          PANIC ("hash_map_find lost key %zu", i);
+      keep_best (&find, start);
+      hash_map_destroy (&m);
+    }
+
+  snprintf (name, sizeof name, "hash-map-insert-%zu", size);
+  bench_report (name, size, insert);
+  snprintf (name, sizeof name, "hash-map-find-%zu", size);
+  bench_report (name, size, find);
+}
+
+static void
+bench_hash (void) 
+{
+  bench_hash_size (64);
+  bench_hash_size (1024);
+  bench_hash_size (16384);
+  bench_hash_map_size (64);
+  bench_hash_map_size (1024);
+  bench_hash_map_size (16384);
+}
+
+/* Bitmap scanning.  Maps are filled with random allocations at
+   several densities, with the only free run long enough for the
+   largest request left near the end, the way a long-running
+   page allocator fragments. */
+
+#define BITMAP_BITS 8192
+#define SCANS 100
+
+static void
+bench_bitmap_density (struct bitmap *b, int percent_full) 
+{
+  static const size_t runs[] = {1, 8, 64};
+  size_t i, j;
+
+  bitmap_set_all (b, false);
+  for (i = 0; i < BITMAP_BITS; i++)
+    if (random_ulong () % 100 < (unsigned long) percent_full)
+      bitmap_mark (b, i);
+  bitmap_set_multiple (b, BITMAP_BITS - 128, 128, false);
+
+  for (i = 0; i < sizeof runs / sizeof *runs; i++) 
+    {
+      uint64_t best = UINT64_MAX;
+      char name[48];
+      int round;
+
+      for (round = 0; round < ROUNDS; round++) 
+        {
+          uint64_t start = clock_read ();
+          for (j = 0; j < SCANS; j++)
+            if (bitmap_scan (b, 0, runs[i], false) == BITMAP_ERROR)
+              PANIC ("bitmap_scan found no run of %zu", runs[i]);
+          keep_best (&best, start);
+        }
+      snprintf (name, sizeof name, "bitmap-scan-%d%%-full-run-%zu",
+                percent_full, runs[i]);
+      bench_report (name, SCANS, best);
+    }
+}
+
+static void
+bench_bitmap (void) 
+{
+  struct bitmap *b = bitmap_create (BITMAP_BITS);
+  if (b == NULL)
+    PANIC ("out of memory for bitmap");
+
+  bench_bitmap_density (b, 50);
+  bench_bitmap_density (b, 90);
+  bench_bitmap_density (b, 99);
+  bitmap_destroy (b);
+}
+
+/* memcpy() and memset() at several sizes, within a pair of
+   pages so that the data stays in the CPU cache. */
+
+#define MEM_REPS 1000
+
+static const size_t mem_sizes[] = {16, 256, 4096};
+
+static void
+bench_memcpy (void) 
+{
+  uint8_t *src = palloc_get_multiple (PAL_ASSERT | PAL_ZERO, 2);
+  uint8_t *dst = src + PGSIZE;
+  size_t i;
+  int j;
+
+  for (i = 0; i < sizeof mem_sizes / sizeof *mem_sizes; i++) 
+    {
+      uint64_t aligned = UINT64_MAX, unaligned = UINT64_MAX;
+      size_t size = mem_sizes[i];
+      char name[32];
+      int round;
+
+      for (round = 0; round < ROUNDS; round++) 
+        {
+          uint64_t start = clock_read ();
+          for (j = 0; j < MEM_REPS; j++)
+            memcpy (dst, src, size);
+          keep_best (&aligned, start);
+
+          start = clock_read ();
+          for (j = 0; j < MEM_REPS; j++)
+            memcpy (dst + 1, src + 3, size - 3);
+          keep_best (&unaligned, start);
+        }
+      snprintf (name, sizeof name, "memcpy-%zu", size);
+      bench_report (name, MEM_REPS, aligned);
+      snprintf (name, sizeof name, "memcpy-unaligned-%zu", size);
+      bench_report (name, MEM_REPS, unaligned);
+    }
+  palloc_free_multiple (src, 2);
+}
+
+static void
+bench_memset (void) 
+{
+  uint8_t *buf = palloc_get_page (PAL_ASSERT);
+  size_t i;
+  int j;
+
+  for (i = 0; i < sizeof mem_sizes / sizeof *mem_sizes; i++) 
+    {
+      uint64_t best = UINT64_MAX;
+      size_t size = mem_sizes[i];
+      char name[32];
+      int round;
+
+      for (round = 0; round < ROUNDS; round++) 
+        {
+          uint64_t start = clock_read ();
+          for (j = 0; j < MEM_REPS; j++)
+            memset (buf, j, size);
+          keep_best (&best, start);
+        }
+      snprintf (name, sizeof name, "memset-%zu", size);
+      bench_report (name, MEM_REPS, best);
+    }
+  palloc_free_page (buf);
+}
+
+/* list_sort() of randomly ordered lists. */
+
+static bool
+list_value_less (const struct list_elem *a, const struct list_elem *b,
+                 void *aux UNUSED) 
+{
+  return (list_entry (a, struct bench_value, list_elem)->key
+          < list_entry (b, struct bench_value, list_elem)->key);
+}
+
+static void
+bench_list_sort_size (size_t size) 
+{
+  struct bench_value *values;
+  uint64_t best = UINT64_MAX;
+  char name[32];
+  int round;
+
+  values = malloc (size * sizeof *values);
+  if (values == NULL)
+    PANIC ("out of memory for %zu list elements", size);
+
+  for (round = 0; round < ROUNDS; round++) 
+    {
+      struct list list;
+      uint64_t start;
+      size_t i;
+
+      list_init (&list);
+      for (i = 0; i < size; i++) 
+        {
+          values[i].key = random_ulong ();
+          list_push_back (&list, &values[i].list_elem);
+        }
+      start = clock_read ();
+      list_sort (&list, list_value_less, NULL);
+      keep_best (&best, start);
+    }
+  free (values);
+
+  snprintf (name, sizeof name, "list-sort-%zu", size);
+  bench_report (name, size, best);
+}
+
+static void
+bench_list_sort (void) 
+{
+  bench_list_sort_size (16);
+  bench_list_sort_size (256);
+  bench_list_sort_size (4096);
+}
+
+/* A benchmark. */
+struct benchmark 
+  {
+    const char *name;           /* Benchmark name. */
+    void (*function) (void);    /* Function to run it. */
+  };
+
+/* Table of benchmarks. */
+static const struct benchmark benchmarks[] = 
+  {
+    {"hash", bench_hash},
+    {"bitmap", bench_bitmap},
+    {"memcpy", bench_memcpy},
+    {"memset", bench_memset},
+    {"list-sort", bench_list_sort},
+    {"sched", bench_sched},
+    {NULL, NULL},
+  };
+
+/* Runs the benchmark called NAME, or all of them if NAME is
+   "all". */
+void
+bench_run (const char *name) 
+{
+  const struct benchmark *b;
+  bool found = false;
+
+  for (b = benchmarks; b->name != NULL; b++)
+    if (!strcmp (name, "all") || !strcmp (name, b->name)) 
+      {
+        b->function ();
+        found = true;
+      }
+  if (!found)
+    PANIC ("unknown benchmark `%s'", name);
+}
@@ -0,0 +1,10 @@
+#ifndef THREADS_BENCH_H
+#define THREADS_BENCH_H
+
+#include <stdint.h>
+
+void bench_run (const char *name);
+void bench_report (const char *name, long ops, uint64_t cycles);
+void bench_sched (void);
+
+#endif /* threads/bench.h */
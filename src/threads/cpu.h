@@ -0,0 +1,130 @@
+#ifndef THREADS_CPU_H
+#define THREADS_CPU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Feature bits returned in EDX by CPUID leaf 1.
+   See [IA32-v2a] "CPUID". */
+#define CPUID_FPU  (1u << 0)    /* x87 FPU on chip. */
+#define CPUID_TSC  (1u << 4)    /* Time Stamp Counter. */
+#define CPUID_MSR  (1u << 5)    /* RDMSR and WRMSR. */
+#define CPUID_APIC (1u << 9)    /* Local APIC on chip. */
+#define CPUID_FXSR (1u << 24)   /* FXSAVE and FXRSTOR. */
+#define CPUID_SSE  (1u << 25)   /* SSE extensions. */
+#define CPUID_SSE2 (1u << 26)   /* SSE2 extensions. */
+
+/* Control Register 0 bits.  See [IA32-v3a] 2.5 "Control
+   Registers". */
+#define CR0_MP (1u << 1)        /* Monitor Coprocessor. */
+#define CR0_EM (1u << 2)        /* Emulation. */
+#define CR0_TS (1u << 3)        /* Task Switched. */
+#define CR0_NE (1u << 5)        /* Numeric Error. */
+
+/* Control Register 4 bits. */
+#define CR4_OSFXSR (1u << 9)    /* OS supports FXSAVE/FXRSTOR. */
+#define CR4_OSXMMEXCPT (1u << 10) /* OS handles #XF. */
+
+/* EFLAGS ID bit: CPUID is supported if it can be toggled. */
+#define FLAG_ID 0x00200000
+
+/* Returns true if the CPU implements the CPUID instruction. */
+static inline bool
+cpu_has_cpuid (void)
+{
+  uint32_t before, after;
+
+  asm volatile ("pushfl; popl %0; movl %0, %1; xorl %2, %1; "
+                "pushl %1; popfl; pushfl; popl %1; pushl %0; popfl"
+                : "=&r" (before), "=&r" (after)
+                : "i" (FLAG_ID));
+  return ((before ^ after) & FLAG_ID) != 0;
+}
+
+/* Executes CPUID with EAX=LEAF and stores EAX, EBX, ECX, EDX
+   into REGS[0...3]. */
+static inline void
+cpuid (uint32_t leaf, uint32_t regs[4])
+{
+  asm volatile ("cpuid"
+                : "=a" (regs[0]), "=b" (regs[1]),
+                  "=c" (regs[2]), "=d" (regs[3])
+                : "a" (leaf), "c" (0));
+}
+
+/* Returns the CPUID leaf 1 feature bits in EDX, or 0 if the CPU
+   does not implement CPUID. */
+static inline uint32_t
+cpu_features (void)
+{
+  uint32_t regs[4];
+
+  if (!cpu_has_cpuid ())
+    return 0;
+  cpuid (0, regs);
+  if (regs[0] < 1)
+    return 0;
+  cpuid (1, regs);
+  return regs[3];
+}
+
+/* Returns the current value of the Time Stamp Counter.
+   See [IA32-v2b] "RDTSC". */
+static inline uint64_t
+rdtsc (void)
+{
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+/* Returns the contents of CR0. */
+static inline uint32_t
+rcr0 (void)
+{
+  uint32_t cr0;
+  asm volatile ("movl %%cr0, %0" : "=r" (cr0));
+  return cr0;
+}
+
+/* Loads CR0 with VALUE. */
+static inline void
+lcr0 (uint32_t value)
+{
+  asm volatile ("movl %0, %%cr0" : : "r" (value) : "memory");
+}
+
+/* Returns the contents of CR4. */
+static inline uint32_t
+rcr4 (void)
+{
+  uint32_t cr4;
+  asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+  return cr4;
+}
+
+/* Loads CR4 with VALUE. */
+static inline void
+lcr4 (uint32_t value)
+{
+  asm volatile ("movl %0, %%cr4" : : "r" (value) : "memory");
+}
+
+/* Reads and returns model-specific register MSR.
+   See [IA32-v2b] "RDMSR". */
+static inline uint64_t
+rdmsr (uint32_t msr)
+{
+  uint64_t value;
+  asm volatile ("rdmsr" : "=A" (value) : "c" (msr));
+  return value;
+}
+
+/* Writes VALUE to model-specific register MSR. */
+static inline void
+wrmsr (uint32_t msr, uint64_t value)
+{
+  asm volatile ("wrmsr" : : "c" (msr), "A" (value));
+}
+
+#endif /* threads/cpu.h */
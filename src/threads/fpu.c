@@ -0,0 +1,213 @@
+#include "threads/fpu.h"
+#include <debug.h>
+#include <stdint.h>
+#include <string.h>
+#include "threads/cpu.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+
+/* Size of the FXSAVE area.  The older FNSAVE format needs only
+   108 bytes, so this is enough for either. */
+#define FPU_AREA_SIZE 512
+
+/* FXSAVE and FXRSTOR require a 16-byte aligned operand. */
+#define FPU_AREA_ALIGN 16
+
+/* Default MXCSR: all SIMD exceptions masked, round to nearest. */
+#define MXCSR_DEFAULT 0x1f80
+
+/* Saved FPU state of a thread.  malloc() does not return
+   16-byte aligned blocks, so we over-allocate and align by
+   hand. */
+struct fpu_state
+  {
+    uint8_t buf[FPU_AREA_SIZE + FPU_AREA_ALIGN - 1];
+  };
+
+static bool fpu_present;        /* Is there an FPU at all? */
+static bool fpu_fxsr;           /* FXSAVE/FXRSTOR supported? */
+
+/* Thread whose state is currently in the FPU registers, or NULL
+   if none. */
+static struct thread *fpu_owner;
+
+/* Cached value of CR0.TS, to avoid needless CR0 writes. */
+static bool fpu_ts;
+
+/* Clean initial state copied into a thread's save area the
+   first time it uses the FPU. */
+static struct fpu_state initial_state;
+
+static void *area (struct fpu_state *);
+static void save (struct fpu_state *);
+static void restore (struct fpu_state *);
+static void set_ts (bool);
+
+/* Detects the FPU, enables FXSAVE/FXRSTOR and SSE if the CPU
+   supports them, and sets CR0.TS so that the first FPU
+   instruction executed traps to fpu_trap().
+
+   If there is no FPU, CR0.EM is left set, so that FPU
+   instructions still trap but fpu_trap() refuses to handle
+   them. */
+void
+fpu_init (void)
+{
+  uint32_t features = cpu_features ();
+  uint32_t cr0 = rcr0 ();
+
+  fpu_present = (features & CPUID_FPU) != 0;
+  if (!fpu_present)
+    {
+      lcr0 (cr0 | CR0_EM | CR0_TS);
+      fpu_ts = true;
+      return;
+    }
+
+  fpu_fxsr = (features & CPUID_FXSR) != 0;
+  if (fpu_fxsr)
+    {
+      uint32_t cr4 = rcr4 () | CR4_OSFXSR;
+      if (features & CPUID_SSE)
+        cr4 |= CR4_OSXMMEXCPT;
+      lcr4 (cr4);
+    }
+
+  /* Capture a freshly initialized state for later use. */
+  lcr0 ((cr0 & ~(CR0_EM | CR0_TS)) | CR0_MP | CR0_NE);
+  asm volatile ("fninit");
+  if (features & CPUID_SSE)
+    {
+      uint32_t mxcsr = MXCSR_DEFAULT;
+      asm volatile ("ldmxcsr %0" : : "m" (mxcsr));
+    }
+  save (&initial_state);
+
+  fpu_owner = NULL;
+  fpu_ts = false;
+  set_ts (true);
+}
+
+/* Handles a #NM (device not available) exception raised by the
+   running thread: saves the state of the FPU's previous owner,
+   if any, and loads the running thread's state, allocating it
+   on first use.  Returns true if successful, false if there is
+   no FPU or memory is exhausted, in which case the caller should
+   kill the thread.
+
+   Must be called with interrupts off, but not from an external
+   interrupt handler, because it may sleep in malloc(). */
+bool
+fpu_trap (void)
+{
+  struct thread *t = thread_current ();
+  bool fresh = false;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!fpu_present)
+    return false;
+
+  if (t->fpu == NULL)
+    {
+      t->fpu = malloc (sizeof *t->fpu);
+      if (t->fpu == NULL)
+        return false;
+      fresh = true;
+    }
+
+  /* malloc() may have slept, so don't look at the owner until
+     now. */
+  set_ts (false);
+  if (fpu_owner != t)
+    {
+      if (fpu_owner != NULL)
+        save (fpu_owner->fpu);
+      if (fresh)
+        memcpy (area (t->fpu), area (&initial_state), FPU_AREA_SIZE);
+      restore (t->fpu);
+      fpu_owner = t;
+    }
+  return true;
+}
+
+/* Called by the scheduler with interrupts off when NEXT is about
+   to run.  Lets NEXT use the FPU directly if its state is
+   already loaded, otherwise arranges for its first FPU
+   instruction to trap. */
+void
+fpu_switch (struct thread *next)
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  set_ts (next != fpu_owner);
+}
+
+/* Discards T's FPU state, if any.  Called as T exits. */
+void
+fpu_release (struct thread *t)
+{
+  struct fpu_state *state;
+  enum intr_level old_level;
+
+  old_level = intr_disable ();
+  if (fpu_owner == t)
+    {
+      fpu_owner = NULL;
+      set_ts (true);
+    }
+  state = t->fpu;
+  t->fpu = NULL;
+  intr_set_level (old_level);
+
+  free (state);
+}
+
+/* Returns the aligned save area within STATE. */
+static void *
+area (struct fpu_state *state)
+{
+  return (void *) (((uintptr_t) state->buf + FPU_AREA_ALIGN - 1)
+                   & ~(uintptr_t) (FPU_AREA_ALIGN - 1));
+}
+
+/* Saves the FPU registers into STATE.  CR0.TS must be clear.
+   FNSAVE also reinitializes the FPU, which is harmless because
+   we always restore another state afterward. */
+static void
+save (struct fpu_state *state)
+{
+  uint8_t (*p)[FPU_AREA_SIZE] = area (state);
+
+  if (fpu_fxsr)
+    asm volatile ("fxsave %0" : "=m" (*p));
+  else
+    asm volatile ("fnsave %0" : "=m" (*p));
+}
+
+/* Loads the FPU registers from STATE.  CR0.TS must be clear. */
+static void
+restore (struct fpu_state *state)
+{
+  uint8_t (*p)[FPU_AREA_SIZE] = area (state);
+
+  if (fpu_fxsr)
+    asm volatile ("fxrstor %0" : : "m" (*p));
+  else
+    asm volatile ("frstor %0" : : "m" (*p));
+}
+
+/* Sets CR0.TS to TS, if it is not already. */
+static void
+set_ts (bool ts)
+{
+  if (ts != fpu_ts)
+    {
+      if (ts)
+        lcr0 (rcr0 () | CR0_TS);
+      else
+        asm volatile ("clts");
+      fpu_ts = ts;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef THREADS_FPU_H
+#define THREADS_FPU_H
+
+#include <stdbool.h>
+
+struct thread;
+
+/* Lazily switched x87/SSE state.
+
+   The kernel itself is compiled with -msoft-float and never
+   touches the FPU, so only user programs need their floating
+   point registers preserved across thread switches.  Rather than
+   saving and restoring them on every switch, we set CR0.TS
+   whenever a thread other than the current owner of the FPU
+   registers is running.  The first FPU or SSE instruction such a
+   thread executes raises #NM, at which point the previous
+   owner's state is saved and the new thread's state is loaded.
+   A thread that never executes an FPU instruction never pays for
+   a save or restore, and never even has a save area
+   allocated. */
+
+void fpu_init (void);
+bool fpu_trap (void);
+
+void fpu_switch (struct thread *);
+void fpu_release (struct thread *);
+
+#endif /* threads/fpu.h */
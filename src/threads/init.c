@@ -1,6 +1,7 @@
 #include "threads/init.h"
 #include <console.h>
 #include <debug.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <random.h>
 #include <stddef.h>
@@ -8,11 +9,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "devices/clock.h"
 #include "devices/kbd.h"
+#include "devices/profile.h"
 #include "devices/input.h"
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "devices/vga.h"
+#include "threads/bench.h"
+#include "threads/cpu.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
 #include "threads/loader.h"
@@ -20,19 +26,29 @@
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
+#include "userprog/aio.h"
+#include "userprog/exec-cache.h"
+#include "userprog/futex.h"
 #include "userprog/gdt.h"
+#include "userprog/ipc.h"
+#include "userprog/shm.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
 #include "tests/threads/tests.h"
 #endif
 #ifdef FILESYS
+#include "devices/block.h"
 #include "devices/disk.h"
+#include "devices/ramdisk.h"
+#include "devices/stripe.h"
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
+#include "filesys/tmpfs.h"
 #endif
 
 /* Amount of physical memory, in 4 kB pages. */
@@ -44,19 +60,49 @@ uint32_t *base_page_dir;
 #ifdef FILESYS
 /* -f: Format the file system? */
 static bool format_filesys;
+
+/* -o filesys=DEV, -o scratch=DEV, -o swap=DEV: Names of block
+   devices to use for each role, overriding the defaults. */
+static const char *block_role_names[BLOCK_ROLE_CNT];
+
+/* -o ramdisk=SECTORS: Size of RAM disk "ram0", or 0 for none. */
+static disk_sector_t ramdisk_sectors;
+
+/* -o stripe=DEV,DEV...: Members of stripe "md0", or null. */
+static char *stripe_members;
 #endif
 
 /* -q: Power off after kernel tasks complete? */
 bool power_off_when_done;
 
+/* -o boot-timing: Print how long each boot phase took? */
+static bool boot_timing;
+
+/* Ends of boot phases, as Time Stamp Counter values. */
+struct boot_phase
+  {
+    const char *name;           /* Phase that just ended. */
+    uint64_t tsc;               /* When it ended. */
+  };
+#define BOOT_PHASE_CNT 16
+static struct boot_phase boot_phases[BOOT_PHASE_CNT];
+static size_t boot_phase_cnt;
+static bool boot_have_tsc;
+
 static void ram_init (void);
 static void paging_init (void);
+#ifdef FILESYS
+static void locate_block_devices (void);
+#endif
 
 static char **read_command_line (void);
 static char **parse_options (char **argv);
+static void parse_kernel_option (char *option);
 static void run_actions (char **argv);
 static void usage (void);
 
+static void boot_mark (const char *phase);
+static void print_boot_timing (void);
 static void print_stats (void);
 
 
@@ -70,6 +116,7 @@ main (void)
   
   /* Clear BSS and get machine's RAM size. */  
   ram_init ();
+  boot_mark (NULL);
 
   /* Break command line into arguments and parse options. */
   argv = read_command_line ();
@@ -87,6 +134,7 @@ main (void)
   palloc_init ();
   malloc_init ();
   paging_init ();
+  boot_mark ("memory");
 
   /* Segmentation. */
 #ifdef USERPROG
@@ -96,26 +144,49 @@ main (void)
 
   /* Initialize interrupt handlers. */
   intr_init ();
+  fpu_init ();
   timer_init ();
   kbd_init ();
   input_init ();
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  exec_cache_init ();
+  shm_init ();
+  futex_init ();
+  ipc_init ();
 #endif
+  boot_mark ("interrupts");
 
   /* Start thread scheduler and enable interrupts. */
   thread_start ();
   serial_init_queue ();
+  boot_mark ("threads");
+
+  /* Calibrate the clock first, so that timer_calibrate() can use
+     it instead of counting loops one timer tick at a time. */
+  clock_init ();
+  boot_mark ("clock");
   timer_calibrate ();
+  boot_mark ("timer calibration");
+  profile_init ();
+  trace_init ();
 
 #ifdef FILESYS
   /* Initialize file system. */
   disk_init ();
+  locate_block_devices ();
+  boot_mark ("disk probe");
   filesys_init (format_filesys);
+  boot_mark ("file system");
+#ifdef USERPROG
+  aio_init ();
+#endif
 #endif
 
   printf ("Boot complete.\n");
+  if (boot_timing)
+    print_boot_timing ();
   
   /* Run actions specified on kernel command line. */
   run_actions (argv);
@@ -186,6 +257,74 @@ paging_init (void)
   asm volatile ("movl %0, %%cr3" : : "r" (vtop (base_page_dir)));
 }
 
+#ifdef FILESYS
+/* Gives ROLE to the block device named on the command line, or
+   if none was, to the one named DEFAULT_NAME, provided that it
+   exists and is not already in use. */
+static void
+locate_block_device (enum block_role role, const char *default_name) 
+{
+  static const char *role_names[BLOCK_ROLE_CNT] =
+    {"filesys", "scratch", "swap"};
+  const char *name = block_role_names[role];
+  struct block *b;
+
+  if (name != NULL)
+    {
+      b = block_get_by_name (name);
+      if (b == NULL)
+        PANIC ("%s: block device not found", name);
+      if (block_is_claimed (b))
+        PANIC ("%s: block device is already in use", name);
+    }
+  else 
+    {
+      b = block_get_by_name (default_name);
+      if (b == NULL || block_is_claimed (b))
+        return;
+    }
+
+  block_set_role (role, b);
+  printf ("%s: using %s\n", role_names[role], block_name (b));
+}
+
+/* Registers the ATA disks and their partitions as block
+   devices, creates the RAM disk and stripe given on the command
+   line, and then assigns each block device role.  The defaults
+   are the disks that Pintos has always used. */
+static void
+locate_block_devices (void) 
+{
+  block_init ();
+
+  if (ramdisk_sectors > 0)
+    ramdisk_create ("ram0", ramdisk_sectors);
+
+  if (stripe_members != NULL)
+    {
+      struct block *members[STRIPE_MAX];
+      size_t member_cnt = 0;
+      char *name, *save_ptr;
+
+      for (name = strtok_r (stripe_members, ",", &save_ptr); name != NULL;
+           name = strtok_r (NULL, ",", &save_ptr))
+        {
+          if (member_cnt >= STRIPE_MAX)
+            PANIC ("stripe option allows at most %d devices", STRIPE_MAX);
+          members[member_cnt] = block_get_by_name (name);
+          if (members[member_cnt] == NULL)
+            PANIC ("%s: block device not found", name);
+          member_cnt++;
+        }
+      stripe_create ("md0", members, member_cnt);
+    }
+
+  locate_block_device (BLOCK_FILESYS, "hd0:1");
+  locate_block_device (BLOCK_SCRATCH, "hd1:0");
+  locate_block_device (BLOCK_SWAP, "hd1:1");
+}
+#endif
+
 /* Breaks the kernel command line into words and returns them as
    an argv-like array. */
 static char **
@@ -244,6 +383,12 @@ parse_options (char **argv)
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
         thread_mlfqs = true;
+      else if (!strcmp (name, "-o"))
+        {
+          if (argv[1] == NULL)
+            PANIC ("-o requires an argument (use -h for help)");
+          parse_kernel_option (*++argv);
+        }
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
@@ -255,6 +400,147 @@ parse_options (char **argv)
   return argv;
 }
 
+/* Handlers for "-o NAME[=VALUE]" kernel options.  Each is
+   passed VALUE, or a null pointer if there is none. */
+static void
+mlfqs_option (const char *value UNUSED) 
+{
+  thread_mlfqs = true;
+}
+
+static void
+profile_option (const char *value) 
+{
+  if (value == NULL || atoi (value) <= 0)
+    PANIC ("profile option requires a positive rate in Hz");
+  profile_configure (atoi (value));
+}
+
+static void
+boot_timing_option (const char *value UNUSED) 
+{
+  boot_timing = true;
+}
+
+#ifdef FILESYS
+static void
+tmpfs_option (const char *value) 
+{
+  size_t len = value != NULL ? strlen (value) : 0;
+
+  /* find_mount() compares against paths that have no trailing
+     or doubled slashes, so a mount point with them never
+     matches. */
+  if (len < 2 || value[0] != '/' || value[len - 1] == '/'
+      || strstr (value, "//") != NULL)
+    PANIC ("tmpfs option requires an absolute path other than /, "
+           "without trailing or doubled slashes");
+  tmpfs_root = value;
+}
+
+static void
+block_role_option (enum block_role role, const char *name,
+                   const char *value) 
+{
+  if (value == NULL)
+    PANIC ("%s option requires a block device name", name);
+  block_role_names[role] = value;
+}
+
+static void
+filesys_option (const char *value) 
+{
+  block_role_option (BLOCK_FILESYS, "filesys", value);
+}
+
+static void
+scratch_option (const char *value) 
+{
+  block_role_option (BLOCK_SCRATCH, "scratch", value);
+}
+
+static void
+swap_option (const char *value) 
+{
+  block_role_option (BLOCK_SWAP, "swap", value);
+}
+
+static void
+ramdisk_option (const char *value) 
+{
+  if (value == NULL || atoi (value) <= 0)
+    PANIC ("ramdisk option requires a positive number of sectors");
+  ramdisk_sectors = atoi (value);
+}
+
+static void
+stripe_option (const char *value) 
+{
+  if (value == NULL)
+    PANIC ("stripe option requires a list of block devices");
+  stripe_members = (char *) value;
+}
+#endif
+
+#ifdef USERPROG
+static void
+rusage_option (const char *value UNUSED) 
+{
+  process_print_rusage = true;
+}
+#endif
+
+static void
+trace_option (const char *value) 
+{
+  if (value != NULL && atoi (value) <= 0)
+    PANIC ("trace option requires a positive number of pages");
+  trace_configure (value != NULL ? atoi (value) : 0);
+}
+
+/* Parses OPTION, the argument of a "-o" option, which is
+   modified. */
+static void
+parse_kernel_option (char *option) 
+{
+  static const struct kernel_option 
+    {
+      const char *name;                 /* Option name. */
+      void (*handler) (const char *);   /* Handler. */
+    }
+  options[] = 
+    {
+      {"mlfqs", mlfqs_option},
+      {"profile", profile_option},
+      {"trace", trace_option},
+      {"boot-timing", boot_timing_option},
+#ifdef FILESYS
+      {"tmpfs", tmpfs_option},
+      {"filesys", filesys_option},
+      {"scratch", scratch_option},
+      {"swap", swap_option},
+      {"ramdisk", ramdisk_option},
+      {"stripe", stripe_option},
+#endif
+#ifdef USERPROG
+      {"rusage", rusage_option},
+#endif
+    };
+
+  char *save_ptr;
+  char *name = strtok_r (option, "=", &save_ptr);
+  char *value = strtok_r (NULL, "", &save_ptr);
+  size_t i;
+
+  for (i = 0; i < sizeof options / sizeof *options; i++)
+    if (name != NULL && !strcmp (name, options[i].name))
+      {
+        options[i].handler (value);
+        return;
+      }
+  PANIC ("unknown kernel option `%s' (use -h for help)", option);
+}
+
 /* Runs the task specified in ARGV[1]. */
 static void
 run_task (char **argv)
@@ -270,6 +556,13 @@ run_task (char **argv)
   printf ("Execution of '%s' complete.\n", task);
 }
 
+/* Runs the kernel benchmark named in ARGV[1]. */
+static void
+run_bench (char **argv) 
+{
+  bench_run (argv[1]);
+}
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void
@@ -287,6 +580,7 @@ run_actions (char **argv)
   static const struct action actions[] = 
     {
       {"run", 2, run_task},
+      {"bench", 2, run_bench},
 #ifdef FILESYS
       {"ls", 1, fsutil_ls},
       {"cat", 2, fsutil_cat},
@@ -335,6 +629,7 @@ usage (void)
 #else
           "  run TEST           Run TEST.\n"
 #endif
+          "  bench NAME         Run kernel benchmark NAME, or `all'.\n"
 #ifdef FILESYS
           "  ls                 List files in the root directory.\n"
           "  cat FILE           Print FILE to the console.\n"
@@ -349,6 +644,22 @@ usage (void)
           "  -f                 Format file system disk during startup.\n"
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -o NAME[=VALUE]    Set kernel option NAME, one of:\n"
+          "     mlfqs           Same as -mlfqs.\n"
+          "     profile=HZ      Sample the CPU HZ times per second.\n"
+          "     trace[=PAGES]   Record kernel events in a PAGES-page buffer.\n"
+          "     boot-timing     Print how long each phase of boot took.\n"
+#ifdef FILESYS
+          "     tmpfs=PATH      Mount the memory file system at PATH.\n"
+          "     filesys=DEV     Use block device DEV for the file system.\n"
+          "     scratch=DEV     Use block device DEV for scratch.\n"
+          "     swap=DEV        Use block device DEV for swap.\n"
+          "     ramdisk=SECTORS Create RAM disk ram0 of SECTORS sectors.\n"
+          "     stripe=DEV,DEV...  Create stripe md0 over the DEVs.\n"
+#endif
+#ifdef USERPROG
+          "     rusage          Print resource usage when processes exit.\n"
+#endif
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -369,6 +680,8 @@ power_off (void)
   filesys_done ();
 #endif
 
+  profile_dump ();
+  trace_dump ();
   print_stats ();
 
   printf ("Powering off...\n");
@@ -381,6 +694,54 @@ power_off (void)
   for (;;);
 }
 
+/* Records that boot phase PHASE has just ended, or with a null
+   PHASE, that boot has started.  Costs a single RDTSC, so that
+   phases can be timed whether or not "-o boot-timing", which is
+   only parsed later, was given. */
+static void
+boot_mark (const char *phase) 
+{
+  if (phase == NULL)
+    boot_have_tsc = (cpu_features () & CPUID_TSC) != 0;
+  if (boot_have_tsc && boot_phase_cnt < BOOT_PHASE_CNT)
+    {
+      boot_phases[boot_phase_cnt].name = phase;
+      boot_phases[boot_phase_cnt].tsc = rdtsc ();
+      boot_phase_cnt++;
+    }
+}
+
+/* Prints how long each boot phase marked by boot_mark() took.
+   The TSC's rate is known only once clock_init() has calibrated
+   it. */
+static void
+print_boot_timing (void) 
+{
+  size_t i;
+
+  if (!boot_have_tsc || !clock_is_tsc ())
+    {
+      printf ("Boot timing: not available without a TSC.\n");
+      return;
+    }
+
+  printf ("Boot timing:\n");
+  for (i = 1; i < boot_phase_cnt; i++)
+    {
+      int64_t us = clock_cycles_to_ns (boot_phases[i].tsc
+                                       - boot_phases[i - 1].tsc) / 1000;
+      printf ("  %-20s %6"PRId64".%03"PRId64" ms\n",
+              boot_phases[i].name, us / 1000, us % 1000);
+    }
+  if (boot_phase_cnt > 0)
+    {
+      int64_t us = clock_cycles_to_ns (boot_phases[boot_phase_cnt - 1].tsc
+                                       - boot_phases[0].tsc) / 1000;
+      printf ("  %-20s %6"PRId64".%03"PRId64" ms\n",
+              "total", us / 1000, us % 1000);
+    }
+}
+
 /* Print statistics about Pintos execution. */
 static void
 print_stats (void) 
@@ -389,10 +750,13 @@ print_stats (void)
   thread_print_stats ();
 #ifdef FILESYS
   disk_print_stats ();
+  block_print_stats ();
 #endif
   console_print_stats ();
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
+  exec_cache_print_stats ();
+  ipc_print_stats ();
 #endif
 }
@@ -9,6 +9,10 @@
 #include "threads/thread.h"
 #include "threads/vaddr.h"
 #include "devices/timer.h"
+#ifdef USERPROG
+#include "userprog/gdt.h"
+#include "userprog/syscall.h"
+#endif
 
 /* Number of x86 interrupts. */
 #define INTR_CNT 256
@@ -384,6 +388,14 @@ intr_handler (struct intr_frame *frame)
 
       if (yield_on_return) 
         thread_yield (); 
+
+#ifdef USERPROG
+      /* A thread interrupted in user code won't notice that its
+         process is exiting until its next system call, which
+         may never come. */
+      if (frame->cs == SEL_UCSEG)
+        syscall_check_exiting ();
+#endif
     }
 }
 
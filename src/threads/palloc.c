@@ -155,6 +155,20 @@ palloc_free_page (void *page)
   palloc_free_multiple (page, 1);
 }
 
+/* Stores the number of free pages in the pool that FLAGS selects
+   in *FREE_CNT and the total number of pages in it in
+   *PAGE_CNT. */
+void
+palloc_get_stats (enum palloc_flags flags, size_t *free_cnt, size_t *page_cnt) 
+{
+  struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+
+  lock_acquire (&pool->lock);
+  *page_cnt = bitmap_size (pool->used_map);
+  *free_cnt = bitmap_count (pool->used_map, 0, *page_cnt, false);
+  lock_release (&pool->lock);
+}
+
 /* Initializes pool P as starting at START and ending at END,
    naming it NAME for debugging purposes. */
 static void
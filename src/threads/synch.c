@@ -32,6 +32,10 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 
+/* Lock statistics, over all locks. */
+static long long lock_acquire_cnt;      /* # of lock_acquire() calls. */
+static long long lock_contended_cnt;    /* # that had to wait. */
+
 /* Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
    manipulating it:
@@ -197,10 +201,27 @@ lock_acquire (struct lock *lock)
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
+  lock_acquire_cnt++;
+  if (!sema_try_down (&lock->semaphore)) 
+    {
+      lock_contended_cnt++;
+      sema_down (&lock->semaphore);
+    }
   lock->holder = thread_current ();
 }
 
+/* Stores the number of lock_acquire() calls so far, over all
+   locks, in *ACQUIRE_CNT, and the number of them that found the
+   lock held and had to wait in *CONTENDED_CNT. */
+void
+lock_get_stats (long long *acquire_cnt, long long *contended_cnt) 
+{
+  enum intr_level old_level = intr_disable ();
+  *acquire_cnt = lock_acquire_cnt;
+  *contended_cnt = lock_contended_cnt;
+  intr_set_level (old_level);
+}
+
 /* Tries to acquires LOCK and returns true if successful or false
    on failure.  The lock must not already be held by the current
    thread.
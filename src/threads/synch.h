@@ -29,6 +29,7 @@ void lock_acquire (struct lock *);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+void lock_get_stats (long long *acquire_cnt, long long *contended_cnt);
 
 /* Condition variable. */
 struct condition 
@@ -0,0 +1,35 @@
+#include "threads/thread-names.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Remembers the name of thread T in NAMES the first time it is
+   seen.  Searches from the most recently added, which is usually
+   the one.  Once NAMES is full, new threads go unnamed. */
+void
+thread_names_add (struct thread_names *names, const struct thread *t) 
+{
+  size_t i;
+
+  for (i = names->cnt; i-- > 0; )
+    if (names->threads[i].tid == t->tid)
+      return;
+  if (names->cnt < THREAD_NAMES_CNT)
+    {
+      names->threads[names->cnt].tid = t->tid;
+      strlcpy (names->threads[names->cnt].name, t->name,
+               sizeof names->threads[names->cnt].name);
+      names->cnt++;
+    }
+}
+
+/* Prints each name in NAMES on a line of the form
+   "TAG TID NAME". */
+void
+thread_names_print (const struct thread_names *names, const char *tag) 
+{
+  size_t i;
+
+  for (i = 0; i < names->cnt; i++)
+    printf ("%s %d %s\n", tag, names->threads[i].tid,
+            names->threads[i].name);
+}
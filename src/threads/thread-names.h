@@ -0,0 +1,31 @@
+#ifndef THREADS_THREAD_NAMES_H
+#define THREADS_THREAD_NAMES_H
+
+#include <stddef.h>
+#include "threads/thread.h"
+
+/* Names of the threads seen by a tracing facility, so that it
+   can print them even if the threads have exited by the time it
+   does.  Adding a name never allocates memory, so it may be done
+   from an interrupt handler.  The caller must keep interrupts
+   disabled while adding names or ensure mutual exclusion some
+   other way. */
+
+/* Maximum number of names remembered. */
+#define THREAD_NAMES_CNT 128
+
+struct thread_names
+  {
+    size_t cnt;                 /* Number of names remembered. */
+    struct
+      {
+        tid_t tid;              /* Thread identifier. */
+        char name[16];          /* Its name, as in struct thread. */
+      }
+    threads[THREAD_NAMES_CNT];
+  };
+
+void thread_names_add (struct thread_names *, const struct thread *);
+void thread_names_print (const struct thread_names *, const char *tag);
+
+#endif /* threads/thread-names.h */
@@ -2,15 +2,20 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/flags.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
@@ -28,6 +33,27 @@
    that are ready to run but not actually running. */
 static struct list ready_list;
 
+/* List of all threads.  Threads are added to this list when
+   they are created and removed when they exit. */
+static struct list all_list;
+
+/* Real-time threads in THREAD_READY state, in order of
+   increasing deadline.  These always run ahead of the threads in
+   ready_list (earliest deadline first). */
+static struct list rt_ready_list;
+
+/* Real-time threads that have used up their budget for the
+   current period, in order of increasing deadline.  They are
+   THREAD_BLOCKED until their deadline, when their budget is
+   replenished. */
+static struct list rt_throttled_list;
+
+/* Sum of the utilizations of all admitted reservations, in
+   thousandths of the CPU, and the most that we admit, which
+   leaves some time for ordinary threads. */
+static int rt_util;
+#define RT_UTIL_MAX 950
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -49,6 +75,9 @@ struct kernel_thread_frame
 static long long idle_ticks;    /* # of timer ticks spent idle. */
 static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
+static long long rt_throttle_cnt; /* # of real-time budget overruns. */
+static long long rt_miss_cnt;   /* # of real-time deadline misses. */
+static long long switch_cnt;    /* # of context switches. */
 
 /* Scheduling. */
 #define TIME_SLICE 4            /* # of timer ticks to give each thread. */
@@ -70,6 +99,9 @@ static void *alloc_frame (struct thread *, size_t size);
 static void schedule (void);
 void schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static void rt_make_ready (struct thread *);
+static void rt_replenish (int64_t now);
+static bool rt_preempts (struct thread *);
 
 /* Initializes the threading system by transforming the code
    that's currently running into a thread.  This can't work in
@@ -90,6 +122,9 @@ thread_init (void)
 
   lock_init (&tid_lock);
   list_init (&ready_list);
+  list_init (&all_list);
+  list_init (&rt_ready_list);
+  list_init (&rt_throttled_list);
 
   /* Set up a thread structure for the running thread. */
   initial_thread = running_thread ();
@@ -115,12 +150,14 @@ thread_start (void)
   sema_down (&idle_started);
 }
 
-/* Called by the timer interrupt handler at each timer tick.
+/* Called by the timer interrupt handler at each timer tick,
+   with the interrupted context F.
    Thus, this function runs in an external interrupt context. */
 void
-thread_tick (void) 
+thread_tick (struct intr_frame *f) 
 {
   struct thread *t = thread_current ();
+  struct usage *usage = thread_usage ();
 
   /* Update statistics. */
   if (t == idle_thread)
@@ -131,9 +168,40 @@ thread_tick (void)
 #endif
   else
     kernel_ticks++;
+  if ((f->cs & 3) == 3)
+    usage->user_ticks++;
+  else
+    usage->kernel_ticks++;
+
+  /* Charge real-time threads against their budget.  A real-time
+     thread still running at its deadline has missed it. */
+  if (t->rt_period > 0)
+    {
+      int64_t now = timer_ticks ();
+
+      if (now >= t->rt_deadline)
+        {
+          rt_miss_cnt++;
+          t->rt_deadline = now + t->rt_period;
+          t->rt_budget = t->rt_runtime;
+          t->rt_throttled = false;
+        }
+      if (--t->rt_budget <= 0)
+        {
+          rt_throttle_cnt++;
+          t->rt_throttled = true;
+          intr_yield_on_return ();
+        }
+    }
+
+  /* Start new periods for throttled real-time threads. */
+  if (!list_empty (&rt_throttled_list))
+    rt_replenish (timer_ticks ());
 
-  /* Enforce preemption. */
-  if (++thread_ticks >= TIME_SLICE)
+  /* Enforce preemption.  Real-time threads are not time-sliced,
+     but yield to real-time threads with earlier deadlines. */
+  if (rt_preempts (t)
+      || (t->rt_period == 0 && ++thread_ticks >= TIME_SLICE))
     intr_yield_on_return ();
 }
 
@@ -142,6 +210,28 @@ void
 thread_print_stats (void) 
 {
   printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n", idle_ticks, kernel_ticks, user_ticks);
+  if (rt_throttle_cnt > 0 || rt_miss_cnt > 0)
+    printf ("Thread: %lld real-time budget overruns, %lld deadline misses\n",
+            rt_throttle_cnt, rt_miss_cnt);
+}
+
+/* Fills in ST with current scheduler statistics. */
+void
+thread_get_stats (struct thread_stats *st) 
+{
+  enum intr_level old_level = intr_disable ();
+
+  st->idle_ticks = idle_ticks;
+  st->kernel_ticks = kernel_ticks;
+  st->user_ticks = user_ticks;
+  st->switch_cnt = switch_cnt;
+  st->rt_throttle_cnt = rt_throttle_cnt;
+  st->rt_miss_cnt = rt_miss_cnt;
+  st->thread_cnt = list_size (&all_list);
+  st->ready_cnt = list_size (&ready_list);
+  st->rt_ready_cnt = list_size (&rt_ready_list);
+  st->rt_throttled_cnt = list_size (&rt_throttled_list);
+  intr_set_level (old_level);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -165,6 +255,7 @@ thread_create (const char *name, int priority,
   struct kernel_thread_frame *kf;
   struct switch_entry_frame *ef;
   struct switch_threads_frame *sf;
+  char *cwd_path = NULL;
   tid_t tid;
 
   ASSERT (function != NULL);
@@ -180,6 +271,20 @@ thread_create (const char *name, int priority,
   if (t == NULL)
     return TID_ERROR;
 
+  /* The working directory's path goes with it, for mount lookups
+     (see filesys.c). */
+  if (thread_current ()->cwd_path != NULL)
+    {
+      size_t size = strlen (thread_current ()->cwd_path) + 1;
+      cwd_path = malloc (size);
+      if (cwd_path == NULL)
+        {
+          palloc_free_page (t);
+          return TID_ERROR;
+        }
+      strlcpy (cwd_path, thread_current ()->cwd_path, size);
+    }
+
   /* Initialize thread. */
   init_thread (t, name, priority);
   tid = t->tid = allocate_tid ();
@@ -189,6 +294,7 @@ thread_create (const char *name, int priority,
     t->curr_dir = dir_reopen(thread_current()->curr_dir);
   else
     t->curr_dir = NULL;
+  t->cwd_path = cwd_path;
 
   /* Stack frame for kernel_thread(). */
   kf = alloc_frame (t, sizeof *kf);
@@ -255,8 +361,27 @@ thread_unblock (struct thread *t)
 
   old_level = intr_disable ();
   ASSERT (t->status == THREAD_BLOCKED);
-  list_push_back (&ready_list, &t->elem);
-  t->status = THREAD_READY;
+  if (t->rt_period > 0)
+    {
+      /* A real-time thread that slept through its deadline
+         starts a new period, with a full budget, even if it had
+         been throttled in the last one. */
+      int64_t now = timer_ticks ();
+      if (now >= t->rt_deadline)
+        {
+          t->rt_deadline = now + t->rt_period;
+          t->rt_budget = t->rt_runtime;
+          t->rt_throttled = false;
+        }
+      rt_make_ready (t);
+      if (intr_context () && rt_preempts (thread_current ()))
+        intr_yield_on_return ();
+    }
+  else
+    {
+      list_push_back (&ready_list, &t->elem);
+      t->status = THREAD_READY;
+    }
   intr_set_level (old_level);
 }
 
@@ -293,6 +418,32 @@ thread_tid (void)
   return thread_current ()->tid;
 }
 
+/* Returns the resource usage to charge for work done by the
+   running thread: its process's, under USERPROG, so that all
+   the threads of a process share one set of counters. */
+struct usage *
+thread_usage (void) 
+{
+#ifdef USERPROG
+  return &thread_current ()->leader->usage;
+#else
+  return &thread_current ()->usage;
+#endif
+}
+
+/* Adds the resources counted in SRC to DST. */
+void
+usage_add (struct usage *dst, const struct usage *src) 
+{
+  dst->user_ticks += src->user_ticks;
+  dst->kernel_ticks += src->kernel_ticks;
+  dst->fault_cnt += src->fault_cnt;
+  dst->major_fault_cnt += src->major_fault_cnt;
+  dst->read_cnt += src->read_cnt;
+  dst->write_cnt += src->write_cnt;
+  dst->syscall_cnt += src->syscall_cnt;
+}
+
 /* Deschedules the current thread and destroys it.  Never
    returns to the caller. */
 void
@@ -305,14 +456,36 @@ thread_exit (void)
   process_exit ();
 #endif
 
+  thread_set_rt (0, 0);
+  fpu_release (thread_current ());
+  free (thread_current ()->cwd_path);
+
   /* Just set our status to dying and schedule another process.
      We will be destroyed during the call to schedule_tail(). */
   intr_disable ();
+  list_remove (&thread_current ()->allelem);
   thread_current ()->status = THREAD_DYING;
   schedule ();
   NOT_REACHED ();
 }
 
+/* Invokes FUNC for all threads, passing along AUX.
+   This function must be called with interrupts off. */
+void
+thread_foreach (thread_action_func *func, void *aux) 
+{
+  struct list_elem *e;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (e = list_begin (&all_list); e != list_end (&all_list);
+       e = list_next (e)) 
+    {
+      struct thread *t = list_entry (e, struct thread, allelem);
+      func (t, aux);
+    }
+}
+
 /* Yields the CPU.  The current thread is not put to sleep and
    may be scheduled again immediately at the scheduler's whim. */
 void
@@ -324,9 +497,79 @@ thread_yield (void)
   ASSERT (!intr_context ());
 
   old_level = intr_disable ();
-  if (curr != idle_thread) 
-    list_push_back (&ready_list, &curr->elem);
-  curr->status = THREAD_READY;
+  if (curr->rt_period > 0)
+    rt_make_ready (curr);
+  else
+    {
+      if (curr != idle_thread) 
+        list_push_back (&ready_list, &curr->elem);
+      curr->status = THREAD_READY;
+    }
+  schedule ();
+  intr_set_level (old_level);
+}
+
+/* Gives the current thread a real-time reservation of RUNTIME
+   timer ticks of CPU time in every PERIOD ticks, starting now,
+   or removes its reservation if RUNTIME is 0.  While it has
+   budget left in the current period, a real-time thread runs
+   ahead of all ordinary threads, and ahead of real-time threads
+   with later deadlines (the ends of their current periods).
+
+   Returns true if successful, false if the parameters are
+   invalid or admitting the reservation would overcommit the
+   CPU, in which case any previous reservation is kept. */
+bool
+thread_set_rt (int64_t runtime, int64_t period) 
+{
+  struct thread *curr = thread_current ();
+  enum intr_level old_level;
+  int old_util, new_util;
+  bool success = false;
+
+  if (runtime < 0 || (runtime > 0 && (period <= 0 || runtime > period)))
+    return false;
+
+  old_level = intr_disable ();
+  old_util = curr->rt_period > 0 ? DIV_ROUND_UP (curr->rt_runtime * 1000,
+                                                 curr->rt_period) : 0;
+  new_util = runtime > 0 ? DIV_ROUND_UP (runtime * 1000, period) : 0;
+  if (rt_util - old_util + new_util <= RT_UTIL_MAX)
+    {
+      rt_util += new_util - old_util;
+      curr->rt_runtime = runtime;
+      curr->rt_period = runtime > 0 ? period : 0;
+      curr->rt_deadline = timer_ticks () + period;
+      curr->rt_budget = runtime;
+      curr->rt_throttled = false;
+      success = true;
+    }
+  intr_set_level (old_level);
+
+  return success;
+}
+
+/* Gives up the rest of the current real-time thread's budget
+   and waits for its next period to begin.  Periodic tasks call
+   this when they finish the work for a period. */
+void
+thread_rt_wait (void) 
+{
+  struct thread *curr = thread_current ();
+  enum intr_level old_level;
+
+  ASSERT (!intr_context ());
+
+  if (curr->rt_period == 0)
+    {
+      thread_yield ();
+      return;
+    }
+
+  old_level = intr_disable ();
+  curr->rt_budget = 0;
+  curr->rt_throttled = true;
+  rt_make_ready (curr);
   schedule ();
   intr_set_level (old_level);
 }
@@ -448,6 +691,8 @@ is_thread (struct thread *t)
 static void
 init_thread (struct thread *t, const char *name, int priority)
 {
+  enum intr_level old_level;
+
   ASSERT (t != NULL);
   ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
   ASSERT (name != NULL);
@@ -463,6 +708,16 @@ init_thread (struct thread *t, const char *name, int priority)
   sema_init(&t->sema_exit, 0);
   list_init (&t->children);
   list_init (&t->files);
+#ifdef USERPROG
+  t->leader = t;
+  list_init (&t->uthreads);
+  lock_init (&t->uthread_lock);
+  sema_init (&t->uthread_sema, 0);
+#endif
+
+  old_level = intr_disable ();
+  list_push_back (&all_list, &t->allelem);
+  intr_set_level (old_level);
 }
 
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
@@ -486,12 +741,81 @@ alloc_frame (struct thread *t, size_t size)
 static struct thread *
 next_thread_to_run (void) 
 {
+  if (!list_empty (&rt_ready_list))
+    return list_entry (list_pop_front (&rt_ready_list), struct thread, elem);
   if (list_empty (&ready_list))
     return idle_thread;
   else
     return list_entry (list_pop_front (&ready_list), struct thread, elem);
 }
 
+/* Returns true if real-time thread A's deadline is earlier than
+   B's. */
+static bool
+deadline_less (const struct list_elem *a_, const struct list_elem *b_,
+               void *aux UNUSED) 
+{
+  const struct thread *a = list_entry (a_, struct thread, elem);
+  const struct thread *b = list_entry (b_, struct thread, elem);
+
+  return a->rt_deadline < b->rt_deadline;
+}
+
+/* Puts real-time thread T, which must be running or blocked, on
+   rt_ready_list, or on rt_throttled_list if it has no budget
+   left in its current period.  Interrupts must be off. */
+static void
+rt_make_ready (struct thread *t) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (t->rt_throttled)
+    {
+      list_insert_ordered (&rt_throttled_list, &t->elem, deadline_less, NULL);
+      t->status = THREAD_BLOCKED;
+    }
+  else
+    {
+      list_insert_ordered (&rt_ready_list, &t->elem, deadline_less, NULL);
+      t->status = THREAD_READY;
+    }
+}
+
+/* Starts a new period, with a full budget, for each throttled
+   real-time thread whose deadline has passed as of NOW. */
+static void
+rt_replenish (int64_t now) 
+{
+  while (!list_empty (&rt_throttled_list))
+    {
+      struct thread *t = list_entry (list_front (&rt_throttled_list),
+                                     struct thread, elem);
+      if (t->rt_deadline > now)
+        break;
+
+      list_pop_front (&rt_throttled_list);
+      t->rt_deadline += t->rt_period;
+      if (t->rt_deadline <= now)
+        t->rt_deadline = now + t->rt_period;
+      t->rt_budget = t->rt_runtime;
+      t->rt_throttled = false;
+      rt_make_ready (t);
+    }
+}
+
+/* Returns true if a ready real-time thread should run in place
+   of running thread T. */
+static bool
+rt_preempts (struct thread *t) 
+{
+  struct thread *next;
+
+  if (list_empty (&rt_ready_list))
+    return false;
+  next = list_entry (list_front (&rt_ready_list), struct thread, elem);
+  return t->rt_period == 0 || next->rt_deadline < t->rt_deadline;
+}
+
 /* Completes a thread switch by activating the new thread's page
    tables, and, if the previous thread is dying, destroying it.
    At this function's invocation, we just switched from thread
@@ -518,6 +842,9 @@ schedule_tail (struct thread *prev)
   /* Start new time slice. */
   thread_ticks = 0;
 
+  /* Trap the first FPU instruction unless our state is loaded. */
+  fpu_switch (curr);
+
 #ifdef USERPROG
   /* Activate the new address space. */
   process_activate ();
@@ -554,7 +881,11 @@ schedule (void)
   ASSERT (is_thread (next));
 
   if (curr != next)
-    prev = switch_threads (curr, next);
+    {
+      TRACE (TRACE_SWITCH, next->tid, curr->status);
+      switch_cnt++;
+      prev = switch_threads (curr, next);
+    }
   schedule_tail (prev); 
 }
 
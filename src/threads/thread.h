@@ -83,6 +83,8 @@ struct file_elem {
   char name[50];
   struct list_elem elem;
   struct dir *dir;
+  struct pipe *pipe;            /* Pipe end, if FILE is null. */
+  bool pipe_write;              /* Write end of PIPE? */
 };
 
 struct child_elem {
@@ -94,6 +96,19 @@ struct child_elem {
   struct list_elem elem;
 };
 
+/* Resources used by a thread, or under USERPROG by all the
+   threads of a process (see thread_usage()). */
+struct usage
+  {
+    int64_t user_ticks;                 /* Timer ticks in user mode. */
+    int64_t kernel_ticks;               /* Timer ticks in kernel mode. */
+    long fault_cnt;                     /* Page faults. */
+    long major_fault_cnt;               /* Page faults that did I/O. */
+    long read_cnt;                      /* Sectors read via the cache. */
+    long write_cnt;                     /* Sectors written via the cache. */
+    long syscall_cnt;                   /* System calls. */
+  };
+
 struct thread
   {
     /* Owned by thread.c. */
@@ -103,6 +118,18 @@ struct thread
     uint8_t *stack;                     /* Saved stack pointer. */
     int priority;                       /* Priority. */
 
+    /* Real-time reservation (see thread_set_rt()).  All times
+       are in timer ticks. */
+    int64_t rt_runtime;                 /* Budget per period, 0 if none. */
+    int64_t rt_period;                  /* Length of a period. */
+    int64_t rt_deadline;                /* End of the current period. */
+    int64_t rt_budget;                  /* Budget left in this period. */
+    bool rt_throttled;                  /* Out of budget until deadline. */
+
+    struct usage usage;                 /* Resources used. */
+
+    struct list_elem allelem;           /* List element for all threads list. */
+
     /* Shared between thread.c and synch.c. */
     struct list_elem elem;              /* List element. */
 
@@ -122,13 +149,27 @@ struct thread
     struct list files;
     struct file *program; // executable file을 저장.
     tid_t waiting;
+
+    /* Threads of a process (see process_spawn()).  The leader
+       is the thread that ran the executable's main(); the other
+       threads share its page directory and file descriptors. */
+    struct thread *leader;              /* Leader of our process. */
+    struct uthread *uthread;            /* Non-leaders: our record. */
+    struct list uthreads;               /* Leader: spawned threads. */
+    struct lock uthread_lock;           /* Leader: protects uthreads. */
+    struct semaphore uthread_sema;      /* Leader: all threads done. */
+    int uthread_cnt;                    /* Leader: live spawned threads. */
+    bool exiting;                       /* Leader: process is exiting. */
+    struct usage child_usage;           /* Leader: exited children. */
 #endif
 
     /* Owned by thread.c. */
     void* esp;
+    struct fpu_state *fpu;              /* Saved FPU state (see fpu.c). */
     unsigned magic;                     /* Detects stack overflow. */
 
     struct dir *curr_dir;
+    char *cwd_path;                     /* Path of curr_dir, or null for "/". */
   };
 
 /* If false (default), use round-robin scheduler.
@@ -141,9 +182,27 @@ int64_t time_to_wakeup (void);
 void thread_init (void);
 void thread_start (void);
 
-void thread_tick (void);
+struct intr_frame;
+void thread_tick (struct intr_frame *);
 void thread_print_stats (void);
 
+/* Scheduler statistics. */
+struct thread_stats
+  {
+    long long idle_ticks;       /* Timer ticks spent idle. */
+    long long kernel_ticks;     /* Timer ticks in kernel threads. */
+    long long user_ticks;       /* Timer ticks in user programs. */
+    long long switch_cnt;       /* Context switches. */
+    long long rt_throttle_cnt;  /* Real-time budget overruns. */
+    long long rt_miss_cnt;      /* Real-time deadline misses. */
+    size_t thread_cnt;          /* Threads in existence. */
+    size_t ready_cnt;           /* Threads on the ready queue. */
+    size_t rt_ready_cnt;        /* Real-time threads ready to run. */
+    size_t rt_throttled_cnt;    /* Real-time threads out of budget. */
+  };
+
+void thread_get_stats (struct thread_stats *);
+
 typedef void thread_func (void *aux);
 tid_t thread_create (const char *name, int priority, thread_func *, void *);
 
@@ -157,6 +216,16 @@ const char *thread_name (void);
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
 
+/* Performs some operation on thread T, given auxiliary data AUX. */
+typedef void thread_action_func (struct thread *t, void *aux);
+void thread_foreach (thread_action_func *, void *);
+
+struct usage *thread_usage (void);
+void usage_add (struct usage *, const struct usage *);
+
+bool thread_set_rt (int64_t runtime, int64_t period);
+void thread_rt_wait (void);
+
 int thread_get_priority (void);
 void thread_set_priority (int);
 
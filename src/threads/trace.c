@@ -0,0 +1,160 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/clock.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/thread-names.h"
+#include "threads/vaddr.h"
+
+/* Kernel event tracing.
+
+   When enabled with "-o trace[=PAGES]", tracepoints throughout
+   the kernel append fixed-size binary records to a ring buffer
+   of PAGES pages allocated at boot.  Each record carries a
+   timestamp from the high-resolution clock, the running thread,
+   the event type, and two event-specific arguments.  Once the
+   ring is full the oldest records are overwritten, so the
+   buffer always holds the most recent history.
+
+   Recording an event never allocates memory, never blocks, and
+   takes only a few dozen instructions with interrupts disabled,
+   so tracepoints may be placed in interrupt handlers and in the
+   scheduler.  trace_dump() prints the buffer to the console at
+   power off, where utils/pintos-trace decodes it into a
+   timeline. */
+
+/* One event record. */
+struct trace_rec
+  {
+    uint64_t time;              /* clock_read() when recorded. */
+    tid_t tid;                  /* Running thread. */
+    uint32_t event;             /* enum trace_event. */
+    uint32_t arg0, arg1;        /* Event-specific arguments. */
+  };
+
+/* Names of the events and of their arguments, printed in the
+   dump header so that the decoder needn't hard-code them. */
+static const char *event_names[TRACE_EVENT_CNT][3] =
+  {
+    [TRACE_SWITCH] = {"switch", "next", "status"},
+    [TRACE_PAGE_FAULT] = {"page-fault", "addr", "error"},
+    [TRACE_FRAME_EVICT] = {"frame-evict", "kpage", "upage"},
+    [TRACE_SWAP_IN] = {"swap-in", "slot", "kpage"},
+    [TRACE_SWAP_OUT] = {"swap-out", "slot", "kpage"},
+    [TRACE_CACHE_HIT] = {"cache-hit", "sector", "write"},
+    [TRACE_CACHE_MISS] = {"cache-miss", "sector", "write"},
+    [TRACE_DISK_CMD] = {"disk-cmd", "sector", "disk"},
+    [TRACE_DISK_DONE] = {"disk-done", "channel", "-"},
+    [TRACE_SYSCALL_ENTER] = {"syscall-enter", "nr", "eip"},
+    [TRACE_SYSCALL_EXIT] = {"syscall-exit", "nr", "result"},
+  };
+
+/* Default size of the ring buffer, in pages. */
+#define TRACE_DEFAULT_PAGES 64
+
+bool trace_enabled;
+
+static int requested_pages;     /* Size requested by "-o trace". */
+static struct trace_rec *ring;  /* Ring buffer. */
+static size_t ring_cnt;         /* Capacity of ring, in records. */
+static uint64_t recorded_cnt;   /* Number of events ever recorded. */
+
+static struct thread_names names; /* Threads seen in switches. */
+
+/* Requests a trace buffer of PAGES pages, or the default size if
+   PAGES is 0, which takes effect when trace_init() is called. */
+void
+trace_configure (int pages) 
+{
+  requested_pages = pages > 0 ? pages : TRACE_DEFAULT_PAGES;
+}
+
+/* Allocates the ring buffer and starts recording, if tracing was
+   requested.  Must be called after clock_init(), so that the
+   timestamps all come from the same clock. */
+void
+trace_init (void) 
+{
+  if (requested_pages == 0)
+    return;
+
+  ring = palloc_get_multiple (0, requested_pages);
+  if (ring == NULL)
+    {
+      printf ("Trace: out of memory, not tracing.\n");
+      return;
+    }
+  ring_cnt = requested_pages * PGSIZE / sizeof *ring;
+  thread_names_add (&names, thread_current ());
+  trace_enabled = true;
+  printf ("Trace: recording up to %zu events.\n", ring_cnt);
+}
+
+/* Records EVENT with arguments ARG0 and ARG1.  Use the TRACE
+   macro instead of calling this directly. */
+void
+trace_record (enum trace_event event, uint32_t arg0, uint32_t arg1) 
+{
+  struct thread *t = thread_current ();
+  struct trace_rec *r;
+  enum intr_level old_level;
+
+  ASSERT (event < TRACE_EVENT_CNT);
+
+  old_level = intr_disable ();
+  r = &ring[recorded_cnt++ % ring_cnt];
+  r->time = clock_read ();
+  r->tid = t->tid;
+  r->event = event;
+  r->arg0 = arg0;
+  r->arg1 = arg1;
+
+  /* Every thread that runs eventually switches away, even to
+     exit, so this catches all their names. */
+  if (event == TRACE_SWITCH)
+    thread_names_add (&names, t);
+  intr_set_level (old_level);
+}
+
+/* Stops recording and prints the events in the ring buffer,
+   oldest first, in the form understood by utils/pintos-trace:
+
+        Trace: N events at FREQ Hz, D overwritten
+        TRACE-EVENT ID NAME ARG0 ARG1
+        ...
+        TRACE-THREAD TID NAME
+        ...
+        TRACE TIME TID ID ARG0 ARG1
+        ...
+        Trace: end
+
+   TIME is in clock cycles; the arguments are in hex. */
+void
+trace_dump (void) 
+{
+  uint64_t first, i;
+  size_t e;
+
+  if (ring == NULL)
+    return;
+  trace_enabled = false;
+  thread_names_add (&names, thread_current ());
+
+  first = recorded_cnt > ring_cnt ? recorded_cnt - ring_cnt : 0;
+  printf ("Trace: %"PRIu64" events at %"PRIu64" Hz, %"PRIu64
+          " overwritten\n", recorded_cnt - first, clock_freq (), first);
+  for (e = 0; e < TRACE_EVENT_CNT; e++)
+    printf ("TRACE-EVENT %zu %s %s %s\n", e, event_names[e][0],
+            event_names[e][1], event_names[e][2]);
+  thread_names_print (&names, "TRACE-THREAD");
+  for (i = first; i < recorded_cnt; i++)
+    {
+      const struct trace_rec *r = &ring[i % ring_cnt];
+      printf ("TRACE %"PRIu64" %d %"PRIu32" %"PRIx32" %"PRIx32"\n",
+              r->time, r->tid, r->event, r->arg0, r->arg1);
+    }
+  printf ("Trace: end\n");
+}
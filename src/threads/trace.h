@@ -0,0 +1,46 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Kernel event types.  utils/pintos-trace learns their names
+   from the header that trace_dump() prints, so new events only
+   need to be added here and to the table in trace.c. */
+enum trace_event
+  {
+    TRACE_SWITCH,               /* Context switch: next tid, prev status. */
+    TRACE_PAGE_FAULT,           /* Page fault: address, error code. */
+    TRACE_FRAME_EVICT,          /* Frame eviction: kpage, upage. */
+    TRACE_SWAP_IN,              /* Swap in: slot, kpage. */
+    TRACE_SWAP_OUT,             /* Swap out: slot, kpage. */
+    TRACE_CACHE_HIT,            /* Buffer cache hit: sector, write? */
+    TRACE_CACHE_MISS,           /* Buffer cache miss: sector, write? */
+    TRACE_DISK_CMD,             /* Disk command issued: sector, disk/cmd. */
+    TRACE_DISK_DONE,            /* Disk command complete: channel. */
+    TRACE_SYSCALL_ENTER,        /* System call entry: number, user eip. */
+    TRACE_SYSCALL_EXIT,         /* System call exit: number, result. */
+    TRACE_EVENT_CNT
+  };
+
+/* True while events are being recorded.  Tested inline by
+   TRACE so that a disabled tracepoint costs one load and one
+   branch. */
+extern bool trace_enabled;
+
+/* Records EVENT with arguments ARG0 and ARG1, if tracing is
+   enabled. */
+#define TRACE(EVENT, ARG0, ARG1)                                        \
+        do                                                              \
+          {                                                             \
+            if (trace_enabled)                                          \
+              trace_record (EVENT, (uint32_t) (ARG0), (uint32_t) (ARG1)); \
+          }                                                             \
+        while (0)
+
+void trace_configure (int pages);
+void trace_init (void);
+void trace_record (enum trace_event, uint32_t arg0, uint32_t arg1);
+void trace_dump (void);
+
+#endif /* threads/trace.h */
@@ -0,0 +1,389 @@
+#include "userprog/aio.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Asynchronous file I/O.
+
+   aio_submit() queues a read or write and returns at once.  A
+   pool of kernel worker threads carries out queued requests in
+   order, but since each one blocks for its own disk I/O, they
+   can finish out of order.  aio_wait() returns a process's
+   finished requests one at a time, in the order they finish.
+
+   A worker reaches the process's buffer through the kernel
+   addresses of its pages, a page at a time, since it does not
+   run on the process's page directory.  It works on its own
+   struct file, opened with file_reopen(), so the process may
+   close its descriptor or move its file position in the
+   meantime.  Like the read and write system calls, it holds
+   file_lock while it uses the file system, but only for a page
+   at a time, so that other workers and processes get a turn.
+
+   A worker looks up each page's kernel address with aio_lock
+   held, and then uses it while blocked on file_lock and the
+   disk.  Until the request finishes, that page must stay mapped
+   at the same kernel page, so code that unmaps a user page or
+   gives it to another process first takes aio_lock with
+   aio_lock_pages() and checks aio_page_busy(): shm_detach()
+   refuses, ipc copies instead of moving the page, and an
+   exiting thread waits with aio_wait_page() before freeing its
+   stack. */
+
+/* Number of worker threads. */
+#define AIO_WORKERS 4
+
+/* States of a request. */
+enum aio_state
+  {
+    AIO_QUEUED,                 /* Waiting for a worker. */
+    AIO_RUNNING,                /* Being carried out. */
+    AIO_DONE                    /* Waiting for aio_wait(). */
+  };
+
+/* A request. */
+struct aio_request
+  {
+    struct list_elem elem;      /* Element in requests. */
+    struct thread *owner;       /* Leader of the submitting process. */
+    struct aiocb *cb;           /* User's control block. */
+    enum aio_state state;       /* Progress. */
+    struct file *file;          /* File to use. */
+    int op;                     /* AIO_READ or AIO_WRITE. */
+    uint8_t *buffer;            /* User address of data. */
+    unsigned size;              /* Number of bytes. */
+    unsigned offset;            /* File offset. */
+    int result;                 /* Bytes transferred, once done. */
+  };
+
+static struct list requests;    /* All requests, oldest first. */
+static struct lock aio_lock;    /* Protects requests. */
+static struct condition queued; /* Signaled when a request is queued. */
+static struct condition done;   /* Signaled when a request is done. */
+
+extern struct lock file_lock;
+
+static thread_func worker NO_RETURN;
+static int count_requests (struct thread *owner, bool running_only);
+static bool uses_page (const struct aio_request *, const void *upage);
+static void release (struct aio_request *);
+
+/* Initializes asynchronous I/O and starts the worker threads. */
+void
+aio_init (void)
+{
+  int i;
+
+  list_init (&requests);
+  lock_init (&aio_lock);
+  cond_init (&queued);
+  cond_init (&done);
+
+  for (i = 0; i < AIO_WORKERS; i++)
+    {
+      char name[16];
+      snprintf (name, sizeof name, "aio%d", i);
+      thread_create (name, PRI_DEFAULT, worker, NULL);
+    }
+}
+
+/* Queues operation OP, AIO_READ or AIO_WRITE, on SIZE bytes at
+   user address BUFFER and OFFSET bytes into FILE, for the
+   current process.  CB identifies the request to aio_wait().
+   Returns false if the process has too many requests
+   outstanding or memory is exhausted. */
+bool
+aio_submit (struct aiocb *cb, struct file *file, int op, void *buffer,
+            unsigned size, unsigned offset)
+{
+  struct thread *t = thread_current ()->leader;
+  struct aio_request *r;
+
+  ASSERT (op == AIO_READ || op == AIO_WRITE);
+
+  r = malloc (sizeof *r);
+  if (r == NULL)
+    return false;
+
+  lock_acquire (&file_lock);
+  r->file = file_reopen (file);
+  lock_release (&file_lock);
+  if (r->file == NULL)
+    {
+      free (r);
+      return false;
+    }
+  r->owner = t;
+  r->cb = cb;
+  r->state = AIO_QUEUED;
+  r->op = op;
+  r->buffer = buffer;
+  r->size = size;
+  r->offset = offset;
+  r->result = -1;
+
+  lock_acquire (&aio_lock);
+  if (count_requests (t, false) >= AIO_MAX)
+    {
+      lock_release (&aio_lock);
+      release (r);
+      return false;
+    }
+  list_push_back (&requests, &r->elem);
+  cond_signal (&queued, &aio_lock);
+  lock_release (&aio_lock);
+  return true;
+}
+
+/* Waits for one of the current process's requests to finish,
+   stores its result in *RESULT, and returns its control block.
+   Returns a null pointer at once if the process has no requests
+   outstanding, or as soon as it starts to exit. */
+struct aiocb *
+aio_wait (int *result)
+{
+  struct thread *t = thread_current ()->leader;
+  struct aio_request *found = NULL;
+  struct aiocb *cb = NULL;
+
+  lock_acquire (&aio_lock);
+  while (count_requests (t, false) > 0)
+    {
+      struct list_elem *e;
+
+      for (e = list_begin (&requests); e != list_end (&requests);
+           e = list_next (e))
+        {
+          struct aio_request *r = list_entry (e, struct aio_request, elem);
+          if (r->owner == t && r->state == AIO_DONE)
+            {
+              list_remove (&r->elem);
+              found = r;
+              break;
+            }
+        }
+      if (found != NULL || t->exiting)
+        break;
+      cond_wait (&done, &aio_lock);
+    }
+  lock_release (&aio_lock);
+
+  /* release() takes file_lock, which must not be taken with
+     aio_lock held. */
+  if (found != NULL)
+    {
+      cb = found->cb;
+      *result = found->result;
+      release (found);
+    }
+  return cb;
+}
+
+/* Discards the current process's requests, which is exiting.
+   Waits for those being carried out, since they use its
+   pages. */
+void
+aio_exit (void)
+{
+  struct thread *t = thread_current ()->leader;
+  struct list discarded;
+  struct list_elem *e;
+
+  list_init (&discarded);
+  lock_acquire (&aio_lock);
+  while (count_requests (t, true) > 0)
+    cond_wait (&done, &aio_lock);
+  for (e = list_begin (&requests); e != list_end (&requests); )
+    {
+      struct aio_request *r = list_entry (e, struct aio_request, elem);
+      e = list_next (e);
+      if (r->owner == t)
+        {
+          list_remove (&r->elem);
+          list_push_back (&discarded, &r->elem);
+        }
+    }
+  lock_release (&aio_lock);
+
+  while (!list_empty (&discarded))
+    release (list_entry (list_pop_front (&discarded),
+                         struct aio_request, elem));
+}
+
+/* Wakes the threads waiting in aio_wait(), so that those whose
+   process is exiting can give up. */
+void
+aio_interrupt (void)
+{
+  lock_acquire (&aio_lock);
+  cond_broadcast (&done, &aio_lock);
+  lock_release (&aio_lock);
+}
+
+/* Acquires the lock under which workers look up the kernel
+   addresses of buffer pages.  Hold it from checking a page with
+   aio_page_busy() until the page has been unmapped or moved. */
+void
+aio_lock_pages (void)
+{
+  lock_acquire (&aio_lock);
+}
+
+/* Releases the lock acquired by aio_lock_pages(). */
+void
+aio_unlock_pages (void)
+{
+  lock_release (&aio_lock);
+}
+
+/* Returns true if user page UPAGE of the process led by T is
+   part of the buffer of a request that has not finished, so
+   that it must not be unmapped or moved.  The caller must hold
+   the lock from aio_lock_pages(). */
+bool
+aio_page_busy (struct thread *t, const void *upage)
+{
+  struct list_elem *e;
+
+  ASSERT (lock_held_by_current_thread (&aio_lock));
+
+  for (e = list_begin (&requests); e != list_end (&requests);
+       e = list_next (e))
+    {
+      struct aio_request *r = list_entry (e, struct aio_request, elem);
+      if (r->owner == t && r->state != AIO_DONE && uses_page (r, upage))
+        return true;
+    }
+  return false;
+}
+
+/* Waits until aio_page_busy(T, UPAGE) is false.  The caller
+   must hold the lock from aio_lock_pages(), and still holds it
+   on return. */
+void
+aio_wait_page (struct thread *t, const void *upage)
+{
+  while (aio_page_busy (t, upage))
+    cond_wait (&done, &aio_lock);
+}
+
+/* Returns the number of requests owned by OWNER that are being
+   carried out, or if RUNNING_ONLY is false, that have not been
+   returned by aio_wait(). */
+static int
+count_requests (struct thread *owner, bool running_only)
+{
+  struct list_elem *e;
+  int cnt = 0;
+
+  ASSERT (lock_held_by_current_thread (&aio_lock));
+
+  for (e = list_begin (&requests); e != list_end (&requests);
+       e = list_next (e))
+    {
+      struct aio_request *r = list_entry (e, struct aio_request, elem);
+      if (r->owner == owner
+          && (!running_only || r->state == AIO_RUNNING))
+        cnt++;
+    }
+  return cnt;
+}
+
+/* Returns true if R's buffer includes part of user page
+   UPAGE. */
+static bool
+uses_page (const struct aio_request *r, const void *upage)
+{
+  const uint8_t *first = pg_round_down (r->buffer);
+
+  return r->size > 0
+         && (const uint8_t *) upage >= first
+         && (const uint8_t *) upage < r->buffer + r->size;
+}
+
+/* Closes R's file and frees R. */
+static void
+release (struct aio_request *r)
+{
+  lock_acquire (&file_lock);
+  file_close (r->file);
+  lock_release (&file_lock);
+  free (r);
+}
+
+/* Carries out request R, a page of its buffer at a time, and
+   returns the number of bytes transferred. */
+static int
+perform (struct aio_request *r)
+{
+  uint32_t *pd = r->owner->pagedir;
+  unsigned ofs = 0;
+
+  while (ofs < r->size)
+    {
+      unsigned chunk = PGSIZE - pg_ofs (r->buffer + ofs);
+      uint8_t *kaddr;
+      off_t n;
+
+      /* Once we have the kernel address, the page stays put until
+         R is done; see aio_page_busy(). */
+      lock_acquire (&aio_lock);
+      kaddr = pagedir_get_page (pd, r->buffer + ofs);
+      lock_release (&aio_lock);
+      if (kaddr == NULL)
+        break;
+      if (chunk > r->size - ofs)
+        chunk = r->size - ofs;
+      lock_acquire (&file_lock);
+      if (r->op == AIO_READ)
+        n = file_read_at (r->file, kaddr, chunk, r->offset + ofs);
+      else
+        n = file_write_at (r->file, kaddr, chunk, r->offset + ofs);
+      lock_release (&file_lock);
+      ofs += n;
+      if (n < (off_t) chunk)
+        break;
+    }
+  return ofs;
+}
+
+/* A worker thread: carries out queued requests, oldest first,
+   forever. */
+static void
+worker (void *aux UNUSED)
+{
+  lock_acquire (&aio_lock);
+  for (;;)
+    {
+      struct aio_request *r = NULL;
+      struct list_elem *e;
+
+      for (e = list_begin (&requests); e != list_end (&requests);
+           e = list_next (e))
+        if (list_entry (e, struct aio_request, elem)->state == AIO_QUEUED)
+          {
+            r = list_entry (e, struct aio_request, elem);
+            break;
+          }
+      if (r == NULL)
+        {
+          cond_wait (&queued, &aio_lock);
+          continue;
+        }
+
+      /* aio_exit() waits for running requests before it frees R,
+         and until R is done its pages stay mapped. */
+      r->state = AIO_RUNNING;
+      lock_release (&aio_lock);
+      r->result = perform (r);
+      lock_acquire (&aio_lock);
+      r->state = AIO_DONE;
+      cond_broadcast (&done, &aio_lock);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef USERPROG_AIO_H
+#define USERPROG_AIO_H
+
+#include <aio.h>
+#include <stdbool.h>
+
+struct file;
+struct thread;
+
+/* Maximum number of requests a process may have outstanding,
+   counting completed ones that aio_wait() has not returned. */
+#define AIO_MAX 16
+
+void aio_init (void);
+bool aio_submit (struct aiocb *, struct file *, int op, void *buffer,
+                 unsigned size, unsigned offset);
+struct aiocb *aio_wait (int *result);
+void aio_exit (void);
+void aio_interrupt (void);
+
+void aio_lock_pages (void);
+void aio_unlock_pages (void);
+bool aio_page_busy (struct thread *, const void *upage);
+void aio_wait_page (struct thread *, const void *upage);
+
+#endif /* userprog/aio.h */
@@ -2,14 +2,17 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "threads/fpu.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static void device_not_available (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -45,8 +48,6 @@ exception_init (void)
   intr_register_int (0, 0, INTR_ON, kill, "#DE Divide Error");
   intr_register_int (1, 0, INTR_ON, kill, "#DB Debug Exception");
   intr_register_int (6, 0, INTR_ON, kill, "#UD Invalid Opcode Exception");
-  intr_register_int (7, 0, INTR_ON, kill,
-                     "#NM Device Not Available Exception");
   intr_register_int (11, 0, INTR_ON, kill, "#NP Segment Not Present");
   intr_register_int (12, 0, INTR_ON, kill, "#SS Stack Fault Exception");
   intr_register_int (13, 0, INTR_ON, kill, "#GP General Protection Exception");
@@ -58,6 +59,11 @@ exception_init (void)
      We need to disable interrupts for page faults because the
      fault address is stored in CR2 and needs to be preserved. */
   intr_register_int (14, 0, INTR_OFF, page_fault, "#PF Page-Fault Exception");
+
+  /* #NM is how we switch FPU state lazily.  Interrupts must be
+     off so that the FPU owner can't change under us. */
+  intr_register_int (7, 0, INTR_OFF, device_not_available,
+                     "#NM Device Not Available Exception");
 }
 
 /* Prints exception statistics. */
@@ -67,6 +73,13 @@ exception_print_stats (void)
   printf ("Exception: %lld page faults\n", page_fault_cnt);
 }
 
+/* Returns the number of page faults since boot. */
+long long
+exception_page_fault_cnt (void) 
+{
+  return page_fault_cnt;
+}
+
 /* Handler for an exception (probably) caused by a user process. */
 static void
 kill (struct intr_frame *f) 
@@ -144,6 +157,8 @@ page_fault (struct intr_frame *f)
 
   /* Count page faults. */
   page_fault_cnt++;
+  thread_usage ()->fault_cnt++;
+  TRACE (TRACE_PAGE_FAULT, fault_addr, f->error_code);
 
   /* Determine cause. */
   not_present = (f->error_code & PF_P) == 0;
@@ -161,3 +176,14 @@ page_fault (struct intr_frame *f)
   kill (f);
 }
 
+/* #NM handler.  A user process executed an FPU or SSE
+   instruction while CR0.TS was set, so load its FPU state and
+   let it retry the instruction.  Anything else is handled like
+   other unexpected exceptions. */
+static void
+device_not_available (struct intr_frame *f) 
+{
+  if (f->cs == SEL_UCSEG && fpu_trap ())
+    return;
+  kill (f);
+}
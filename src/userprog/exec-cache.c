@@ -0,0 +1,328 @@
+#include "userprog/exec-cache.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Cache of parsed executables.
+
+   load() parses an executable's ELF headers into a struct
+   exec_image and, while reading its segments, copies the file
+   data of each page into kernel pages owned by the image.  Once
+   the load succeeds the image is inserted here, so that the next
+   exec of the same inode can skip parsing and validation and
+   copy page contents from memory instead of reading the file.
+
+   An image is dropped as soon as its inode is written or
+   removed (see inode_write_at() and inode_remove()).  An image
+   being loaded from holds a reference, so it is freed only once
+   the last loader releases it.  A new image that is still being
+   parsed is kept on a separate list, so that a write to its
+   inode before it is inserted marks it stale and keeps it out
+   of the cache: load() does not hold file_lock, so it may have
+   read part of the old contents and part of the new.
+
+   The cache only borrows kernel pool pages: it takes none while
+   the pool runs low, evicting older images instead if that
+   frees enough, and exec_cache_flush() empties it when an
+   allocation that can't wait fails. */
+
+/* Maximum number of images cached. */
+#define EXEC_CACHE_SIZE 16
+
+/* Maximum number of kernel pages holding file data, across all
+   cached images. */
+#define EXEC_CACHE_PAGES 32
+
+/* The cache takes no page from the kernel pool while fewer than
+   1/EXEC_CACHE_RESERVE of the pool's pages are free, so that it
+   never crowds out the rest of the kernel. */
+#define EXEC_CACHE_RESERVE 4
+
+static struct list images;      /* Cached images, most recent first. */
+static struct list new_images;  /* Images not yet inserted. */
+static struct lock cache_lock;  /* Protects everything here. */
+static size_t page_cnt;         /* Kernel pages held by all images. */
+
+/* Statistics. */
+static long long hit_cnt;       /* Lookups that found an image. */
+static long long miss_cnt;      /* Lookups that did not. */
+
+static void release (struct exec_image *);
+static bool evict (void);
+static bool kernel_pool_low (void);
+
+/* Initializes the executable cache. */
+void
+exec_cache_init (void) 
+{
+  list_init (&images);
+  list_init (&new_images);
+  lock_init (&cache_lock);
+}
+
+/* Prints executable cache statistics. */
+void
+exec_cache_print_stats (void) 
+{
+  printf ("Exec cache: %lld hits, %lld misses\n", hit_cnt, miss_cnt);
+}
+
+/* Returns a new, empty image for the executable in inode
+   INUMBER, with a reference held by the caller, or a null
+   pointer if memory is exhausted. */
+struct exec_image *
+exec_image_create (disk_sector_t inumber) 
+{
+  struct exec_image *image = calloc (1, sizeof *image);
+  if (image != NULL)
+    {
+      image->inumber = inumber;
+      image->ref_cnt = 1;
+      image->is_new = true;
+      lock_acquire (&cache_lock);
+      list_push_back (&new_images, &image->elem);
+      lock_release (&cache_lock);
+    }
+  return image;
+}
+
+/* Appends SEG to IMAGE, which must not yet be cached.  Returns
+   false if memory is exhausted. */
+bool
+exec_image_add_segment (struct exec_image *image,
+                        const struct exec_segment *seg) 
+{
+  struct exec_segment *segments;
+
+  ASSERT (image->pages == NULL);
+
+  segments = realloc (image->segments,
+                      (image->segment_cnt + 1) * sizeof *segments);
+  if (segments == NULL)
+    return false;
+  image->segments = segments;
+  image->segments[image->segment_cnt++] = *seg;
+  image->page_cnt += (seg->read_bytes + seg->zero_bytes) / PGSIZE;
+  return true;
+}
+
+/* Returns the cached file data for page PAGE_IDX of IMAGE,
+   counting pages across all of its segments in order, or a null
+   pointer if it was not cached. */
+const uint8_t *
+exec_image_get_page (struct exec_image *image, size_t page_idx) 
+{
+  ASSERT (page_idx < image->page_cnt);
+
+  return image->pages != NULL ? image->pages[page_idx] : NULL;
+}
+
+/* Remembers the SIZE bytes of file DATA in page PAGE_IDX of
+   IMAGE, which must not yet be cached, if the page budget and
+   the kernel pool allow. */
+void
+exec_image_put_page (struct exec_image *image, size_t page_idx,
+                     const void *data, size_t size) 
+{
+  uint8_t *kpage;
+
+  ASSERT (page_idx < image->page_cnt);
+  ASSERT (size <= PGSIZE);
+
+  if (size == 0)
+    return;
+  if (image->pages == NULL)
+    {
+      image->pages = calloc (image->page_cnt, sizeof *image->pages);
+      if (image->pages == NULL)
+        return;
+    }
+
+  lock_acquire (&cache_lock);
+  while ((page_cnt >= EXEC_CACHE_PAGES || kernel_pool_low ()) && evict ())
+    continue;
+  kpage = NULL;
+  if (page_cnt < EXEC_CACHE_PAGES && !kernel_pool_low ())
+    kpage = palloc_get_page (0);
+  if (kpage != NULL)
+    page_cnt++;
+  lock_release (&cache_lock);
+
+  if (kpage != NULL)
+    {
+      memcpy (kpage, data, size);
+      image->pages[page_idx] = kpage;
+    }
+}
+
+/* Looks up the image for inode INUMBER.  If found, returns it
+   with a reference held by the caller, who must release it with
+   exec_cache_release().  Otherwise returns a null pointer. */
+struct exec_image *
+exec_cache_lookup (disk_sector_t inumber) 
+{
+  struct list_elem *e;
+
+  lock_acquire (&cache_lock);
+  for (e = list_begin (&images); e != list_end (&images); e = list_next (e))
+    {
+      struct exec_image *image = list_entry (e, struct exec_image, elem);
+      if (image->inumber == inumber)
+        {
+          list_remove (&image->elem);
+          list_push_front (&images, &image->elem);
+          image->ref_cnt++;
+          hit_cnt++;
+          lock_release (&cache_lock);
+          return image;
+        }
+    }
+  miss_cnt++;
+  lock_release (&cache_lock);
+  return NULL;
+}
+
+/* Adds IMAGE, which was fully and successfully loaded, to the
+   cache, replacing any older image of the same inode, unless its
+   inode was written while it was being loaded.  The caller's
+   reference is unaffected. */
+void
+exec_cache_insert (struct exec_image *image) 
+{
+  struct list_elem *e;
+
+  ASSERT (image->is_new);
+
+  lock_acquire (&cache_lock);
+  list_remove (&image->elem);
+  image->is_new = false;
+  if (image->stale)
+    {
+      lock_release (&cache_lock);
+      return;
+    }
+
+  for (e = list_begin (&images); e != list_end (&images); e = list_next (e))
+    {
+      struct exec_image *old = list_entry (e, struct exec_image, elem);
+      if (old->inumber == image->inumber)
+        {
+          list_remove (&old->elem);
+          release (old);
+          break;
+        }
+    }
+  image->ref_cnt++;
+  list_push_front (&images, &image->elem);
+  if (list_size (&images) > EXEC_CACHE_SIZE)
+    evict ();
+  lock_release (&cache_lock);
+}
+
+/* Releases the caller's reference to IMAGE. */
+void
+exec_cache_release (struct exec_image *image) 
+{
+  if (image == NULL)
+    return;
+
+  lock_acquire (&cache_lock);
+  release (image);
+  lock_release (&cache_lock);
+}
+
+/* Drops the image of inode INUMBER, if any, from the cache, and
+   keeps any image of it still being loaded from being inserted.
+   Called whenever the inode is modified or removed. */
+void
+exec_cache_invalidate (disk_sector_t inumber) 
+{
+  struct list_elem *e;
+
+  lock_acquire (&cache_lock);
+  for (e = list_begin (&new_images); e != list_end (&new_images);
+       e = list_next (e))
+    {
+      struct exec_image *image = list_entry (e, struct exec_image, elem);
+      if (image->inumber == inumber)
+        image->stale = true;
+    }
+  for (e = list_begin (&images); e != list_end (&images); e = list_next (e))
+    {
+      struct exec_image *image = list_entry (e, struct exec_image, elem);
+      if (image->inumber == inumber)
+        {
+          list_remove (&image->elem);
+          release (image);
+          break;
+        }
+    }
+  lock_release (&cache_lock);
+}
+
+/* Drops every image from the cache, giving its pages back to
+   the kernel pool once no loader is using them.  Called when a
+   kernel page allocation fails. */
+void
+exec_cache_flush (void) 
+{
+  lock_acquire (&cache_lock);
+  while (evict ())
+    continue;
+  lock_release (&cache_lock);
+}
+
+/* Drops a reference to IMAGE, freeing it if it was the last.
+   cache_lock must be held. */
+static void
+release (struct exec_image *image) 
+{
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&cache_lock));
+  ASSERT (image->ref_cnt > 0);
+
+  if (--image->ref_cnt > 0)
+    return;
+
+  if (image->is_new)
+    list_remove (&image->elem);
+  if (image->pages != NULL)
+    {
+      for (i = 0; i < image->page_cnt; i++)
+        if (image->pages[i] != NULL)
+          {
+            palloc_free_page (image->pages[i]);
+            page_cnt--;
+          }
+      free (image->pages);
+    }
+  free (image->segments);
+  free (image);
+}
+
+/* Drops the least recently used image from the cache.  Returns
+   false if the cache was already empty.  cache_lock must be
+   held. */
+static bool
+evict (void) 
+{
+  if (list_empty (&images))
+    return false;
+  release (list_entry (list_pop_back (&images), struct exec_image, elem));
+  return true;
+}
+
+/* Returns true if the kernel pool is short of free pages. */
+static bool
+kernel_pool_low (void) 
+{
+  size_t free_cnt, pool_cnt;
+
+  palloc_get_stats (0, &free_cnt, &pool_cnt);
+  return free_cnt < pool_cnt / EXEC_CACHE_RESERVE;
+}
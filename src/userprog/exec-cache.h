@@ -0,0 +1,51 @@
+#ifndef USERPROG_EXEC_CACHE_H
+#define USERPROG_EXEC_CACHE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "devices/disk.h"
+#include "filesys/off_t.h"
+
+/* A loadable segment, as computed by load() from a program
+   header. */
+struct exec_segment
+  {
+    off_t file_page;            /* Page-aligned offset in file. */
+    uint8_t *mem_page;          /* Page-aligned user virtual address. */
+    uint32_t read_bytes;        /* Bytes to read from file. */
+    uint32_t zero_bytes;        /* Bytes to zero after those. */
+    bool writable;              /* Writable by the user process? */
+  };
+
+/* A parsed executable image, keyed by the inode it came from. */
+struct exec_image
+  {
+    struct list_elem elem;      /* Element in cache or list of new images. */
+    disk_sector_t inumber;      /* Inode sector of the executable. */
+    int ref_cnt;                /* Loaders using it, +1 while cached. */
+    bool is_new;                /* Not yet inserted in the cache? */
+    bool stale;                 /* Inode written while new? */
+    void (*entry) (void);       /* Entry point. */
+    size_t segment_cnt;         /* Number of segments. */
+    struct exec_segment *segments; /* Loadable segments, in order. */
+    size_t page_cnt;            /* Total pages in all segments. */
+    uint8_t **pages;            /* File data of each page, or nulls. */
+  };
+
+void exec_cache_init (void);
+void exec_cache_print_stats (void);
+
+struct exec_image *exec_image_create (disk_sector_t inumber);
+bool exec_image_add_segment (struct exec_image *, const struct exec_segment *);
+const uint8_t *exec_image_get_page (struct exec_image *, size_t page_idx);
+void exec_image_put_page (struct exec_image *, size_t page_idx,
+                          const void *data, size_t size);
+
+struct exec_image *exec_cache_lookup (disk_sector_t inumber);
+void exec_cache_insert (struct exec_image *);
+void exec_cache_release (struct exec_image *);
+void exec_cache_invalidate (disk_sector_t inumber);
+void exec_cache_flush (void);
+
+#endif /* userprog/exec-cache.h */
@@ -0,0 +1,131 @@
+#include "userprog/futex.h"
+#include <hash.h>
+#include <list.h>
+#include <stdint.h>
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Fast user-space mutexes.
+
+   A futex is just an int in user memory.  User code manipulates
+   it with atomic instructions and only makes a system call when
+   it has to wait or when it may have to wake a waiter, so an
+   uncontended lock never enters the kernel.
+
+   Waiters are keyed by the kernel virtual address of the word,
+   not its user address, so that processes that map the same
+   shared memory page at different addresses still meet here.
+   The system call layer does the translation. */
+
+/* Number of hash buckets for waiters. */
+#define FUTEX_BUCKETS 64
+
+/* A thread waiting in futex_wait(). */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in bucket. */
+    const int *word;            /* Kernel address waited on. */
+    struct thread *leader;      /* Leader of the waiter's process. */
+    struct semaphore sema;      /* Upped by futex_wake(). */
+  };
+
+static struct list buckets[FUTEX_BUCKETS];
+static struct lock futex_lock;  /* Protects the buckets. */
+
+/* Returns the bucket for waiters on WORD. */
+static struct list *
+bucket (const int *word)
+{
+  return &buckets[hash_int ((uintptr_t) word) % FUTEX_BUCKETS];
+}
+
+/* Initializes the futex module. */
+void
+futex_init (void)
+{
+  size_t i;
+
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    list_init (&buckets[i]);
+  lock_init (&futex_lock);
+}
+
+/* If *WORD still equals VAL, waits until futex_wake() is called
+   on WORD and returns 0.  Otherwise returns -1 at once, because
+   the value changed since the caller decided to wait.  Also
+   returns, with -1, if futex_interrupt() is called for the
+   caller's process.  WORD is a kernel address. */
+int
+futex_wait (const int *word, int val)
+{
+  struct futex_waiter w;
+
+  /* Holding futex_lock across the check and the enqueue means
+     that a futex_wake() after a change to *WORD can't be
+     missed. */
+  lock_acquire (&futex_lock);
+  if (*(volatile const int *) word != val)
+    {
+      lock_release (&futex_lock);
+      return -1;
+    }
+  w.word = word;
+  w.leader = thread_current ()->leader;
+  sema_init (&w.sema, 0);
+  list_push_back (bucket (word), &w.elem);
+  lock_release (&futex_lock);
+
+  sema_down (&w.sema);
+  return w.leader->exiting ? -1 : 0;
+}
+
+/* Wakes up to CNT threads waiting on WORD, a kernel address, in
+   the order they started waiting.  Returns the number woken. */
+int
+futex_wake (const int *word, int cnt)
+{
+  struct list *b = bucket (word);
+  struct list_elem *e;
+  int woken = 0;
+
+  lock_acquire (&futex_lock);
+  for (e = list_begin (b); e != list_end (b) && woken < cnt; )
+    {
+      struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+      e = list_next (e);
+      if (w->word == word)
+        {
+          list_remove (&w->elem);
+          sema_up (&w->sema);
+          woken++;
+        }
+    }
+  lock_release (&futex_lock);
+  return woken;
+}
+
+/* Wakes every thread of the process led by LEADER that is
+   waiting in futex_wait(), because the process is exiting. */
+void
+futex_interrupt (struct thread *leader)
+{
+  size_t i;
+
+  lock_acquire (&futex_lock);
+  for (i = 0; i < FUTEX_BUCKETS; i++)
+    {
+      struct list_elem *e;
+
+      for (e = list_begin (&buckets[i]); e != list_end (&buckets[i]); )
+        {
+          struct futex_waiter *w = list_entry (e, struct futex_waiter, elem);
+          e = list_next (e);
+          if (w->leader == leader)
+            {
+              list_remove (&w->elem);
+              sema_up (&w->sema);
+            }
+        }
+    }
+  lock_release (&futex_lock);
+}
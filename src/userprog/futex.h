@@ -0,0 +1,11 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+struct thread;
+
+void futex_init (void);
+int futex_wait (const int *word, int val);
+int futex_wake (const int *word, int cnt);
+void futex_interrupt (struct thread *leader);
+
+#endif /* userprog/futex.h */
@@ -0,0 +1,318 @@
+#include "userprog/ipc.h"
+#include <debug.h>
+#include <list.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/aio.h"
+#include "userprog/pagedir.h"
+#include "userprog/shm.h"
+
+/* Message passing between processes.
+
+   ipc_send() blocks the sender until the destination process
+   takes the message with ipc_receive().  The receiver then
+   moves the data straight from the sender's address space into
+   its own, while the sender is still blocked.
+
+   Where the two buffers have the same offset within a page,
+   every page that both buffers cover completely is moved rather
+   than copied: the sender's page is mapped into the receiver at
+   the receive buffer, and the receiver's old page takes its
+   place in the sender.  Only the unaligned head and tail, and
+   pages that can't be moved, are copied.  So after a send, the
+   contents of the sender's buffer are unspecified.
+
+   A page is copied instead of moved if it is read-only in
+   either process or part of a shared memory segment, since it
+   does not belong to the buffer alone, or if asynchronous I/O
+   to it has not finished. */
+
+/* A message waiting to be received. */
+struct message
+  {
+    struct list_elem elem;      /* Element in messages. */
+    tid_t dest;                 /* Receiving process. */
+    struct thread *sender;      /* Leader of the sending process. */
+    const uint8_t *buffer;      /* Data, in the sender's space. */
+    size_t size;                /* Number of bytes. */
+    int result;                 /* Bytes received, or -1. */
+    struct semaphore done;      /* Upped once received. */
+  };
+
+static struct list messages;    /* Messages not yet received. */
+static struct lock ipc_lock;    /* Protects messages. */
+static struct condition arrived; /* Signaled when a message is sent. */
+
+/* Statistics. */
+static long long moved_cnt;     /* Pages moved. */
+static long long copied_cnt;    /* Bytes copied. */
+
+static size_t transfer (uint8_t *dst, struct thread *sender,
+                        const uint8_t *src, size_t size);
+
+/* Initializes message passing. */
+void
+ipc_init (void)
+{
+  list_init (&messages);
+  lock_init (&ipc_lock);
+  cond_init (&arrived);
+}
+
+/* Used by find_process() to look for a live process. */
+struct find_aux
+  {
+    tid_t pid;                  /* Process to look for. */
+    bool found;                 /* Found it? */
+  };
+
+static void
+find_process_func (struct thread *t, void *aux_)
+{
+  struct find_aux *aux = aux_;
+  if (t->tid == aux->pid && t->leader == t && t->pagedir != NULL
+      && !t->exiting)
+    aux->found = true;
+}
+
+/* Returns true if PID is a user process that has not started to
+   exit. */
+static bool
+find_process (tid_t pid)
+{
+  struct find_aux aux;
+  enum intr_level old_level;
+
+  aux.pid = pid;
+  aux.found = false;
+  old_level = intr_disable ();
+  thread_foreach (find_process_func, &aux);
+  intr_set_level (old_level);
+  return aux.found;
+}
+
+/* Sends the SIZE bytes at user address BUFFER to process PID and
+   waits until PID receives them.  Returns the number of bytes
+   that PID took, which is less than SIZE if its buffer was
+   smaller, or -1 if PID is not a process or exits without
+   receiving the message, or if the current process starts to
+   exit before PID takes it. */
+int
+ipc_send (tid_t pid, const void *buffer, size_t size)
+{
+  struct message m;
+
+  m.dest = pid;
+  m.sender = thread_current ()->leader;
+  m.buffer = buffer;
+  m.size = size;
+  m.result = -1;
+  sema_init (&m.done, 0);
+
+  /* A process sets its exiting flag before ipc_exit() or
+     ipc_interrupt() takes ipc_lock, so either we see the flag or
+     it sees our message. */
+  lock_acquire (&ipc_lock);
+  if (pid == m.sender->tid || m.sender->exiting || !find_process (pid))
+    {
+      lock_release (&ipc_lock);
+      return -1;
+    }
+  list_push_back (&messages, &m.elem);
+  cond_broadcast (&arrived, &ipc_lock);
+  lock_release (&ipc_lock);
+
+  sema_down (&m.done);
+  return m.result;
+}
+
+/* Waits for a message to the current process, and receives up
+   to SIZE bytes of it into user address BUFFER.  The rest of a
+   longer message is discarded.  Returns the number of bytes
+   received, or -1 if the process starts to exit while we
+   wait. */
+int
+ipc_receive (void *buffer, size_t size)
+{
+  struct thread *leader = thread_current ()->leader;
+  tid_t pid = leader->tid;
+  struct message *m = NULL;
+  struct list_elem *e;
+
+  lock_acquire (&ipc_lock);
+  while (m == NULL)
+    {
+      if (leader->exiting)
+        {
+          lock_release (&ipc_lock);
+          return -1;
+        }
+      for (e = list_begin (&messages); e != list_end (&messages);
+           e = list_next (e))
+        if (list_entry (e, struct message, elem)->dest == pid)
+          {
+            m = list_entry (e, struct message, elem);
+            list_remove (&m->elem);
+            break;
+          }
+      if (m == NULL)
+        cond_wait (&arrived, &ipc_lock);
+    }
+  lock_release (&ipc_lock);
+
+  /* The sender stays blocked until we up M->done, so its
+     address space can't change under us. */
+  if (size > m->size)
+    size = m->size;
+  m->result = transfer (buffer, m->sender, m->buffer, size);
+  sema_up (&m->done);
+  return m->result;
+}
+
+/* Fails every message sent to the current process, which is
+   exiting. */
+void
+ipc_exit (void)
+{
+  tid_t pid = thread_current ()->leader->tid;
+  struct list_elem *e;
+
+  lock_acquire (&ipc_lock);
+  for (e = list_begin (&messages); e != list_end (&messages); )
+    {
+      struct message *m = list_entry (e, struct message, elem);
+      e = list_next (e);
+      if (m->dest == pid)
+        {
+          list_remove (&m->elem);
+          sema_up (&m->done);
+        }
+    }
+  lock_release (&ipc_lock);
+}
+
+/* Fails the messages not yet received whose sender is exiting,
+   and wakes the threads waiting in ipc_receive(), so that those
+   whose process is exiting can give up. */
+void
+ipc_interrupt (void)
+{
+  struct list_elem *e;
+
+  lock_acquire (&ipc_lock);
+  for (e = list_begin (&messages); e != list_end (&messages); )
+    {
+      struct message *m = list_entry (e, struct message, elem);
+      e = list_next (e);
+      if (m->sender->exiting)
+        {
+          list_remove (&m->elem);
+          sema_up (&m->done);
+        }
+    }
+  cond_broadcast (&arrived, &ipc_lock);
+  lock_release (&ipc_lock);
+}
+
+/* Prints message passing statistics. */
+void
+ipc_print_stats (void)
+{
+  printf ("IPC: %lld pages moved, %lld bytes copied\n",
+          moved_cnt, copied_cnt);
+}
+
+/* Returns true if user page UPAGE of the process led by T can be
+   given away to another process. */
+static bool
+movable (struct thread *t, const void *upage)
+{
+  return pagedir_is_writable (t->pagedir, upage)
+         && !shm_is_attached (t, upage);
+}
+
+/* Copies SIZE bytes from SRC in SENDER's address space to DST in
+   the current process's, a page at a time through their kernel
+   addresses, and returns SIZE. */
+static size_t
+copy (uint8_t *dst, struct thread *sender, const uint8_t *src,
+      size_t size)
+{
+  uint32_t *pd = thread_current ()->leader->pagedir;
+  size_t ofs = 0;
+
+  while (ofs < size)
+    {
+      size_t src_left = PGSIZE - pg_ofs (src + ofs);
+      size_t dst_left = PGSIZE - pg_ofs (dst + ofs);
+      size_t chunk = size - ofs;
+      if (chunk > src_left)
+        chunk = src_left;
+      if (chunk > dst_left)
+        chunk = dst_left;
+
+      memcpy (pagedir_get_page (pd, dst + ofs),
+              pagedir_get_page (sender->pagedir, src + ofs), chunk);
+      ofs += chunk;
+    }
+  copied_cnt += size;
+  return size;
+}
+
+/* Moves SIZE bytes from SRC in SENDER's address space to DST in
+   the current process's, exchanging whole pages where possible,
+   and returns SIZE. */
+static size_t
+transfer (uint8_t *dst, struct thread *sender, const uint8_t *src,
+          size_t size)
+{
+  uint32_t *pd = thread_current ()->leader->pagedir;
+  size_t head, ofs;
+
+  /* Without a common page offset, nothing lines up. */
+  if (pg_ofs (src) != pg_ofs (dst))
+    return copy (dst, sender, src, size);
+
+  head = (PGSIZE - pg_ofs (src)) % PGSIZE;
+  if (head >= size)
+    return copy (dst, sender, src, size);
+  copy (dst, sender, src, head);
+
+  for (ofs = head; size - ofs >= PGSIZE; ofs += PGSIZE)
+    {
+      void *spage = (void *) (src + ofs);
+      void *dpage = dst + ofs;
+      void *skpage, *dkpage;
+
+      if (!movable (sender, spage) || !movable (thread_current ()->leader, dpage))
+        {
+          copy (dpage, sender, spage, PGSIZE);
+          continue;
+        }
+
+      /* An aio worker may be using either page, so it must not
+         change hands. */
+      aio_lock_pages ();
+      if (aio_page_busy (sender, spage)
+          || aio_page_busy (thread_current ()->leader, dpage))
+        {
+          aio_unlock_pages ();
+          copy (dpage, sender, spage, PGSIZE);
+          continue;
+        }
+      skpage = pagedir_get_page (sender->pagedir, spage);
+      dkpage = pagedir_get_page (pd, dpage);
+      pagedir_clear_page (sender->pagedir, spage);
+      pagedir_clear_page (pd, dpage);
+      pagedir_set_page (sender->pagedir, spage, dkpage, true);
+      pagedir_set_page (pd, dpage, skpage, true);
+      aio_unlock_pages ();
+      moved_cnt++;
+    }
+
+  copy (dst + ofs, sender, src + ofs, size - ofs);
+  return size;
+}
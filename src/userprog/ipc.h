@@ -0,0 +1,14 @@
+#ifndef USERPROG_IPC_H
+#define USERPROG_IPC_H
+
+#include <stddef.h>
+#include "threads/thread.h"
+
+void ipc_init (void);
+int ipc_send (tid_t pid, const void *buffer, size_t size);
+int ipc_receive (void *buffer, size_t size);
+void ipc_exit (void);
+void ipc_interrupt (void);
+void ipc_print_stats (void);
+
+#endif /* userprog/ipc.h */
@@ -0,0 +1,198 @@
+#include "userprog/pipe.h"
+#include <debug.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+
+/* An anonymous pipe.
+
+   Bytes written to the pipe are kept in a one-page ring buffer
+   until they are read.  A reader blocks while the buffer is
+   empty and a writer while it is full.  Once every write end
+   has been closed, a read of an empty pipe returns 0 (end of
+   file); once every read end has been closed, a write fails.
+
+   Each descriptor that refers to the pipe, in any process, holds
+   one reference to its read or write end.  The pipe is freed
+   when the last of them is closed.
+
+   A thread whose process starts to exit while it waits gives up
+   at once, after pipe_interrupt(), as if every other end had
+   been closed. */
+
+/* Capacity of the ring buffer, in bytes. */
+#define PIPE_SIZE PGSIZE
+
+struct pipe
+  {
+    struct lock lock;           /* Protects all the members. */
+    struct condition not_empty; /* Signaled when data is written. */
+    struct condition not_full;  /* Signaled when data is read. */
+    uint8_t *buffer;            /* Ring buffer of PIPE_SIZE bytes. */
+    size_t head;                /* Offset of the oldest byte. */
+    size_t used;                /* Number of bytes in the buffer. */
+    int reader_cnt;             /* Open read ends. */
+    int writer_cnt;             /* Open write ends. */
+  };
+
+/* Creates a pipe with one read end and one write end open.
+   Returns the new pipe, or a null pointer if memory is
+   exhausted. */
+struct pipe *
+pipe_create (void)
+{
+  struct pipe *p = malloc (sizeof *p);
+  if (p == NULL)
+    return NULL;
+  p->buffer = palloc_get_page (0);
+  if (p->buffer == NULL)
+    {
+      free (p);
+      return NULL;
+    }
+
+  lock_init (&p->lock);
+  cond_init (&p->not_empty);
+  cond_init (&p->not_full);
+  p->head = p->used = 0;
+  p->reader_cnt = p->writer_cnt = 1;
+  return p;
+}
+
+/* Opens another read end of P, or another write end if WRITER is
+   true. */
+void
+pipe_open_end (struct pipe *p, bool writer)
+{
+  lock_acquire (&p->lock);
+  if (writer)
+    p->writer_cnt++;
+  else
+    p->reader_cnt++;
+  lock_release (&p->lock);
+}
+
+/* Closes a read end of P, or a write end if WRITER is true, and
+   frees P if that was the last end open. */
+void
+pipe_close_end (struct pipe *p, bool writer)
+{
+  bool last;
+
+  lock_acquire (&p->lock);
+  if (writer)
+    {
+      ASSERT (p->writer_cnt > 0);
+      p->writer_cnt--;
+    }
+  else
+    {
+      ASSERT (p->reader_cnt > 0);
+      p->reader_cnt--;
+    }
+
+  /* Whoever is blocked may now have to give up. */
+  cond_broadcast (&p->not_empty, &p->lock);
+  cond_broadcast (&p->not_full, &p->lock);
+  last = p->reader_cnt == 0 && p->writer_cnt == 0;
+  lock_release (&p->lock);
+
+  if (last)
+    {
+      palloc_free_page (p->buffer);
+      free (p);
+    }
+}
+
+/* Returns true if the current thread's process is exiting. */
+static bool
+exiting (void)
+{
+  return thread_current ()->leader->exiting;
+}
+
+/* Reads up to SIZE bytes from P into BUFFER, waiting until at
+   least one byte is available.  Returns the number of bytes
+   read, which is 0 only if SIZE is 0 or every write end of P
+   is closed and the buffer is empty. */
+int
+pipe_read (struct pipe *p, void *buffer_, size_t size)
+{
+  uint8_t *buffer = buffer_;
+  size_t read = 0;
+
+  lock_acquire (&p->lock);
+  while (size > 0 && p->used == 0 && p->writer_cnt > 0 && !exiting ())
+    cond_wait (&p->not_empty, &p->lock);
+
+  /* At most two chunks: up to the end of the ring, then from
+     its start. */
+  while (read < size && p->used > 0)
+    {
+      size_t chunk = PIPE_SIZE - p->head;
+      if (chunk > p->used)
+        chunk = p->used;
+      if (chunk > size - read)
+        chunk = size - read;
+      memcpy (buffer + read, p->buffer + p->head, chunk);
+      p->head = (p->head + chunk) % PIPE_SIZE;
+      p->used -= chunk;
+      read += chunk;
+    }
+  if (read > 0)
+    cond_broadcast (&p->not_full, &p->lock);
+  lock_release (&p->lock);
+
+  return read;
+}
+
+/* Writes SIZE bytes from BUFFER into P, waiting for room as
+   needed.  Returns the number of bytes written, which falls
+   short of SIZE only if every read end of P is closed part way
+   through, or -1 if every read end was closed before any byte
+   was written. */
+int
+pipe_write (struct pipe *p, const void *buffer_, size_t size)
+{
+  const uint8_t *buffer = buffer_;
+  size_t written = 0;
+
+  lock_acquire (&p->lock);
+  while (written < size)
+    {
+      size_t tail, chunk;
+
+      while (p->used == PIPE_SIZE && p->reader_cnt > 0 && !exiting ())
+        cond_wait (&p->not_full, &p->lock);
+      if (p->reader_cnt == 0 || p->used == PIPE_SIZE)
+        break;
+
+      tail = (p->head + p->used) % PIPE_SIZE;
+      chunk = PIPE_SIZE - p->used;
+      if (chunk > PIPE_SIZE - tail)
+        chunk = PIPE_SIZE - tail;
+      if (chunk > size - written)
+        chunk = size - written;
+      memcpy (p->buffer + tail, buffer + written, chunk);
+      p->used += chunk;
+      written += chunk;
+      cond_broadcast (&p->not_empty, &p->lock);
+    }
+  lock_release (&p->lock);
+
+  return written == 0 && size > 0 ? -1 : (int) written;
+}
+
+/* Wakes every thread waiting to read or write P, so that those
+   whose process is exiting can give up. */
+void
+pipe_interrupt (struct pipe *p)
+{
+  lock_acquire (&p->lock);
+  cond_broadcast (&p->not_empty, &p->lock);
+  cond_broadcast (&p->not_full, &p->lock);
+  lock_release (&p->lock);
+}
@@ -6,8 +6,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <list.h>
+#include "userprog/aio.h"
+#include "userprog/exec-cache.h"
+#include "userprog/futex.h"
 #include "userprog/gdt.h"
+#include "userprog/ipc.h"
 #include "userprog/pagedir.h"
+#include "userprog/pipe.h"
+#include "userprog/shm.h"
 #include "userprog/tss.h"
 #include "userprog/syscall.h"
 #include "filesys/directory.h"
@@ -16,12 +22,22 @@
 #include "threads/flags.h"
 #include "threads/init.h"
 #include "threads/interrupt.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/vaddr.h"
+#include "devices/timer.h"
 
 static thread_func start_process NO_RETURN;
-static bool load (const char *cmdline, void (**eip) (void), void **esp);
+static thread_func start_uthread NO_RETURN;
+static bool load (struct file *, const char *file_name,
+                  void (**eip) (void), void **esp);
+static void print_rusage (const struct thread *);
+static bool inherit_pipes (struct thread *parent);
+
+/* If true, print each process's resource usage after its exit
+   line.  Controlled by kernel command-line option "-o rusage". */
+bool process_print_rusage;
 
 extern struct lock page_lock;
 extern struct lock file_lock;
@@ -62,6 +78,7 @@ void remove_child(struct child_elem *child)
 tid_t
 process_execute (const char *file_name) 
 {
+  char name[16];
   char *fn_copy;
   tid_t tid;
 
@@ -74,29 +91,30 @@ process_execute (const char *file_name)
      Otherwise there's a race between the caller and load(). */
   fn_copy = palloc_get_page (0);
   if (fn_copy == NULL)
-    return TID_ERROR;
+    {
+      /* The executable cache's pages are the easiest to spare. */
+      exec_cache_flush ();
+      fn_copy = palloc_get_page (0);
+      if (fn_copy == NULL)
+        return TID_ERROR;
+    }
   strlcpy (fn_copy, file_name, PGSIZE);
 
-  // File name을 parsing 하기 위해 한 번 더 copy 해준다. (to avoid race condition)
-  char *fn_copy2;
-
-  fn_copy2 = palloc_get_page(0);
-  if(fn_copy2 == NULL)
-    return TID_ERROR;
-  strlcpy(fn_copy2, file_name, PGSIZE);
-
-  // args[0]을 가져와 real filename을 parsing한다.
-  char *save_ptr;
-  char *rf_name = strtok_r(fn_copy2, " ", &save_ptr); // real file name
+  // thread 이름은 program 이름 (첫 번째 argument)이다.
+  file_name += strspn (file_name, " ");
+  strlcpy (name, file_name, sizeof name);
+  name[strcspn (name, " ")] = '\0';
 
   /* Create a new thread to execute FILE_NAME. */
-  tid = thread_create (rf_name, PRI_DEFAULT, start_process, fn_copy);
+  tid = thread_create (name, PRI_DEFAULT, start_process, fn_copy);
+  if (tid == TID_ERROR)
+    {
+      exec_cache_flush ();
+      tid = thread_create (name, PRI_DEFAULT, start_process, fn_copy);
+    }
 
   if (tid == TID_ERROR) {
     palloc_free_page (fn_copy);
-    palloc_free_page(fn_copy2);
-    free(rf_name);
-
     return -1;
   }
 
@@ -113,112 +131,125 @@ process_execute (const char *file_name)
     return -1;
   }
 
-  palloc_free_page(fn_copy2);
-
   return tid;
 }
 
+/* Copies the words of CMD_LINE, which is modified, onto the user
+   stack below *ESP, followed by the argv array, argc, and a null
+   return address, as expected by the user program's _start().
+   Returns false if they do not fit in the stack page. */
+static bool
+push_arguments (char *cmd_line, void **esp)
+{
+  uint8_t *sp = *esp;
+  uint8_t *limit = (uint8_t *) PHYS_BASE - PGSIZE;
+  char *strings, *token, *save_ptr;
+  char **argv;
+  int argc = 0;
+  int i;
+
+  /* The strings themselves.  The first word ends up highest. */
+  for (token = strtok_r (cmd_line, " ", &save_ptr); token != NULL;
+       token = strtok_r (NULL, " ", &save_ptr))
+    {
+      size_t len = strlen (token) + 1;
+      if (len > (size_t) (sp - limit))
+        return false;
+      sp -= len;
+      memcpy (sp, token, len);
+      argc++;
+    }
+  strings = (char *) sp;
+
+  /* Word-align, then make room for argv[0...argc], argv, argc,
+     and the return address. */
+  sp = (uint8_t *) ROUND_DOWN ((uintptr_t) sp, sizeof (char *));
+  if ((size_t) (sp - limit) < (argc + 4) * sizeof (char *))
+    return false;
+  sp -= (argc + 1) * sizeof (char *);
+  argv = (char **) sp;
+
+  /* Walking up from the lowest string visits the words in
+     reverse order. */
+  argv[argc] = NULL;
+  for (i = argc - 1; i >= 0; i--)
+    {
+      argv[i] = strings;
+      strings += strlen (strings) + 1;
+    }
+
+  sp -= sizeof (char **);
+  *(char ***) sp = argv;
+  sp -= sizeof (int);
+  *(int *) sp = argc;
+  sp -= sizeof (void *);
+  *(void **) sp = NULL;
+
+  *esp = sp;
+  return true;
+}
+
 /* A thread function that loads a user process and makes it start
    running. */
 static void
 start_process (void *f_name)
 {
   char *file_name = f_name;
+  char *name_end, saved;
   struct intr_frame if_;
-  bool success;
+  struct file *file;
+  bool success = false;
   struct thread *curr = thread_current();
 
-  // Argument Passing
-
-  // file_name parse with spliting space
-  char args[100][100] = {0,}; // arguments를 저장할 array
-  char *args_addr[100] = {0,}; // args의 pointer를 저장할 array
-
-  int argc = 0;
-  char *token, *save_ptr;
-  token = strtok_r(file_name, " ", &save_ptr);
-
-  /* Initialize interrupt frame and load executable. */
-
-  // File Deny Write를 먼저 해준다.
-  struct file *userprog = filesys_open(token);
-  if(userprog != NULL)
-  {
-    file_deny_write(userprog);
-  }
+  // 실행 파일은 한 번만 열고, process가 끝날 때까지 write를 막는다.
+  file_name += strspn (file_name, " ");
+  name_end = file_name + strcspn (file_name, " ");
+  saved = *name_end;
+  *name_end = '\0';
+  file = filesys_open (file_name);
+  if (file == NULL)
+    printf ("load: %s: open failed\n", file_name);
   else
-  {
-    palloc_free_page(file_name);
-    file_close(userprog);
-    if (!list_empty (&curr->parent->sema_start.waiters))
-      sema_up(&curr->parent->sema_start);
-    syscall_exit(-1);
-  }
+    {
+      file_deny_write (file);
 
-  memset (&if_, 0, sizeof if_);
-  if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
-  if_.cs = SEL_UCSEG;
-  if_.eflags = FLAG_IF | FLAG_MBS;
-  success = load (token, &if_.eip, &if_.esp);
+      /* Initialize interrupt frame and load executable. */
+      memset (&if_, 0, sizeof if_);
+      if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
+      if_.cs = SEL_UCSEG;
+      if_.eflags = FLAG_IF | FLAG_MBS;
 
-  if(!success)
-  {
-    palloc_free_page(file_name);
-    file_close(userprog);
-    if (!list_empty (&curr->parent->sema_start.waiters))
-      sema_up(&curr->parent->sema_start);
-    syscall_exit(-1);
-  }
+      // program 이름 뒤에 넣었던 '\0'을 되돌리고 argument를 넣는다.
+      success = load (file, file_name, &if_.eip, &if_.esp);
+      if (success)
+        {
+          *name_end = saved;
+          success = push_arguments (file_name, &if_.esp);
+        }
+      if (success)
+        success = inherit_pipes (curr->parent->leader);
+    }
+  palloc_free_page (f_name);
+
+  /* If load failed, quit. */
+  if (!success)
+    {
+      file_close (file);
+      if (!list_empty (&curr->parent->sema_start.waiters))
+        sema_up (&curr->parent->sema_start);
+      syscall_exit (-1);
+    }
 
   struct thread *parent = curr->parent;
   struct child_elem *curr_elem = get_child (parent, curr->tid);
   curr_elem->loaded = success;
 
-  curr->program = userprog;
+  curr->program = file;
 
   // load 끝나면 sema up 해준다.
   if (!list_empty (&parent->sema_start.waiters))
     sema_up(&curr->parent->sema_start);
 
-  for(; token != NULL; token = strtok_r(NULL, " ", &save_ptr))
-  {
-    int len = strlen(token) + 1;
-    if_.esp -= len;
-    memcpy(if_.esp, token, len);
-    args_addr[argc++] = if_.esp;
-  }
-
-  // Offset
-  if_.esp -= (uint32_t)if_.esp % 4;
-
-  // args[argc]
-  if_.esp -= 4;
-  *(int*)if_.esp = 0;
-
-  // args[0~argc-1]
-  int i;
-  for(i = argc - 1; i >= 0; i--)
-  {
-    if_.esp -= 4;
-    *(void**)if_.esp = args_addr[i];
-  }
-
-  // args 주소를 넣어준다.
-  if_.esp -= 4;
-  *(void**)if_.esp = if_.esp + 4;
-
-  // 그 다음 argc를 넣어준다.
-  if_.esp -= 4;
-  *(int*)if_.esp = argc;
-
-  // 마지막으로 return address를 넣어준다.
-  if_.esp -= 4;
-  *(int*)if_.esp = 0;
-
-
-  /* If load failed, quit. */
-  palloc_free_page (file_name);
-
   /* Start the user process by simulating a return from an
      interrupt, implemented by intr_exit (in
      threads/intr-stubs.S).  Because intr_exit takes all of its
@@ -263,6 +294,363 @@ process_wait (tid_t child_tid)
   return status;
 }
 
+/* Threads within a process.
+
+   Each thread created by process_spawn() is an ordinary kernel
+   thread whose pagedir is the leader's and whose file
+   descriptor lookups go through the leader.  It gets its own
+   one-page user stack, at the top of a slot of
+   UTHREAD_STACK_SPACING bytes below the leader's stack.
+
+   A thread ends when it calls process_thread_exit(), normally
+   because the function passed to thread_spawn() returned.  If
+   any thread calls exit(), or is killed, the whole process
+   exits: the other threads terminate when they next leave a
+   system call, or if they are running user code, at the next
+   interrupt, and the leader waits for all of them before
+   destroying the address space.  Threads blocked in futex_wait(),
+   msg_send(), msg_receive(), aio_wait(), or on a pipe are woken
+   to notice.  Threads blocked in wait() or reading the console
+   are not: the exit waits until the child exits or a key is
+   pressed. */
+
+/* Distance between the tops of adjacent user stacks. */
+#define UTHREAD_STACK_SPACING (1024 * 1024)
+
+/* Returns the user page holding the stack for SLOT. */
+static void *
+uthread_stack_page (int slot)
+{
+  return (uint8_t *) PHYS_BASE - slot * UTHREAD_STACK_SPACING - PGSIZE;
+}
+
+/* Returns an unused stack slot in LEADER's process, or 0 if all
+   are in use.  LEADER's uthread_lock must be held. */
+static int
+uthread_alloc_slot (struct thread *leader)
+{
+  int slot;
+
+  for (slot = 1; slot <= UTHREAD_MAX; slot++)
+    {
+      struct list_elem *e;
+
+      for (e = list_begin (&leader->uthreads);
+           e != list_end (&leader->uthreads); e = list_next (e))
+        {
+          struct uthread *u = list_entry (e, struct uthread, elem);
+          if (!u->exited && u->slot == slot)
+            break;
+        }
+      if (e == list_end (&leader->uthreads))
+        return slot;
+    }
+  return 0;
+}
+
+/* Starts a new thread in the current process.  The thread
+   begins executing in user mode at EIP as if called with
+   arguments FUNC and AUX.  Returns the new thread's tid, or
+   TID_ERROR if it cannot be created. */
+tid_t
+process_spawn (void (*eip) (void), void *func, void *aux)
+{
+  struct thread *curr = thread_current ();
+  struct thread *leader = curr->leader;
+  struct child_elem *child;
+  struct uthread *u;
+  uint8_t *kpage;
+  tid_t tid = TID_ERROR;
+
+  if (!is_user_vaddr (eip))
+    return TID_ERROR;
+
+  u = malloc (sizeof *u);
+  if (u == NULL)
+    return TID_ERROR;
+  u->leader = leader;
+  u->eip = eip;
+  u->func = func;
+  u->aux = aux;
+  u->exited = false;
+  u->joined = false;
+  u->status = -1;
+  sema_init (&u->done, 0);
+
+  lock_acquire (&leader->uthread_lock);
+  u->slot = uthread_alloc_slot (leader);
+  if (u->slot == 0 || leader->exiting)
+    goto done;
+
+  /* Map the new thread's stack. */
+  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+  if (kpage == NULL)
+    goto done;
+  if (!pagedir_set_page (leader->pagedir, uthread_stack_page (u->slot),
+                         kpage, true))
+    {
+      palloc_free_page (kpage);
+      goto done;
+    }
+
+  list_push_back (&leader->uthreads, &u->elem);
+  leader->uthread_cnt++;
+  u->tid = tid = thread_create (leader->name, PRI_DEFAULT,
+                                start_uthread, u);
+  if (tid == TID_ERROR)
+    {
+      list_remove (&u->elem);
+      leader->uthread_cnt--;
+      pagedir_clear_page (leader->pagedir, uthread_stack_page (u->slot));
+      palloc_free_page (kpage);
+      goto done;
+    }
+
+  /* thread_create() made the new thread our child, but it is
+     our sibling and cannot be waited for. */
+  child = get_child (curr, tid);
+  if (child != NULL)
+    {
+      remove_child (child);
+      free (child);
+    }
+
+ done:
+  lock_release (&leader->uthread_lock);
+  if (tid == TID_ERROR)
+    free (u);
+  return tid;
+}
+
+/* A thread function that enters user mode for a thread created
+   by process_spawn(). */
+static void
+start_uthread (void *u_)
+{
+  struct uthread *u = u_;
+  struct thread *curr = thread_current ();
+  struct intr_frame if_;
+  void **esp;
+
+  curr->leader = u->leader;
+  curr->uthread = u;
+  curr->pagedir = u->leader->pagedir;
+  process_activate ();
+
+  /* Push AUX, FUNC, and a null return address, as if EIP had
+     been called as EIP (FUNC, AUX). */
+  esp = (void **) ((uint8_t *) uthread_stack_page (u->slot) + PGSIZE);
+  *--esp = u->aux;
+  *--esp = u->func;
+  *--esp = NULL;
+
+  memset (&if_, 0, sizeof if_);
+  if_.gs = if_.fs = if_.es = if_.ds = if_.ss = SEL_UDSEG;
+  if_.cs = SEL_UCSEG;
+  if_.eflags = FLAG_IF | FLAG_MBS;
+  if_.eip = u->eip;
+  if_.esp = esp;
+
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+
+/* Waits for thread TID, which must have been created by
+   process_spawn() in the current process, to exit and returns
+   its exit status.  Returns -1 immediately if TID is not such a
+   thread, is the calling thread, or is already being joined. */
+int
+process_join (tid_t tid)
+{
+  struct thread *curr = thread_current ();
+  struct thread *leader = curr->leader;
+  struct uthread *u = NULL;
+  struct list_elem *e;
+  int status;
+
+  lock_acquire (&leader->uthread_lock);
+  for (e = list_begin (&leader->uthreads); e != list_end (&leader->uthreads);
+       e = list_next (e))
+    {
+      struct uthread *t = list_entry (e, struct uthread, elem);
+      if (t->tid == tid)
+        {
+          u = t;
+          break;
+        }
+    }
+  if (u == NULL || u == curr->uthread || u->joined)
+    {
+      lock_release (&leader->uthread_lock);
+      return -1;
+    }
+  u->joined = true;
+  lock_release (&leader->uthread_lock);
+
+  sema_down (&u->done);
+
+  lock_acquire (&leader->uthread_lock);
+  status = u->status;
+  list_remove (&u->elem);
+  lock_release (&leader->uthread_lock);
+  free (u);
+
+  return status;
+}
+
+/* Terminates the calling thread, which must have been created by
+   process_spawn(), with the given exit STATUS.  The rest of the
+   process is unaffected. */
+void
+process_thread_exit (int status)
+{
+  struct thread *curr = thread_current ();
+  struct thread *leader = curr->leader;
+  struct uthread *u = curr->uthread;
+  uint32_t *pd = curr->pagedir;
+  void *upage = uthread_stack_page (u->slot);
+  void *kpage;
+
+  ASSERT (leader != curr);
+
+  while (!list_empty (&curr->children))
+    {
+      struct list_elem *e = list_pop_front (&curr->children);
+      free (list_entry (e, struct child_elem, elem));
+    }
+
+  /* Stop using the shared page directory before anyone can be
+     told we're done, since the leader destroys it once all of
+     its threads have exited. */
+  curr->pagedir = NULL;
+  pagedir_activate (NULL);
+
+  /* An aio worker may still be using our stack page. */
+  aio_lock_pages ();
+  aio_wait_page (leader, upage);
+  kpage = pagedir_get_page (pd, upage);
+  pagedir_clear_page (pd, upage);
+  aio_unlock_pages ();
+  palloc_free_page (kpage);
+
+  lock_acquire (&leader->uthread_lock);
+  u->status = status;
+  u->exited = true;
+  sema_up (&u->done);
+  if (--leader->uthread_cnt == 0 && leader->exiting)
+    sema_up (&leader->uthread_sema);
+  lock_release (&leader->uthread_lock);
+
+  thread_exit ();
+}
+
+/* Marks the process led by LEADER as exiting and wakes those of
+   its threads that may be blocked indefinitely in a system call,
+   so that they terminate.  LEADER->exit_status must already be
+   set. */
+void
+process_set_exiting (struct thread *leader)
+{
+  struct list_elem *e;
+
+  lock_acquire (&leader->uthread_lock);
+  leader->exiting = true;
+  lock_release (&leader->uthread_lock);
+
+  futex_interrupt (leader);
+  ipc_interrupt ();
+  aio_interrupt ();
+
+  lock_acquire (&file_lock);
+  for (e = list_begin (&leader->files); e != list_end (&leader->files);
+       e = list_next (e))
+    {
+      struct file_elem *f = list_entry (e, struct file_elem, elem);
+      if (f->pipe != NULL)
+        pipe_interrupt (f->pipe);
+    }
+  lock_release (&file_lock);
+}
+
+/* Called by a process's leader as the process exits.  Waits for
+   all of the process's other threads to exit, and frees their
+   records. */
+void
+process_exit_threads (void)
+{
+  struct thread *curr = thread_current ();
+
+  ASSERT (curr->leader == curr);
+
+  process_set_exiting (curr);
+  lock_acquire (&curr->uthread_lock);
+  if (curr->uthread_cnt > 0)
+    {
+      lock_release (&curr->uthread_lock);
+      sema_down (&curr->uthread_sema);
+      lock_acquire (&curr->uthread_lock);
+    }
+  while (!list_empty (&curr->uthreads))
+    {
+      struct list_elem *e = list_pop_front (&curr->uthreads);
+      free (list_entry (e, struct uthread, elem));
+    }
+  lock_release (&curr->uthread_lock);
+}
+
+/* Gives the current process a copy of each of PARENT's pipe
+   descriptors, under the same numbers, so that a pipe set up
+   before exec() connects the new process to its creator or to
+   its siblings.  PARENT is blocked in process_execute(), but its
+   other threads may still open and close descriptors.  Returns
+   false if memory is exhausted. */
+static bool
+inherit_pipes (struct thread *parent)
+{
+  struct thread *curr = thread_current ();
+  struct list_elem *e;
+  bool success = true;
+
+  lock_acquire (&file_lock);
+  for (e = list_begin (&parent->files); e != list_end (&parent->files);
+       e = list_next (e))
+    {
+      struct file_elem *pf = list_entry (e, struct file_elem, elem);
+      struct file_elem *f;
+
+      if (pf->pipe == NULL)
+        continue;
+      f = malloc (sizeof *f);
+      if (f == NULL)
+        {
+          success = false;
+          break;
+        }
+      memcpy (f, pf, sizeof *f);
+      pipe_open_end (f->pipe, f->pipe_write);
+      list_push_back (&curr->files, &f->elem);
+      if (f->fd >= curr->next_fd)
+        curr->next_fd = f->fd + 1;
+    }
+  lock_release (&file_lock);
+  return success;
+}
+
+/* Prints the resources used by process T, whose threads have
+   all exited, in the form
+   "NAME: rusage: user MS ms, sys MS ms, ...". */
+static void
+print_rusage (const struct thread *t) 
+{
+  const struct usage *u = &t->usage;
+
+  printf ("%s: rusage: user %lld ms, sys %lld ms, %ld faults "
+          "(%ld major), %ld sectors read, %ld written, %ld syscalls\n",
+          t->name, u->user_ticks * 1000 / TIMER_FREQ,
+          u->kernel_ticks * 1000 / TIMER_FREQ, u->fault_cnt,
+          u->major_fault_cnt, u->read_cnt, u->write_cnt, u->syscall_cnt);
+}
+
 /* Free the current process's resources. */
 void
 process_exit (void)
@@ -270,6 +658,11 @@ process_exit (void)
   struct thread *curr = thread_current ();
   uint32_t *pd;
 
+  /* Threads created by process_spawn() share the leader's
+     resources, which the leader frees. */
+  if (curr->leader != curr)
+    return;
+
   /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
 
@@ -298,6 +691,10 @@ process_exit (void)
 
     // EDITED
     printf("%s: exit(%d)\n", curr->name, curr->exit_status);
+    if (process_print_rusage)
+      print_rusage (curr);
+    usage_add (&t_parent->child_usage, &curr->usage);
+    usage_add (&t_parent->child_usage, &curr->child_usage);
     t_parent->child_exit_status = curr->exit_status;
 
     if (curr_elem->tid == t_parent->waiting && !list_empty (&t_parent->sema_exit.waiters))
@@ -320,10 +717,18 @@ process_exit (void)
     while (!list_empty (&curr->files)) {
       f_elem = list_pop_front (&curr->files);
       f = list_entry (f_elem, struct file_elem, elem);
+      if (f->pipe != NULL)
+        pipe_close_end (f->pipe, f->pipe_write);
       free (f->file);
       free (f);
     }
 
+    /* Asynchronous I/O in progress may still use our pages.
+       Shared pages belong to their segments, not to PD. */
+    aio_exit ();
+    shm_detach_all ();
+    ipc_exit ();
+
     curr->pagedir = NULL;
     pagedir_activate (NULL);
     pagedir_destroy (pd);
@@ -415,26 +820,34 @@ struct Elf32_Phdr
 
 static bool setup_stack (void **esp);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
-static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
-                          uint32_t read_bytes, uint32_t zero_bytes,
-                          bool writable);
+static struct exec_image *parse_image (struct file *, const char *file_name);
+static bool load_segment (struct file *file, struct exec_image *image,
+                          const struct exec_segment *seg, size_t *page_idx,
+                          bool fill_cache);
 
-/* Loads an ELF executable from FILE_NAME into the current thread.
+/* Loads the ELF executable in FILE, which was opened as
+   FILE_NAME, into the current thread.
    Stores the executable's entry point into *EIP
    and its initial stack pointer into *ESP.
-   Returns true if successful, false otherwise. */
+   Returns true if successful, false otherwise.
+   FILE is left open either way.
+
+   The executable's parsed headers, and usually its page
+   contents, are kept in the exec cache, so that loading the same
+   executable again requires neither parsing nor file reads. */
 /*
   load 함수에서 pagedir ptr을 새로 할당받아온다.
 */
 bool
-load (const char *file_name, void (**eip) (void), void **esp) 
+load (struct file *file, const char *file_name, void (**eip) (void),
+      void **esp) 
 {
   struct thread *t = thread_current ();
-  struct Elf32_Ehdr ehdr;
-  struct file *file = NULL;
-  off_t file_ofs;
+  struct exec_image *image = NULL;
+  bool cached = true;
   bool success = false;
-  int i;
+  size_t page_idx = 0;
+  size_t i;
 
   /* Allocate and activate page directory. */
   t->pagedir = pagedir_create ();
@@ -442,16 +855,64 @@ load (const char *file_name, void (**eip) (void), void **esp)
     goto done;
   process_activate ();
 
-  /* Open executable file. */
-  file = filesys_open (file_name);
-  if (file == NULL) 
+  /* Find or parse the executable's segment layout.  The exec
+     cache is keyed by inode, so files in /proc or /tmp, which
+     have none, can't be run. */
+  if (file_get_inode (file) == NULL)
+    {
+      printf ("load: %s: not on disk\n", file_name);
+      goto done;
+    }
+  image = exec_cache_lookup (inode_get_inumber (file_get_inode (file)));
+  if (image == NULL)
     {
-      printf ("load: %s: open failed\n", file_name);
-      goto done; 
+      cached = false;
+      image = parse_image (file, file_name);
+      if (image == NULL)
+        goto done;
     }
 
+  /* Load segments, filling in the image's page cache as we go if
+     it is new. */
+  for (i = 0; i < image->segment_cnt; i++)
+    if (!load_segment (file, image, &image->segments[i], &page_idx, !cached))
+      goto done;
+
+  /* Set up stack. */
+  if (!setup_stack (esp))
+    goto done;
+
+  /* Start address. */
+  *eip = image->entry;
+
+  success = true;
+  if (!cached)
+    exec_cache_insert (image);
+
+ done:
+  /* We arrive here whether the load is successful or not. */
+  exec_cache_release (image);
+  return success;
+}
+
+/* Reads and validates the ELF headers of FILE, which was opened
+   as FILE_NAME, and returns a new image describing its loadable
+   segments, or a null pointer if it is not a valid executable
+   or memory is exhausted. */
+static struct exec_image *
+parse_image (struct file *file, const char *file_name) 
+{
+  struct exec_image *image;
+  struct Elf32_Ehdr ehdr;
+  off_t file_ofs;
+  int i;
+
+  image = exec_image_create (inode_get_inumber (file_get_inode (file)));
+  if (image == NULL)
+    return NULL;
+
   /* Read and verify executable header. */
-  if (file_read (file, &ehdr, sizeof ehdr) != sizeof ehdr
+  if (file_read_at (file, &ehdr, sizeof ehdr, 0) != sizeof ehdr
       || memcmp (ehdr.e_ident, "\177ELF\1\1\1", 7)
       || ehdr.e_type != 2
       || ehdr.e_machine != 3
@@ -460,8 +921,9 @@ load (const char *file_name, void (**eip) (void), void **esp)
       || ehdr.e_phnum > 1024) 
     {
       printf ("load: %s: error loading executable\n", file_name);
-      goto done; 
+      goto error; 
     }
+  image->entry = (void (*) (void)) ehdr.e_entry;
 
   /* Read program headers. */
   file_ofs = ehdr.e_phoff;
@@ -470,11 +932,10 @@ load (const char *file_name, void (**eip) (void), void **esp)
       struct Elf32_Phdr phdr;
 
       if (file_ofs < 0 || file_ofs > file_length (file))
-        goto done;
-      file_seek (file, file_ofs);
+        goto error;
 
-      if (file_read (file, &phdr, sizeof phdr) != sizeof phdr)
-        goto done;
+      if (file_read_at (file, &phdr, sizeof phdr, file_ofs) != sizeof phdr)
+        goto error;
       file_ofs += sizeof phdr;
       switch (phdr.p_type) 
         {
@@ -488,55 +949,46 @@ load (const char *file_name, void (**eip) (void), void **esp)
         case PT_DYNAMIC:
         case PT_INTERP:
         case PT_SHLIB:
-          goto done;
+          goto error;
         case PT_LOAD:
           if (validate_segment (&phdr, file)) 
             {
-              bool writable = (phdr.p_flags & PF_W) != 0;
-              uint32_t file_page = phdr.p_offset & ~PGMASK;
-              uint32_t mem_page = phdr.p_vaddr & ~PGMASK;
+              struct exec_segment seg;
               uint32_t page_offset = phdr.p_vaddr & PGMASK;
-              uint32_t read_bytes, zero_bytes;
+
+              seg.writable = (phdr.p_flags & PF_W) != 0;
+              seg.file_page = phdr.p_offset & ~PGMASK;
+              seg.mem_page = (uint8_t *) (phdr.p_vaddr & ~PGMASK);
               if (phdr.p_filesz > 0)
                 {
                   /* Normal segment.
                      Read initial part from disk and zero the rest. */
-                  read_bytes = page_offset + phdr.p_filesz;
-                  zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
-                                - read_bytes);
+                  seg.read_bytes = page_offset + phdr.p_filesz;
+                  seg.zero_bytes = (ROUND_UP (page_offset + phdr.p_memsz, PGSIZE)
+                                    - seg.read_bytes);
                 }
               else 
                 {
                   /* Entirely zero.
                      Don't read anything from disk. */
-                  read_bytes = 0;
-                  zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
+                  seg.read_bytes = 0;
+                  seg.zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
                 }
-              if (!load_segment (file, file_page, (void *) mem_page,
-                                 read_bytes, zero_bytes, writable))
-                goto done;
+              if (!exec_image_add_segment (image, &seg))
+                goto error;
             }
           else
-            goto done;
+            goto error;
           break;
         }
     }
+  return image;
 
-  /* Set up stack. */
-  if (!setup_stack (esp))
-    goto done;
-
-  /* Start address. */
-  *eip = (void (*) (void)) ehdr.e_entry;
-
-  success = true;
-
- done:
-  /* We arrive here whether the load is successful or not. */
-  file_close (file);
-  return success;
+ error:
+  exec_cache_release (image);
+  return NULL;
 }
-
+
 /* load() helpers. */
 
 static bool install_page (void *upage, void *kpage, bool writable);
@@ -586,25 +1038,34 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
   return true;
 }
 
-/* Loads a segment starting at offset OFS in FILE at address
-   UPAGE.  In total, READ_BYTES + ZERO_BYTES bytes of virtual
-   memory are initialized, as follows:
-        - READ_BYTES bytes at UPAGE must be read from FILE
-          starting at offset OFS.
-        - ZERO_BYTES bytes at UPAGE + READ_BYTES must be zeroed.
+/* Loads segment SEG of IMAGE, which was parsed from FILE.  In
+   total, SEG->READ_BYTES + SEG->ZERO_BYTES bytes of virtual
+   memory are initialized at SEG->MEM_PAGE, as follows:
+        - SEG->READ_BYTES bytes must be read from FILE starting
+          at offset SEG->FILE_PAGE, or copied from IMAGE's page
+          cache.
+        - SEG->ZERO_BYTES bytes after those must be zeroed.
    The pages initialized by this function must be writable by the
-   user process if WRITABLE is true, read-only otherwise.
+   user process if SEG->WRITABLE is true, read-only otherwise.
+   *PAGE_IDX is the index within IMAGE of the segment's first
+   page, and is advanced past its last page.  If FILL_CACHE is
+   true, the data read from FILE is added to IMAGE's page cache.
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
 static bool
-load_segment (struct file *file, off_t ofs, uint8_t *upage,
-              uint32_t read_bytes, uint32_t zero_bytes, bool writable) 
+load_segment (struct file *file, struct exec_image *image,
+              const struct exec_segment *seg, size_t *page_idx,
+              bool fill_cache) 
 {
+  uint32_t read_bytes = seg->read_bytes;
+  uint32_t zero_bytes = seg->zero_bytes;
+  uint8_t *upage = seg->mem_page;
+  off_t ofs = seg->file_page;
+
   ASSERT ((read_bytes + zero_bytes) % PGSIZE == 0);
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
-  file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
       /* Do calculate how to fill this page.
@@ -612,6 +1073,7 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
          and zero the final PAGE_ZERO_BYTES bytes. */
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
+      const uint8_t *cached = exec_image_get_page (image, *page_idx);
 
       /* Get a page of memory. */
       uint8_t *kpage = palloc_get_page (PAL_USER);
@@ -619,15 +1081,20 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
         return false;
 
       /* Load this page. */
-      if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
+      if (cached != NULL)
+        memcpy (kpage, cached, page_read_bytes);
+      else if (file_read_at (file, kpage, page_read_bytes, ofs)
+               != (int) page_read_bytes)
         {
           palloc_free_page (kpage);
           return false; 
         }
+      else if (fill_cache)
+        exec_image_put_page (image, *page_idx, kpage, page_read_bytes);
       memset (kpage + page_read_bytes, 0, page_zero_bytes);
 
       /* Add the page to the process's address space. */
-      if (!install_page (upage, kpage, writable)) 
+      if (!install_page (upage, kpage, seg->writable)) 
         {
           palloc_free_page (kpage);
           return false; 
@@ -637,6 +1104,8 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
       upage += PGSIZE;
+      ofs += PGSIZE;
+      (*page_idx)++;
     }
   return true;
 }
@@ -702,8 +1171,6 @@ void validate_addr_syscall (struct intr_frame *f, void *fault_addr)
   if (fault_addr == NULL
     || !is_user_vaddr(fault_addr))
   {
-    if(lock_held_by_current_thread(&file_lock))
-      lock_release(&file_lock);
     syscall_exit (-1);
   }
 
@@ -3,9 +3,38 @@
 
 #include "threads/thread.h"
 
+extern bool process_print_rusage;
+
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
 
+/* Maximum number of threads spawned by a process at once. */
+#define UTHREAD_MAX 16
+
+/* A thread created by process_spawn(), as seen by the other
+   threads of its process.  Lives in the leader's uthreads list
+   until it is joined or the process exits. */
+struct uthread
+  {
+    tid_t tid;                  /* Thread identifier. */
+    struct thread *leader;      /* Leader of the thread's process. */
+    int slot;                   /* User stack slot, 1...UTHREAD_MAX. */
+    void (*eip) (void);         /* User entry point. */
+    void *func;                 /* First argument to EIP. */
+    void *aux;                  /* Second argument to EIP. */
+    bool exited;                /* Has the thread exited? */
+    bool joined;                /* Has someone started joining it? */
+    int status;                 /* Exit status, once exited. */
+    struct semaphore done;      /* Upped when the thread exits. */
+    struct list_elem elem;      /* Element in leader's uthreads. */
+  };
+
+tid_t process_spawn (void (*eip) (void), void *func, void *aux);
+int process_join (tid_t);
+void process_thread_exit (int status) NO_RETURN;
+void process_set_exiting (struct thread *leader);
+void process_exit_threads (void);
+
 #endif /* userprog/process.h */
@@ -0,0 +1,288 @@
+#include "userprog/shm.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/aio.h"
+#include "userprog/pagedir.h"
+
+/* Named shared memory segments.
+
+   A segment is a set of zeroed user pool pages, created by the
+   first process that attaches a name and mapped into the page
+   directory of every process that attaches it, possibly at
+   different virtual addresses.  The segment counts its
+   attachments; its pages are freed when the last one goes away,
+   whether by shm_detach() or by process exit.
+
+   An attached page is owned by the segment, not by the page
+   directory it is mapped in, so every attachment must be
+   unmapped before pagedir_destroy() would free its pages. */
+
+struct shm_segment
+  {
+    struct list_elem elem;      /* Element in segments. */
+    char name[SHM_NAME_MAX + 1]; /* Name, null-terminated. */
+    size_t page_cnt;            /* Number of pages. */
+    void **pages;               /* Kernel address of each page. */
+    int ref_cnt;                /* Number of attachments. */
+  };
+
+/* A segment mapped into a process. */
+struct shm_attachment
+  {
+    struct list_elem elem;      /* Element in attachments. */
+    struct thread *owner;       /* Leader of the process. */
+    void *addr;                 /* User virtual address of page 0. */
+    size_t page_cnt;            /* Number of pages mapped. */
+    struct shm_segment *seg;    /* The segment. */
+  };
+
+static struct list segments;    /* All segments. */
+static struct list attachments; /* All attachments. */
+static struct lock shm_lock;    /* Protects both lists. */
+
+static struct shm_segment *segment_create (const char *name,
+                                           size_t page_cnt);
+static void segment_destroy (struct shm_segment *);
+static void detach (struct shm_attachment *);
+
+/* Initializes the shared memory module. */
+void
+shm_init (void)
+{
+  list_init (&segments);
+  list_init (&attachments);
+  lock_init (&shm_lock);
+}
+
+/* Maps SIZE bytes of the segment named NAME into the current
+   process at page-aligned user address ADDR, creating the
+   segment if no process has it attached.  Returns false if
+   the segment exists but is smaller than SIZE, if any page in
+   the range is already mapped, or if memory is exhausted. */
+bool
+shm_attach (const char *name, void *addr, size_t size)
+{
+  struct thread *t = thread_current ()->leader;
+  struct shm_segment *seg = NULL;
+  struct shm_attachment *a;
+  size_t page_cnt = DIV_ROUND_UP (size, PGSIZE);
+  struct list_elem *e;
+  size_t i;
+
+  if (strlen (name) > SHM_NAME_MAX || size == 0
+      || addr == NULL || !is_user_vaddr (addr) || pg_ofs (addr) != 0
+      || size > (uintptr_t) PHYS_BASE - (uintptr_t) addr
+      || page_cnt > ((uintptr_t) PHYS_BASE - (uintptr_t) addr) / PGSIZE)
+    return false;
+  for (i = 0; i < page_cnt; i++)
+    if (pagedir_get_page (t->pagedir, addr + i * PGSIZE) != NULL)
+      return false;
+
+  a = malloc (sizeof *a);
+  if (a == NULL)
+    return false;
+
+  lock_acquire (&shm_lock);
+  for (e = list_begin (&segments); e != list_end (&segments);
+       e = list_next (e))
+    if (!strcmp (list_entry (e, struct shm_segment, elem)->name, name))
+      {
+        seg = list_entry (e, struct shm_segment, elem);
+        break;
+      }
+  if (seg == NULL)
+    seg = segment_create (name, page_cnt);
+  if (seg == NULL || seg->page_cnt < page_cnt)
+    goto fail;
+
+  for (i = 0; i < page_cnt; i++)
+    if (!pagedir_set_page (t->pagedir, addr + i * PGSIZE,
+                           seg->pages[i], true))
+      {
+        while (i-- > 0)
+          pagedir_clear_page (t->pagedir, addr + i * PGSIZE);
+        goto fail;
+      }
+
+  a->owner = t;
+  a->addr = addr;
+  a->page_cnt = page_cnt;
+  a->seg = seg;
+  seg->ref_cnt++;
+  list_push_back (&attachments, &a->elem);
+  lock_release (&shm_lock);
+  return true;
+
+ fail:
+  /* Don't keep a segment that was just created. */
+  if (seg != NULL && seg->ref_cnt == 0)
+    segment_destroy (seg);
+  free (a);
+  lock_release (&shm_lock);
+  return false;
+}
+
+/* Unmaps the segment attached at ADDR from the current process.
+   Returns false if no segment is attached there, or if
+   asynchronous I/O to part of it has not finished. */
+bool
+shm_detach (void *addr)
+{
+  struct thread *t = thread_current ()->leader;
+  struct list_elem *e;
+  bool success = false;
+
+  lock_acquire (&shm_lock);
+  for (e = list_begin (&attachments); e != list_end (&attachments);
+       e = list_next (e))
+    {
+      struct shm_attachment *a = list_entry (e, struct shm_attachment, elem);
+      if (a->owner == t && a->addr == addr)
+        {
+          size_t i;
+
+          /* An aio worker may be using one of the pages, which
+             detaching could free. */
+          aio_lock_pages ();
+          for (i = 0; i < a->page_cnt; i++)
+            if (aio_page_busy (t, a->addr + i * PGSIZE))
+              break;
+          if (i == a->page_cnt)
+            {
+              list_remove (&a->elem);
+              detach (a);
+              success = true;
+            }
+          aio_unlock_pages ();
+          break;
+        }
+    }
+  lock_release (&shm_lock);
+  return success;
+}
+
+/* Unmaps every segment attached to the current process.  Called
+   on process exit, before the page directory is destroyed. */
+void
+shm_detach_all (void)
+{
+  struct thread *t = thread_current ()->leader;
+  struct list_elem *e;
+
+  lock_acquire (&shm_lock);
+  for (e = list_begin (&attachments); e != list_end (&attachments); )
+    {
+      struct shm_attachment *a = list_entry (e, struct shm_attachment, elem);
+      e = list_next (e);
+      if (a->owner == t)
+        {
+          list_remove (&a->elem);
+          detach (a);
+        }
+    }
+  lock_release (&shm_lock);
+}
+
+/* Returns true if user page UPAGE of the process led by T is
+   part of an attached segment. */
+bool
+shm_is_attached (struct thread *t, const void *upage)
+{
+  struct list_elem *e;
+  bool found = false;
+
+  lock_acquire (&shm_lock);
+  for (e = list_begin (&attachments); e != list_end (&attachments);
+       e = list_next (e))
+    {
+      struct shm_attachment *a = list_entry (e, struct shm_attachment, elem);
+      if (a->owner == t && upage >= a->addr
+          && upage < a->addr + a->page_cnt * PGSIZE)
+        {
+          found = true;
+          break;
+        }
+    }
+  lock_release (&shm_lock);
+  return found;
+}
+
+/* Creates a segment named NAME with PAGE_CNT zeroed pages and
+   no attachments, and adds it to the list of segments.  Returns
+   the segment, or a null pointer if memory is exhausted. */
+static struct shm_segment *
+segment_create (const char *name, size_t page_cnt)
+{
+  struct shm_segment *seg;
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&shm_lock));
+
+  seg = malloc (sizeof *seg);
+  if (seg == NULL)
+    return NULL;
+  seg->pages = calloc (page_cnt, sizeof *seg->pages);
+  if (seg->pages == NULL)
+    {
+      free (seg);
+      return NULL;
+    }
+  strlcpy (seg->name, name, sizeof seg->name);
+  seg->page_cnt = page_cnt;
+  seg->ref_cnt = 0;
+  list_push_back (&segments, &seg->elem);
+
+  for (i = 0; i < page_cnt; i++)
+    {
+      seg->pages[i] = palloc_get_page (PAL_USER | PAL_ZERO);
+      if (seg->pages[i] == NULL)
+        {
+          /* Too small for the caller, who destroys it. */
+          seg->page_cnt = i;
+          break;
+        }
+    }
+  return seg;
+}
+
+/* Unmaps attachment A, which has been removed from the list of
+   attachments, from its owner's page directory and frees it,
+   along with its segment if that was the last attachment. */
+static void
+detach (struct shm_attachment *a)
+{
+  struct shm_segment *seg = a->seg;
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&shm_lock));
+
+  for (i = 0; i < a->page_cnt; i++)
+    pagedir_clear_page (a->owner->pagedir, a->addr + i * PGSIZE);
+  free (a);
+
+  if (--seg->ref_cnt == 0)
+    segment_destroy (seg);
+}
+
+/* Removes SEG, which has no attachments, from the list of
+   segments and frees it and its pages. */
+static void
+segment_destroy (struct shm_segment *seg)
+{
+  size_t i;
+
+  ASSERT (seg->ref_cnt == 0);
+
+  list_remove (&seg->elem);
+  for (i = 0; i < seg->page_cnt; i++)
+    palloc_free_page (seg->pages[i]);
+  free (seg->pages);
+  free (seg);
+}
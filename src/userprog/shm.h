@@ -0,0 +1,18 @@
+#ifndef USERPROG_SHM_H
+#define USERPROG_SHM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct thread;
+
+/* Maximum length of a shared memory segment's name. */
+#define SHM_NAME_MAX 31
+
+void shm_init (void);
+bool shm_attach (const char *name, void *addr, size_t size);
+bool shm_detach (void *addr);
+void shm_detach_all (void);
+bool shm_is_attached (struct thread *, const void *upage);
+
+#endif /* userprog/shm.h */
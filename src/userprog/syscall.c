@@ -1,12 +1,31 @@
 #include "userprog/syscall.h"
+#include <aio.h>
+#include <resource.h>
+#include <round.h>
 #include <stdio.h>
 #include <syscall-nr.h>
+#include <sysstat.h>
+#include <time.h>
+#include "devices/clock.h"
+#include "devices/block.h"
+#include "devices/timer.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
 #include "filesys/off_t.h"
 #include "filesys/file.h"
+#include "filesys/filesys.h"
 #include "filesys/inode.h"
+#include "filesys/directory.h"
 #include "threads/vaddr.h"
+#include "userprog/aio.h"
+#include "userprog/exception.h"
+#include "userprog/futex.h"
+#include "userprog/ipc.h"
+#include "userprog/pagedir.h"
+#include "userprog/pipe.h"
+#include "userprog/process.h"
+#include "userprog/shm.h"
 
 static void syscall_handler (struct intr_frame *);
 
@@ -29,6 +48,23 @@ bool syscall_isdir (int fd);
 bool syscall_readdir (int fd, char *name);
 bool syscall_chdir (const char *dir);
 bool syscall_mkdir (const char *dir);
+int syscall_clock_gettime (int clock_id, struct timespec *ts);
+tid_t syscall_thread_spawn (void (*eip) (void), void *func, void *aux);
+int syscall_thread_join (tid_t tid);
+void syscall_thread_exit (int status);
+bool syscall_rt_reserve (unsigned runtime_ms, unsigned period_ms);
+int syscall_getrusage (int who, struct rusage *usage);
+int syscall_sysstat (struct sysstat *st);
+int syscall_pipe (int *fds);
+int syscall_dup2 (int old_fd, int new_fd);
+bool syscall_shm_attach (const char *name, void *addr, unsigned size);
+bool syscall_shm_detach (void *addr);
+int syscall_futex_wait (int *addr, int val);
+int syscall_futex_wake (int *addr, int cnt);
+int syscall_msg_send (tid_t pid, const void *buffer, unsigned size);
+int syscall_msg_receive (void *buffer, unsigned size);
+int syscall_aio_submit (struct aiocb *cb);
+struct aiocb *syscall_aio_wait (void);
 
 uint32_t
 get_argument (uint32_t *sp) {
@@ -39,7 +75,7 @@ get_argument (uint32_t *sp) {
 
 struct file*
 get_file (int fd) {
-  struct thread *curr = thread_current ();
+  struct thread *curr = thread_current ()->leader;
   struct list_elem *i;
 
   for (i=list_begin (&curr->files); i!=list_end (&curr->files); i=list_next(i)) {
@@ -53,7 +89,7 @@ get_file (int fd) {
 }
 
 struct file_elem* get_file_elem (int fd) {
-  struct thread *curr = thread_current ();
+  struct thread *curr = thread_current ()->leader;
   struct list_elem *i;
 
   for (i=list_begin (&curr->files); i!=list_end (&curr->files); i=list_next(i)) {
@@ -66,6 +102,22 @@ struct file_elem* get_file_elem (int fd) {
   return NULL;
 }
 
+/* Terminates the calling thread if another thread of its process
+   has started to exit the process.  Called on the way into and
+   out of each system call, and by intr_handler() when an
+   external interrupt arrives while user code runs. */
+void
+syscall_check_exiting (void)
+{
+  struct thread *leader = thread_current ()->leader;
+
+  if (leader->exiting)
+    {
+      intr_enable ();
+      syscall_exit (leader->exit_status);
+    }
+}
+
 void
 syscall_init (void) 
 {
@@ -79,6 +131,9 @@ syscall_handler (struct intr_frame *f)
   uint32_t *argv[5];
   uint32_t *sp = f->esp;
   validate_addr (sp);
+  syscall_check_exiting ();
+  TRACE (TRACE_SYSCALL_ENTER, *sp, f->eip);
+  thread_usage ()->syscall_cnt++;
 
   switch (*sp) {
     case SYS_HALT :
@@ -177,9 +232,113 @@ syscall_handler (struct intr_frame *f)
       f->eax = syscall_inumber ((int) *argv[0]);
       break;
 
+    case SYS_CLOCK_GETTIME :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_clock_gettime ((int) *argv[0], (struct timespec *) *argv[1]);
+      break;
+
+    case SYS_THREAD_SPAWN :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      argv[2] = get_argument (sp+2);
+      f->eax = syscall_thread_spawn ((void (*) (void)) *argv[0], (void *) *argv[1], (void *) *argv[2]);
+      break;
+
+    case SYS_THREAD_JOIN :
+      argv[0] = get_argument (sp);
+      f->eax = syscall_thread_join ((tid_t) *argv[0]);
+      break;
+
+    case SYS_THREAD_EXIT :
+      argv[0] = get_argument (sp);
+      syscall_thread_exit ((int) *argv[0]);
+      break;
+
+    case SYS_RT_RESERVE :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_rt_reserve ((unsigned) *argv[0], (unsigned) *argv[1]);
+      break;
+
+    case SYS_RT_WAIT :
+      thread_rt_wait ();
+      break;
+
+    case SYS_GETRUSAGE :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_getrusage ((int) *argv[0], (struct rusage *) *argv[1]);
+      break;
+
+    case SYS_SYSSTAT :
+      argv[0] = get_argument (sp);
+      f->eax = syscall_sysstat ((struct sysstat *) *argv[0]);
+      break;
+
+    case SYS_PIPE :
+      argv[0] = get_argument (sp);
+      f->eax = syscall_pipe ((int *) *argv[0]);
+      break;
+
+    case SYS_DUP2 :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_dup2 ((int) *argv[0], (int) *argv[1]);
+      break;
+
+    case SYS_SHM_ATTACH :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      argv[2] = get_argument (sp+2);
+      f->eax = syscall_shm_attach ((const char *) *argv[0], (void *) *argv[1], (unsigned) *argv[2]);
+      break;
+
+    case SYS_SHM_DETACH :
+      argv[0] = get_argument (sp);
+      f->eax = syscall_shm_detach ((void *) *argv[0]);
+      break;
+
+    case SYS_FUTEX_WAIT :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_futex_wait ((int *) *argv[0], (int) *argv[1]);
+      break;
+
+    case SYS_FUTEX_WAKE :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_futex_wake ((int *) *argv[0], (int) *argv[1]);
+      break;
+
+    case SYS_MSG_SEND :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      argv[2] = get_argument (sp+2);
+      f->eax = syscall_msg_send ((tid_t) *argv[0], (const void *) *argv[1], (unsigned) *argv[2]);
+      break;
+
+    case SYS_MSG_RECEIVE :
+      argv[0] = get_argument (sp);
+      argv[1] = get_argument (sp+1);
+      f->eax = syscall_msg_receive ((void *) *argv[0], (unsigned) *argv[1]);
+      break;
+
+    case SYS_AIO_SUBMIT :
+      argv[0] = get_argument (sp);
+      f->eax = syscall_aio_submit ((struct aiocb *) *argv[0]);
+      break;
+
+    case SYS_AIO_WAIT :
+      f->eax = (uint32_t) syscall_aio_wait ();
+      break;
+
     default :
       break;
   }
+
+  TRACE (TRACE_SYSCALL_EXIT, *sp, f->eax);
+  syscall_check_exiting ();
 }
 
 void
@@ -188,6 +347,20 @@ syscall_exit (int status) {
   curr = thread_current ();
   curr->exit_status = status;
 
+  /* exit() in any thread ends the whole process. */
+  if (curr->leader != curr)
+    {
+      curr->leader->exit_status = status;
+      process_set_exiting (curr->leader);
+      process_thread_exit (status);
+    }
+
+  /* Our other threads may need file_lock to get to the point
+     where they notice that we're exiting, so no path that holds
+     it may exit. */
+  ASSERT (!lock_held_by_current_thread (&file_lock));
+  process_exit_threads ();
+
   struct list_elem *t_elem;
     struct child_elem *t;
 
@@ -203,12 +376,18 @@ syscall_exit (int status) {
       free (t);
     }
 
+    lock_acquire (&file_lock);
     while (!list_empty (&curr->files)) {
       f_elem = list_pop_front (&curr->files);
       f = list_entry (f_elem, struct file_elem, elem);
-      free (f->file);
+      file_close (f->file);
+      if (f->dir != NULL)
+        dir_close (f->dir);
+      if (f->pipe != NULL)
+        pipe_close_end (f->pipe, f->pipe_write);
       free (f);
     }
+    lock_release (&file_lock);
 
   thread_exit ();
 }
@@ -235,8 +414,8 @@ syscall_create (const char *file, unsigned initial_size) {
 
 bool
 syscall_remove (const char *file) {
-  lock_acquire(&file_lock);
   validate_addr ((void *) file);
+  lock_acquire(&file_lock);
   bool success = filesys_remove (file);
   lock_release(&file_lock);
   return success;
@@ -246,7 +425,7 @@ int
 syscall_open (const char *filename) {
   validate_addr ((void *) filename);
 
-  struct thread *t = thread_current ();
+  struct thread *t = thread_current ()->leader;
   struct file_elem *f;
   f = malloc (sizeof (struct file_elem));
 
@@ -258,23 +437,32 @@ syscall_open (const char *filename) {
   }
 
   struct inode *inode = file_get_inode (f->file);
-  if (inode->data.is_dir == DIR) f->dir = dir_open (inode_reopen (inode));
+  if (inode != NULL && inode->data.is_dir == DIR) f->dir = dir_open (inode_reopen (inode));
   else f->dir = NULL;
+  f->pipe = NULL;
+  f->pipe_write = false;
 
-  f->fd = t->next_fd;
   //printf("%s %d\n", filename, strlen(filename));
   strlcpy(f->name, filename, strlen(filename) + 1); // filename 저장
   //printf("%s\n", f->name);
+
+  // 같은 process의 thread들이 descriptor table을 공유하므로 lock을 잡는다.
+  lock_acquire(&file_lock);
+  f->fd = t->next_fd;
   t->next_fd++;
   list_push_back (&t->files, &f->elem);
+  lock_release(&file_lock);
 
   return f->fd;
 }
 
 int
 syscall_filesize (int fd) {
+  struct file *file = get_file (fd);
+  if (file == NULL) return -1;
+
   lock_acquire(&file_lock);
-  int length = file_length (get_file (fd));
+  int length = file_length (file);
   lock_release(&file_lock);
 
   return length;
@@ -290,6 +478,14 @@ syscall_read (struct intr_frame *f, int fd, const void *buffer, unsigned size) {
   validate_addr_syscall (f, (void *) buffer);
   validate_addr_syscall (f, (void *)(buffer + size));
 
+  /* A pipe end, which may also stand in for the console. */
+  struct file_elem *elem = get_file_elem (fd);
+  if (elem != NULL && elem->pipe != NULL)
+    {
+      if (elem->pipe_write) return -1;
+      return pipe_read (elem->pipe, (void *) buffer, size);
+    }
+
   if (fd == 1) syscall_exit (-1);
 
   int value = -1;
@@ -334,6 +530,13 @@ syscall_write (struct intr_frame *f, int fd, const void *buffer, unsigned size)
 
   int value = -1;
 
+  struct file_elem *elem = get_file_elem (fd);
+  if (elem != NULL && elem->pipe != NULL)
+    {
+      if (!elem->pipe_write) return -1;
+      return pipe_write (elem->pipe, buffer, size);
+    }
+
   if (fd == 0) syscall_exit (-1);
 
   if (fd == 1) {
@@ -342,7 +545,8 @@ syscall_write (struct intr_frame *f, int fd, const void *buffer, unsigned size)
   } else {
     struct file *targetFile = get_file(fd);
     if (targetFile == NULL) syscall_exit (-1);
-    if (targetFile->inode->data.is_dir == DIR) return -1;
+    if (targetFile->inode == NULL && targetFile->tmpfs == NULL) return -1;
+    if (targetFile->inode != NULL && targetFile->inode->data.is_dir == DIR) return -1;
 
     lock_acquire (&file_lock);
     value  = file_write(targetFile, buffer, (off_t) size);
@@ -381,13 +585,25 @@ syscall_tell (int fd) {
 
 void
 syscall_close (int fd) {
-  if (fd == 1 || fd == 0)
-    syscall_exit (-1);
-
   struct file_elem *f_elem;
   struct file *f;
 
+  /* Closing a pipe end that replaced the console restores the
+     console. */
   f_elem = get_file_elem (fd);
+  if (f_elem != NULL && f_elem->pipe != NULL)
+    {
+      lock_acquire (&file_lock);
+      list_remove (&f_elem->elem);
+      lock_release (&file_lock);
+      pipe_close_end (f_elem->pipe, f_elem->pipe_write);
+      free (f_elem);
+      return;
+    }
+
+  if (fd == 1 || fd == 0)
+    syscall_exit (-1);
+
   f = get_file (fd);
 
   if (f == NULL && f_elem != NULL)
@@ -398,9 +614,8 @@ syscall_close (int fd) {
     syscall_exit (-1);
   }
   
-  list_remove (&f_elem->elem);
-
   lock_acquire (&file_lock);
+  list_remove (&f_elem->elem);
   file_close (f);
   if(f_elem->dir != NULL)
     dir_close (f_elem->dir);
@@ -418,15 +633,26 @@ bool syscall_chdir (const char *dir)
   struct inode *inode;
   struct dir *curr;
 
-  curr = parse_directory (dir, false);
+  curr = parse_directory ((char *) dir, false);
   if (curr == NULL)
   {
     lock_release(&file_lock);
     return false;
   }
 
+  /* Mount lookups resolve relative names against this path. */
+  char *path = filesys_absolute_path (dir);
+  if (path == NULL)
+  {
+    dir_close (curr);
+    lock_release(&file_lock);
+    return false;
+  }
+
   if (thread_current ()->curr_dir) dir_close (thread_current ()->curr_dir);
   thread_current ()->curr_dir = curr;
+  free (thread_current ()->cwd_path);
+  thread_current ()->cwd_path = path;
 
   lock_release(&file_lock);
   return true;
@@ -438,17 +664,17 @@ bool syscall_mkdir (const char *dir)
 
   if(strlen(dir) == 0)
   {
+    lock_release(&file_lock);
     return false;
   }
-  if(dir == '\0') return false;
 
-  struct dir *parent_dir = parse_directory(dir, true);
+  struct dir *parent_dir = parse_directory((char *) dir, true);
   if(parent_dir == NULL){
     lock_release(&file_lock);
     return false;
   }
 
-  char *new_dir_name = parse_name(dir);
+  char *new_dir_name = parse_name((char *) dir);
   if(strlen(new_dir_name) == 0)
   {
     dir_close(parent_dir);
@@ -468,6 +694,9 @@ bool syscall_mkdir (const char *dir)
   else
   {
     //free_map_release(&inode_sector, 1);
+    dir_close(parent_dir);
+    free(new_dir_name);
+    lock_release(&file_lock);
     return false;
   }
 
@@ -487,6 +716,16 @@ bool syscall_readdir (int fd, char *name)
   struct file_elem *f = get_file_elem (fd);
   if(f == NULL) return false;
 
+  /* /proc and /tmp have no inodes; their entries come from the
+     file. */
+  if (f->file != NULL && f->file->inode == NULL)
+    {
+      if (!f->file->buffer_is_dir) return false;
+      validate_addr ((void *) name);
+      validate_addr ((void *) (name + NAME_MAX));
+      return file_readdir (f->file, name, NAME_MAX + 1);
+    }
+
   struct dir *dir = f->dir;
 
   if (dir == NULL) return false;
@@ -502,7 +741,8 @@ bool syscall_readdir (int fd, char *name)
 bool syscall_isdir (int fd)
 {
   struct file_elem *f = get_file_elem (fd);
-  if (f->file == NULL) return false;
+  if (f == NULL || f->file == NULL) return false;
+  if (f->file->inode == NULL) return f->file->buffer_is_dir;
   if (f->dir == NULL) return false;
   return true;
 }
@@ -512,7 +752,267 @@ int syscall_inumber (int fd)
   struct file *file = get_file (fd);
   if (file == NULL) return -1;
   struct inode *inode = file_get_inode(file);
+  if (inode == NULL) return -1;
 
   return inode->sector;
 }
 
+int syscall_clock_gettime (int clock_id, struct timespec *ts)
+{
+  validate_addr ((void *) ts);
+  validate_addr ((void *) (ts + 1) - 1);
+
+  if (clock_id != CLOCK_MONOTONIC)
+    return -1;
+
+  int64_t ns = clock_ns ();
+  ts->tv_sec = ns / NSEC_PER_SEC;
+  ts->tv_nsec = ns % NSEC_PER_SEC;
+  return 0;
+}
+
+tid_t syscall_thread_spawn (void (*eip) (void), void *func, void *aux)
+{
+  return process_spawn (eip, func, aux);
+}
+
+int syscall_thread_join (tid_t tid)
+{
+  return process_join (tid);
+}
+
+void syscall_thread_exit (int status)
+{
+  if (thread_current ()->leader == thread_current ())
+    syscall_exit (status);
+  process_thread_exit (status);
+}
+
+/* Converts the reservation to timer ticks, rounding up so that a
+   short runtime still gets at least one tick. */
+bool syscall_rt_reserve (unsigned runtime_ms, unsigned period_ms)
+{
+  int64_t runtime = DIV_ROUND_UP ((int64_t) runtime_ms * TIMER_FREQ, 1000);
+  int64_t period = DIV_ROUND_UP ((int64_t) period_ms * TIMER_FREQ, 1000);
+
+  return thread_set_rt (runtime, period);
+}
+
+int syscall_getrusage (int who, struct rusage *usage)
+{
+  struct thread *leader = thread_current ()->leader;
+  const struct usage *u;
+
+  validate_addr ((void *) usage);
+  validate_addr ((void *) (usage + 1) - 1);
+
+  if (who == RUSAGE_SELF)
+    u = &leader->usage;
+  else if (who == RUSAGE_CHILDREN)
+    u = &leader->child_usage;
+  else
+    return -1;
+
+  usage->ru_utime.tv_sec = u->user_ticks / TIMER_FREQ;
+  usage->ru_utime.tv_nsec = u->user_ticks % TIMER_FREQ * (NSEC_PER_SEC / TIMER_FREQ);
+  usage->ru_stime.tv_sec = u->kernel_ticks / TIMER_FREQ;
+  usage->ru_stime.tv_nsec = u->kernel_ticks % TIMER_FREQ * (NSEC_PER_SEC / TIMER_FREQ);
+  usage->ru_minflt = u->fault_cnt - u->major_fault_cnt;
+  usage->ru_majflt = u->major_fault_cnt;
+  usage->ru_inblock = u->read_cnt;
+  usage->ru_oublock = u->write_cnt;
+  usage->ru_nsyscalls = u->syscall_cnt;
+  return 0;
+}
+
+int syscall_sysstat (struct sysstat *st)
+{
+  validate_addr ((void *) st);
+  validate_addr ((void *) (st + 1) - 1);
+
+  st->ticks = timer_ticks ();
+  block_get_stats (filesys_disk, &st->fs_reads, &st->fs_writes);
+  st->page_faults = exception_page_fault_cnt ();
+  return 0;
+}
+
+/* Adds a descriptor for the read end of pipe P, or its write end
+   if WRITER is true, to the current process.  If FD is
+   nonnegative, the descriptor gets that number, which must not
+   be in use; otherwise it gets the next unused number.  Returns
+   the descriptor, or -1 if memory is exhausted. */
+static int
+add_pipe_fd (struct pipe *p, bool writer, int fd)
+{
+  struct thread *t = thread_current ()->leader;
+  struct file_elem *f = malloc (sizeof *f);
+  if (f == NULL)
+    return -1;
+
+  f->file = NULL;
+  f->dir = NULL;
+  f->name[0] = '\0';
+  f->pipe = p;
+  f->pipe_write = writer;
+
+  lock_acquire (&file_lock);
+  if (fd < 0)
+    fd = t->next_fd++;
+  else if (fd >= t->next_fd)
+    t->next_fd = fd + 1;
+  f->fd = fd;
+  list_push_back (&t->files, &f->elem);
+  lock_release (&file_lock);
+
+  return fd;
+}
+
+int syscall_pipe (int *fds)
+{
+  struct pipe *p;
+
+  validate_addr ((void *) fds);
+  validate_addr ((void *) (fds + 2) - 1);
+
+  p = pipe_create ();
+  if (p == NULL)
+    return -1;
+
+  fds[0] = add_pipe_fd (p, false, -1);
+  if (fds[0] < 0)
+    {
+      pipe_close_end (p, false);
+      pipe_close_end (p, true);
+      return -1;
+    }
+  fds[1] = add_pipe_fd (p, true, -1);
+  if (fds[1] < 0)
+    {
+      syscall_close (fds[0]);
+      pipe_close_end (p, true);
+      return -1;
+    }
+  return 0;
+}
+
+/* Makes NEW_FD refer to the same pipe end as OLD_FD, closing
+   NEW_FD first if it is open.  NEW_FD may be 0 or 1, in which
+   case the pipe end stands in for the console until it is
+   closed.  Only pipe descriptors can be duplicated. */
+int syscall_dup2 (int old_fd, int new_fd)
+{
+  struct file_elem *old = get_file_elem (old_fd);
+
+  if (old == NULL || old->pipe == NULL || new_fd < 0)
+    return -1;
+  if (old_fd == new_fd)
+    return new_fd;
+
+  if (get_file_elem (new_fd) != NULL)
+    syscall_close (new_fd);
+  pipe_open_end (old->pipe, old->pipe_write);
+  if (add_pipe_fd (old->pipe, old->pipe_write, new_fd) < 0)
+    {
+      pipe_close_end (old->pipe, old->pipe_write);
+      return -1;
+    }
+  return new_fd;
+}
+
+bool syscall_shm_attach (const char *name, void *addr, unsigned size)
+{
+  validate_addr ((void *) name);
+  return shm_attach (name, addr, size);
+}
+
+bool syscall_shm_detach (void *addr)
+{
+  return shm_detach (addr);
+}
+
+/* Returns the kernel address of the futex word at user address
+   ADDR, terminating the process if ADDR is not a mapped,
+   aligned int. */
+static const int *
+futex_word (int *addr)
+{
+  if ((uintptr_t) addr % sizeof *addr != 0)
+    syscall_exit (-1);
+  validate_addr ((void *) addr);
+  return pagedir_get_page (thread_current ()->pagedir, addr);
+}
+
+int syscall_futex_wait (int *addr, int val)
+{
+  return futex_wait (futex_word (addr), val);
+}
+
+int syscall_futex_wake (int *addr, int cnt)
+{
+  return futex_wake (futex_word (addr), cnt);
+}
+
+/* Terminates the process unless all SIZE bytes at BUFFER are
+   mapped, and writable if WRITABLE is true. */
+static void
+validate_buffer (const void *buffer, unsigned size, bool writable)
+{
+  uint32_t *pd = thread_current ()->pagedir;
+  const uint8_t *page;
+
+  if (size == 0)
+    return;
+  if ((const uint8_t *) buffer + size < (const uint8_t *) buffer)
+    syscall_exit (-1);
+  for (page = pg_round_down (buffer);
+       page < (const uint8_t *) buffer + size; page += PGSIZE)
+    {
+      validate_addr ((void *) page);
+      if (writable && !pagedir_is_writable (pd, page))
+        syscall_exit (-1);
+    }
+}
+
+int syscall_msg_send (tid_t pid, const void *buffer, unsigned size)
+{
+  validate_buffer (buffer, size, false);
+  return ipc_send (pid, buffer, size);
+}
+
+int syscall_msg_receive (void *buffer, unsigned size)
+{
+  validate_buffer (buffer, size, true);
+  return ipc_receive (buffer, size);
+}
+
+int syscall_aio_submit (struct aiocb *cb)
+{
+  struct file_elem *f;
+
+  validate_buffer (cb, sizeof *cb, true);
+  if (cb->op != AIO_READ && cb->op != AIO_WRITE)
+    return -1;
+
+  /* Only regular files, not pipes, directories or /proc. */
+  f = get_file_elem (cb->fd);
+  if (f == NULL || f->file == NULL || f->dir != NULL
+      || (f->file->inode == NULL && f->file->tmpfs == NULL))
+    return -1;
+  validate_buffer (cb->buffer, cb->size, cb->op == AIO_READ);
+
+  return aio_submit (cb, f->file, cb->op, cb->buffer, cb->size,
+                     cb->offset) ? 0 : -1;
+}
+
+struct aiocb *syscall_aio_wait (void)
+{
+  int result;
+  struct aiocb *cb = aio_wait (&result);
+
+  if (cb != NULL)
+    {
+      validate_buffer (cb, sizeof *cb, true);
+      cb->result = result;
+    }
+  return cb;
+}
@@ -4,5 +4,6 @@
 void syscall_init (void);
 
 void syscall_exit (int status);
+void syscall_check_exiting (void);
 
 #endif /* userprog/syscall.h */
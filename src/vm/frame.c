@@ -3,6 +3,7 @@
 #include "threads/malloc.h"
 #include "threads/pte.h"
 #include "threads/palloc.h"
+#include "threads/trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <list.h>
@@ -151,6 +152,7 @@ void* frame_evict()
 
 	struct spage *spe = f->spe;
 
+	TRACE (TRACE_FRAME_EVICT, f->addr, spe->vaddr);
 	pagedir_clear_page (t->pagedir, spe->vaddr);
 
 	if(spe->status == MM_FILE)
@@ -1,7 +1,9 @@
 #include "vm/frame.h"
 #include "vm/swap.h"
 #include "vm/page.h"
-#include "devices/disk.h"
+#include "devices/block.h"
+#include "threads/thread.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #include <bitmap.h>
 #include <stdio.h>
@@ -17,8 +19,8 @@ extern struct lock file_lock;
 void
 swap_init ()
 {
-	swap_disk = disk_get (1,1);
-	swap_bitmap = bitmap_create (disk_size (swap_disk));
+	swap_disk = block_get_role (BLOCK_SWAP);
+	swap_bitmap = bitmap_create (block_size (swap_disk));
 
 	lock_init (&page_lock);
 	sema_init (&page_sema, 1);
@@ -32,9 +34,11 @@ swap_in (struct spage *spe, void *addr)
 	size_t index = spe->index;
 	size_t i;
 
+	TRACE (TRACE_SWAP_IN, index, addr);
+	thread_usage ()->major_fault_cnt++;
 	for(i=0;i<PAGE_SECTOR;i++)
 	{
-		disk_read (swap_disk, i+index, addr+i*DISK_SECTOR_SIZE);
+		block_read (swap_disk, i+index, addr+i*DISK_SECTOR_SIZE);
 	}
 
 	// bitmap_flip (swap_bitmap, index);
@@ -59,9 +63,10 @@ swap_out (struct spage *spe, void *addr)
 		return NULL;
 	}
 
+	TRACE (TRACE_SWAP_OUT, index, addr);
 	for(i=0;i<PAGE_SECTOR;i++)
 	{
-		disk_write (swap_disk, i+index, addr+i*DISK_SECTOR_SIZE);
+		block_write (swap_disk, i+index, addr+i*DISK_SECTOR_SIZE);
 	}
 
 	spe->index = index;